@@ -119,6 +119,12 @@ private:
     StringView(ERROR_MESSAGE).to_string().cstring(),                           \
     user_error_code())
 
+#define APP_RETURN_VALUE_ASSIGN_ERROR(RETURN_VALUE, ERROR_MESSAGE)             \
+  API_RETURN_VALUE_ASSIGN_ERROR(                                               \
+    RETURN_VALUE,                                                              \
+    StringView(ERROR_MESSAGE).to_string().cstring(),                           \
+    user_error_code())
+
 #define APP_CALL_GRAPH_TRACE_FUNCTION()
 
 #define APP_CALL_GRAPH_TRACE_CLASS_FUNCTION(name_value)
@@ -8,10 +8,90 @@
 #include <var.hpp>
 
 #include "SlPrinter.hpp"
+#include "utilities/DeviceCache.hpp"
+
+bool PrinterOutput::m_is_unbuffered = false;
+bool PrinterOutput::m_is_pending = false;
+chrono::ClockTimer PrinterOutput::m_flush_timer;
+PrinterOutput::Statistics PrinterOutput::m_statistics;
+
+void PrinterOutput::write(const var::StringView value) {
+  fwrite(value.data(), value.length(), 1, stdout);
+  m_statistics.set_write_count(m_statistics.write_count() + 1);
+  m_is_pending = true;
+  if (m_is_unbuffered) {
+    flush();
+    return;
+  }
+
+  if (m_flush_timer.is_running() == false) {
+    m_flush_timer.start();
+  } else if (m_flush_timer.milliseconds() >= flush_interval_milliseconds) {
+    flush();
+  }
+}
+
+void PrinterOutput::flush() {
+  if (m_is_pending) {
+    fflush(stdout);
+    m_statistics.set_flush_count(m_statistics.flush_count() + 1);
+    m_is_pending = false;
+  }
+  m_flush_timer.restart();
+}
+
+void PrinterOutput::update() {
+  if (
+    m_is_pending
+    && m_flush_timer.milliseconds() >= flush_interval_milliseconds) {
+    flush();
+  }
+}
+
+bool ProgressThrottle::is_update(int value, int total) {
+  const bool is_indeterminate
+    = total == api::ProgressCallback::indeterminate_progress_total();
+  const bool is_new = total != m_total || value < m_value;
+  m_total = total;
+  m_value = value;
+
+  // the indeterminate total is negative so it is checked before `total <= 0`
+  if (
+    redraws_per_second() == 0 || is_new || value == 0
+    || (!is_indeterminate && (total <= 0 || value >= total))) {
+    m_percent = total > 0 ? int(s64(value) * 100 / total) : 0;
+    m_timer.restart();
+    return true;
+  }
+
+  if (m_timer.milliseconds() < 1000 / redraws_per_second()) {
+    return false;
+  }
+
+  // indeterminate progress only has the time budget
+  const int percent = is_indeterminate ? m_percent + int(minimum_percent())
+                                       : int(s64(value) * 100 / total);
+  if (percent - m_percent < int(minimum_percent())) {
+    return false;
+  }
+
+  m_percent = percent;
+  m_timer.restart();
+  return true;
+}
 
 SlPrinter::SlPrinter()
   : m_printer_callback(m_report), m_json_printer(m_printer_callback),
-    m_yaml_printer(m_printer_callback), m_markdown_printer(m_printer_callback) {
+    m_yaml_printer(m_printer_callback), m_markdown_printer(m_printer_callback),
+    m_progress_callback([this](int value, int total) {
+      if (!m_progress_throttle.is_update(value, total)) {
+        return api::ProgressCallback::IsAbort::no;
+      }
+      const auto result
+        = active_printer().progress_callback()->update(value, total);
+      PrinterOutput::flush();
+      return result;
+    }) {
   m_is_options = false;
   m_is_output = false;
   m_is_suppressed = false;
@@ -24,11 +104,12 @@ SlPrinter::SlPrinter()
 }
 
 SlPrinter::~SlPrinter() {
-  if (is_json()) {
+  if (is_json() && !is_ndjson()) {
     // json().close_array();
     printf("]\n");
     m_report += "]\n";
   }
+  PrinterOutput::flush();
 }
 
 SlPrinter &SlPrinter::set_json() {
@@ -41,6 +122,15 @@ SlPrinter &SlPrinter::set_json() {
   return *this;
 }
 
+SlPrinter &SlPrinter::set_ndjson() {
+  m_is_vanilla = true;
+  m_is_json = true;
+  m_json_printer.set_ndjson();
+  json().enable_flags(Printer::Flags::simple_progress);
+  cloud::CloudObject::set_default_printer(json());
+  return *this;
+}
+
 SlPrinter &SlPrinter::set_vanilla() {
   m_is_vanilla = true;
   markdown().enable_flags(Printer::Flags::simple_progress);
@@ -128,6 +218,7 @@ void SlPrinter::close_command() {
   } else {
     close_header();
   }
+  PrinterOutput::flush();
 }
 
 void SlPrinter::open_printer_section(
@@ -276,6 +367,7 @@ void SlPrinter::close_output(
     }
     m_is_output = false;
     close_printer_section(key, value);
+    PrinterOutput::flush();
   }
 }
 
@@ -480,7 +572,7 @@ void SlPrinter::transfer_info(
   API_RETURN_IF_ERROR();
 
   FileInfo file_info
-    = Link::FileSystem(source_file_driver).get_info(source_file_path);
+    = DeviceCache::get_info(source_file_driver, source_file_path);
 
   open_object("transfer");
   active_printer().key("size", NumberString(file_info.size()));
@@ -497,3 +589,47 @@ void SlPrinter::transfer_info(
 
   close_object();
 }
+
+void SlJsonPrinter::print_ndjson(const var::StringView value) {
+  size_t start = 0;
+  for (size_t i = 0; i < value.length(); i++) {
+    const char c = value.at(i);
+    if (m_is_string) {
+      if (m_is_escape) {
+        m_is_escape = false;
+      } else if (c == '\\') {
+        m_is_escape = true;
+      } else if (c == '"') {
+        m_is_string = false;
+      }
+      continue;
+    }
+
+    if (m_depth == 0 && (c == ',' || c == ' ' || c == '\n' || c == '\r')) {
+      // separators between top-level values
+      start = i + 1;
+      continue;
+    }
+
+    if (c == '"') {
+      m_is_string = true;
+    } else if (c == '{' || c == '[') {
+      m_depth++;
+    } else if ((c == '}' || c == ']') && m_depth > 0) {
+      m_depth--;
+      if (m_depth == 0) {
+        m_line += value.get_substring_at_position(start)
+                    .get_substring_with_length(i + 1 - start);
+        m_line += "\n";
+        PrinterOutput::write(m_line);
+        m_callback.handle_input()(m_callback.context(), m_line);
+        m_line.clear();
+        start = i + 1;
+      }
+    }
+  }
+
+  if (start < value.length()) {
+    m_line += value.get_substring_at_position(start);
+  }
+}
@@ -31,17 +31,79 @@ private:
   const var::String &m_report;
 };
 
+// Writes printer output to stdout through the stdio buffer. Output is
+// flushed at flush points (command close, progress updates, exit) or once
+// `flush_interval` has passed since the last flush instead of after every
+// fragment. `--unbuffered` restores a flush per fragment.
+class PrinterOutput {
+public:
+  class Statistics {
+    API_AF(Statistics, u32, write_count, 0);
+    API_AF(Statistics, u32, flush_count, 0);
+  };
+
+  static void write(const var::StringView value);
+  static void flush();
+
+  // flushes pending output once the flush interval has passed -- called from
+  // loops that idle between writes so output doesn't sit in the buffer
+  static void update();
+
+  static chrono::MicroTime flush_interval() {
+    return chrono::MicroTime(flush_interval_milliseconds * 1000);
+  }
+
+  static void set_unbuffered(bool value = true) { m_is_unbuffered = value; }
+  static bool is_unbuffered() { return m_is_unbuffered; }
+
+  static Statistics statistics() { return m_statistics; }
+  static void reset_statistics() { m_statistics = Statistics(); }
+
+private:
+  static constexpr u32 flush_interval_milliseconds = 100;
+  static bool m_is_unbuffered;
+  static bool m_is_pending;
+  static chrono::ClockTimer m_flush_timer;
+  static Statistics m_statistics;
+};
+
+// Coalesces progress updates. Transfers call back on every page so an
+// update is only passed to the printer when the percentage has moved by
+// `minimum_percent` and the redraw budget (`redraws_per_second`) allows it.
+// The first, final and reset (zero total) updates always pass.
+class ProgressThrottle {
+public:
+  // zero disables throttling
+  API_AF(ProgressThrottle, u32, redraws_per_second, 10);
+  API_AF(ProgressThrottle, u32, minimum_percent, 1);
+
+  bool is_update(int value, int total);
+
+private:
+  chrono::ClockTimer m_timer;
+  int m_total = 0;
+  int m_value = 0;
+  int m_percent = 0;
+};
+
 class SlJsonPrinter : public printer::JsonPrinter {
 public:
   SlJsonPrinter(PrinterCallback &callback) : m_callback(callback) {}
   void interface_print_final(const var::StringView value) override {
-    fwrite(value.data(), value.length(), 1, stdout);
-    fflush(stdout);
+    if (m_is_ndjson) {
+      print_ndjson(value);
+      return;
+    }
+    PrinterOutput::write(value);
     m_callback.handle_input()(m_callback.context(), value);
   }
 
   ~SlJsonPrinter() {
-    if ((m_callback.report().length()) && (m_callback.report().at(0) == '[')) {
+    // parsing the whole report is expensive for long runs so it is opt-in
+    // (`--jsonvalidate`)
+    if (
+      m_is_validate && (m_callback.report().length())
+      && (m_callback.report().at(0) == '[')) {
       api::ErrorGuard error_guard;
       API_RESET_ERROR();
       json::JsonDocument document;
@@ -54,16 +116,36 @@ public:
     }
   }
 
+  // one JSON value per line (each top-level value is written when it closes)
+  SlJsonPrinter &set_ndjson(bool value = true) {
+    m_is_ndjson = value;
+    return *this;
+  }
+  bool is_ndjson() const { return m_is_ndjson; }
+
+  SlJsonPrinter &set_validate(bool value = true) {
+    m_is_validate = value;
+    return *this;
+  }
+
 private:
   PrinterCallback &m_callback;
+  bool m_is_ndjson = false;
+  bool m_is_validate = false;
+  // state for splitting the output into top-level values
+  var::String m_line;
+  int m_depth = 0;
+  bool m_is_string = false;
+  bool m_is_escape = false;
+
+  void print_ndjson(const var::StringView value);
 };
 
 class SlYamlPrinter : public printer::YamlPrinter {
 public:
   SlYamlPrinter(PrinterCallback &callback) : m_callback(callback) {}
   void interface_print_final(const var::StringView value) override {
-    fwrite(value.data(), value.length(), 1, stdout);
-    fflush(stdout);
+    PrinterOutput::write(value);
     m_callback.handle_input()(m_callback.context(), value);
   }
 
@@ -75,8 +157,7 @@ class SlMarkdownPrinter : public printer::MarkdownPrinter {
 public:
   SlMarkdownPrinter(PrinterCallback &callback) : m_callback(callback) {}
   void interface_print_final(const var::StringView value) override {
-    fwrite(value.data(), value.length(), 1, stdout);
-    fflush(stdout);
+    PrinterOutput::write(value);
     m_callback.handle_input()(m_callback.context(), value);
   }
 
@@ -178,7 +259,13 @@ public:
   }
 
   SlPrinter &set_json();
+  SlPrinter &set_ndjson();
   bool is_json() const { return m_is_json; }
+  bool is_ndjson() const { return m_json_printer.is_ndjson(); }
+  SlPrinter &set_json_validate() {
+    m_json_printer.set_validate();
+    return *this;
+  }
 
   SlPrinter &set_vanilla();
   SlPrinter &set_insert_codefences();
@@ -408,16 +495,22 @@ public:
   const var::StringView progress_key() const {
     return active_printer().progress_key();
   }
+  // forwards to the active printer and flushes the output
   const api::ProgressCallback *progress_callback() const {
-    return active_printer().progress_callback();
+    return &m_progress_callback;
   }
   api::ProgressCallback::IsAbort update_progress(int progress, int total) {
-    if (is_json()) {
-      return json().update_progress(progress, total);
+    if (!m_progress_throttle.is_update(progress, total)) {
+      return api::ProgressCallback::IsAbort::no;
     }
-    return yaml().update_progress(progress, total);
+    const auto result = is_json() ? json().update_progress(progress, total)
+                                  : yaml().update_progress(progress, total);
+    PrinterOutput::flush();
+    return result;
   }
 
+  ProgressThrottle &progress_throttle() { return m_progress_throttle; }
+
   SlPrinter &start_table(const var::StringViewList &header);
   SlPrinter &append_table_row(const var::StringViewList &row);
   SlPrinter &
@@ -477,6 +570,8 @@ private:
   SlJsonPrinter m_json_printer;
   SlYamlPrinter m_yaml_printer;
   SlMarkdownPrinter m_markdown_printer;
+  ProgressThrottle m_progress_throttle;
+  api::ProgressCallback m_progress_callback;
   var::Vector<var::StringList> m_table;
 
   static void process_output(void *context, const var::StringView output) {
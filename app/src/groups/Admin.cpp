@@ -159,8 +159,11 @@ bool Admin::import(const Command &command) {
       = DataFile()
           .write("//Auto generated file. Do not modifiy\n\n")
           .write("#include <var.hpp>\n\n")
+          .write("#include \"sos_crt_symbols.hpp\"\n\n")
           .move();
 
+    StringList symbol_list;
+
     while (!(line = symbols_file.get_line()).is_empty()) {
 
       if (line.string_view().find("_signature") != String::npos) {
@@ -171,7 +174,7 @@ bool Admin::import(const Command &command) {
           "}\n\n",
           NameString(line.string_view().split(" ").at(4)).cstring()));
 
-        output_file.write("const char * sos_symbols[] = {\n");
+        output_file.write("constexpr const char * sos_symbols[] = {\n");
 
         while (!(line = symbols_file.get_line()).is_empty()) {
           auto item_list = line.string_view().split(" ");
@@ -180,10 +183,25 @@ bool Admin::import(const Command &command) {
             item_list.count() > 1 && item_list.at(0).length()
             && item_list.at(0).at(0) != '/') {
             SL_PRINTER_TRACE("write symbol " + item_list.at(1));
-            output_file.write(String().format(
-              "\t\"%s\",\n",
-
-              NameString(item_list.at(1).pop_front().pop_back()).cstring()));
+            // strip the punctuation around the name (not the name itself)
+            auto symbol_view = item_list.at(1);
+            const auto is_symbol_character = [](char c) {
+              return c == '_' || (c >= '0' && c <= '9')
+                     || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            };
+            while (symbol_view.length()
+                   && !is_symbol_character(symbol_view.at(0))) {
+              symbol_view.pop_front();
+            }
+            while (symbol_view.length()
+                   && !is_symbol_character(
+                     symbol_view.at(symbol_view.length() - 1))) {
+              symbol_view.pop_back();
+            }
+            const NameString symbol(symbol_view);
+            output_file.write(
+              String().format("\t\"%s\",\n", symbol.cstring()));
+            symbol_list.push_back(String(symbol.string_view()));
             entry_count++;
           }
         }
@@ -202,7 +220,46 @@ bool Admin::import(const Command &command) {
                      "} "
                      "return String(); }\n\n",
                      entry_count)
-                   .string_view());
+                   .string_view())
+          .write("u32 sos_crt_symbols_get_name_offset(){ return 0; }\n\n");
+
+        // sorted copy for lookups -- checked with static_asserts
+        symbol_list.sort(StringList::ascending);
+        output_file.write("constexpr const char * sos_sorted_symbols[] = {\n");
+        u32 sorted_count = 0;
+        const String *previous = nullptr;
+        for (const auto &symbol : symbol_list) {
+          if (previous == nullptr || symbol != *previous) {
+            output_file.write(
+              String().format("\t\"%s\",\n", symbol.cstring()));
+            sorted_count++;
+          }
+          previous = &symbol;
+        }
+
+        output_file.write("};\n\n")
+          .write(GeneralString()
+                   .format(
+                     "static_assert(sos_crt_symbols_is_sorted(sos_sorted_"
+                     "symbols, %d), \"sos_sorted_symbols must be sorted\");\n\n",
+                     sorted_count)
+                   .string_view())
+          .write(GeneralString()
+                   .format(
+                     "static_assert(sos_crt_symbols_is_same_set(sos_symbols, "
+                     "%d, sos_sorted_symbols), \"sos_symbols and "
+                     "sos_sorted_symbols must hold the same names\");\n\n",
+                     entry_count)
+                   .string_view())
+          .write(GeneralString()
+                   .format(
+                     "u32 sos_crt_symbols_get_sorted_count(){ return %d; }\n\n",
+                     sorted_count)
+                   .string_view())
+          .write(
+            "const char * sos_crt_symbols_get_sorted_entry(u32 value){ if( "
+            "value < sos_crt_symbols_get_sorted_count() ){ return "
+            "sos_sorted_symbols[value]; } return nullptr; }\n\n");
       }
     }
 
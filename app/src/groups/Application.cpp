@@ -8,6 +8,9 @@
 #include "Application.hpp"
 #include "Task.hpp"
 #include "settings/TestSettings.hpp"
+#include "utilities/CrtSymbols.hpp"
+#include "utilities/DeviceCache.hpp"
+#include "utilities/GcovParser.hpp"
 
 Application::Application(Terminal &terminal)
   : Connector("application", "app"), m_terminal(terminal) {}
@@ -87,6 +90,12 @@ bool Application::install(const Command &command) {
         string,
         <auto>,
         "name to embed in the binary (will be automatically determined if not provided).")
+      + GROUP_ARG_OPT(
+        check,
+        bool,
+        true,
+        "check the application ELF for symbols the OS does not export before "
+        "transferring anything.")
       + GROUP_ARG_OPT(
         clean,
         bool,
@@ -145,6 +154,11 @@ bool Application::install(const Command &command) {
         true,
         "Kill the application before installing, otherwise installation is "
         "aborted if the application is running.")
+      + GROUP_ARG_OPT(
+        killtimeout,
+        int,
+        5000,
+        "Milliseconds to wait for a killed application to exit.")
       + GROUP_ARG_REQ(
         path_p,
         string,
@@ -213,6 +227,8 @@ bool Application::install(const Command &command) {
   const auto run = command.get_argument_value("run");
   const auto run_arguments = command.get_argument_value("arguments");
   const auto sign_key = command.get_argument_value("signkey");
+  const auto kill_option = command.get_argument_value("kill");
+  const auto kill_timeout = command.get_argument_value("killtimeout");
 
   StringView recursive = command.get_argument_value("recursive");
   recursive = "false";
@@ -336,11 +352,55 @@ bool Application::install(const Command &command) {
             Project().import_file(File(project_file_path)));
         }
 
+        // a symbol the OS doesn't export otherwise fails only after the
+        // transfer when the device loads the application
+        if (command.get_argument_value("check") != "false") {
+          const auto elf_path = CrtSymbols::find_application_elf(
+            project_path,
+            binary_image_path,
+            command.get_argument_value("build"),
+            name);
+
+          if (!elf_path.is_empty()) {
+            SL_PRINTER_TRACE("checking imports of " | elf_path.string_view());
+            const auto missing_list
+              = CrtSymbols::get_missing_symbol_list(File(elf_path));
+            API_RESET_ERROR();
+            if (missing_list.count()) {
+              printer().open_array("missingSymbols");
+              for (u32 i = 0; i < missing_list.count(); i++) {
+                printer().key(NumberString(i), missing_list.at(i));
+              }
+              printer().close_array();
+              APP_RETURN_ASSIGN_ERROR(
+                elf_path.string_view()
+                | " uses symbols the OS does not export (use `check=false` to "
+                  "install anyway)");
+            }
+          }
+        }
+
+        // the installer's kill waits a fixed time so the exit is awaited here
+        const bool is_kill
+          = kill_option != "false"
+            && command.get_argument_value("force") != "true"
+            && Link::Path(destination, connection()->driver()).is_device_path();
+        if (is_kill) {
+          kill(
+            connection(),
+            name & command.get_argument_value("suffix"),
+            (kill_timeout.is_empty() ? 5000 : kill_timeout.to_integer())
+              * 1_milliseconds);
+          API_RETURN_VALUE_IF_ERROR(false);
+        }
+
         Installer(connection())
           .install(get_installer_options(command)
+                     .set_kill(is_kill ? false : kill_option != "false")
                      .set_project_path(project_path)
                      .set_binary_path(binary_image_path)
                      .set_application(true));
+        DeviceCache::invalidate("/app");
       }
 
       API_RETURN_VALUE_IF_ERROR(false);
@@ -367,24 +427,78 @@ bool Application::install(const Command &command) {
   return true;
 }
 
-void Application::kill(Connection *connection, const var::StringView name) {
+chrono::MicroTime Application::kill(
+  Connection *connection,
+  const var::StringView name,
+  const chrono::MicroTime &timeout) {
 
   TaskManager task_manager("", connection->driver());
 
-  int app_pid = task_manager.get_pid(name);
-  if (app_pid < 0) {
-    return;
+  const int app_pid = task_manager.get_pid(name);
+  if (app_pid <= 0) {
+    API_RESET_ERROR();
+    return chrono::MicroTime(0);
   }
 
+  chrono::ClockTimer timer;
+  timer.start();
   task_manager.kill_pid(app_pid, LINK_SIGINT);
 
-  // give a little time for the program to shut down
   SL_PRINTER_TRACE("Wait for killed program to stop");
-  int retries = 0;
-  while ((task_manager.get_pid(name) > 0) && (retries < 5)) {
-    retries++;
-    chrono::wait(100_milliseconds);
+  const bool is_exited = wait_for_exit(connection, app_pid, timeout);
+  timer.stop();
+
+  printer().open_object("kill");
+  printer().key("name", name);
+  printer().key("pid", NumberString(app_pid));
+  printer().key(
+    "latency",
+    NumberString(timer.microseconds() * 1.0f / 1000.0f, "%0.3fms"));
+  printer().close_object();
+
+  if (!is_exited) {
+    if (api::ExecutionContext::error().error_number() != ETIMEDOUT) {
+      return timer.micro_time();
+    }
+    API_RESET_ERROR();
+    API_RETURN_VALUE_ASSIGN_ERROR(
+      timer.micro_time(),
+      GeneralString("`" | name | "` did not exit after being killed").cstring(),
+      ETIMEDOUT);
+  }
+
+  return timer.micro_time();
+}
+
+bool Application::wait_for_exit(
+  Connection *connection,
+  int pid,
+  const chrono::MicroTime &timeout) {
+  // The task manager has no exit notification over the link so poll, starting
+  // fast (most applications exit within a few milliseconds of SIGINT) and
+  // backing off so long waits don't flood the link.
+  TaskManager task_manager("", connection->driver());
+  chrono::ClockTimer timer;
+  timer.start();
+  u32 interval_milliseconds = 2;
+  while (task_manager.is_pid_running(pid)) {
+    if (is_error()) {
+      // keep the link error rather than reporting it as a timeout
+      return false;
+    }
+    if (timer.micro_time() > timeout) {
+      API_RETURN_VALUE_ASSIGN_ERROR(
+        false,
+        GeneralString().format("timed out waiting for pid %d to exit", pid)
+          .cstring(),
+        ETIMEDOUT);
+    }
+    chrono::wait(interval_milliseconds * 1_milliseconds);
+    if (interval_milliseconds < 100) {
+      interval_milliseconds *= 2;
+    }
   }
+  return is_success();
 }
 
 bool Application::run(const Command &command) {
@@ -452,13 +566,14 @@ bool Application::run(const Command &command) {
   if (link_path.path().find("/app/") != 0) {
 
     PathString search_path = PathString("/app/flash") / link_path.path();
-    Appfs::Info info = Appfs(connection()->driver()).get_info(search_path);
+    Appfs::Info info
+      = DeviceCache::get_appfs_info(connection()->driver(), search_path);
 
     if (is_error()) {
       API_RESET_ERROR();
 
       search_path = PathString("/app/ram") / link_path.path();
-      info = Appfs(connection()->driver()).get_info(search_path);
+      info = DeviceCache::get_appfs_info(connection()->driver(), search_path);
 
       if (!info.is_valid()) {
         APP_RETURN_ASSIGN_ERROR(
@@ -619,6 +734,8 @@ void Application::clean_directory(const var::StringView path) {
     }
   }
 
+  DeviceCache::invalidate(path);
+
   {
     Mutex::Guard mg(thread_argument.mutex);
     thread_argument.is_clean_complete = true;
@@ -708,8 +825,8 @@ bool Application::ping(const Command &command) {
   SlPrinter::Output printer_output_guard(printer());
 
   PathList app_list;
-  Link::FileSystem link_fs(link_path.driver());
-  FileInfo file_info = link_fs.get_info(link_path.path());
+  FileInfo file_info
+    = DeviceCache::get_info(link_path.driver(), link_path.path());
 
   if (file_info.is_directory()) {
     if (link_path.is_host_path()) {
@@ -724,8 +841,7 @@ bool Application::ping(const Command &command) {
       return is_success();
     }
 
-    app_list
-      = link_fs.read_directory(link_path.path(), fs::Dir::IsRecursive(false));
+    app_list = DeviceCache::read_directory(link_path.driver(), link_path.path());
 
   } else if (!file_info.is_valid()) {
     APP_RETURN_ASSIGN_ERROR(
@@ -755,7 +871,8 @@ bool Application::ping(const Command &command) {
 
       SL_PRINTER_TRACE("loading appfs info for " + item_path);
       api::ErrorScope error_scope;
-      const auto info = Appfs(link_path.driver()).get_info(item_path);
+      const auto info
+        = DeviceCache::get_appfs_info(link_path.driver(), item_path);
       if (is_success()) {
         Printer::Object po(printer().active_printer(), name);
         session_settings().tag_list().push_back(String("project:" + info.id()));
@@ -827,12 +944,34 @@ bool Application::profile(const Command &command) {
         true,
         "Synchronize the test data on the device to the source tree and run "
         "`gcov` to create intermediate coverage files.")
+      + GROUP_ARG_OPT(
+        timeout,
+        int,
+        600,
+        "Seconds to wait for each test application to exit.")
       + GROUP_ARG_OPT(
         report,
         bool,
         false,
         "Parse the `gcov` output into a test report (`false` if `configure`, "
         "`compile`, or `run` is `true`).")
+      + GROUP_ARG_OPT(
+        merge,
+        string,
+        <none>,
+        "Directories of `.gcov` files from other runs or devices to merge into "
+        "the report summary (separate multiple directories with `?`).")
+      + GROUP_ARG_OPT(
+        baseline,
+        string,
+        <none>,
+        "Path to a saved report summary. The summary shows the percent covered "
+        "change against it (the file is created if it doesn't exist).")
+      + GROUP_ARG_OPT(
+        rebase,
+        bool,
+        false,
+        "Replace the `baseline` with the summary of this report.")
       + GROUP_ARG_OPT(
         datapath,
         string,
@@ -848,6 +987,12 @@ bool Application::profile(const Command &command) {
   StringView run = command.get_argument_value("run");
   StringView data_path = command.get_argument_value("datapath");
   StringView report = command.get_argument_value("report");
+  const StringView merge = command.get_argument_value("merge");
+  const StringView baseline = command.get_argument_value("baseline");
+  const StringView rebase = command.get_argument_value("rebase");
+  const StringView timeout = command.get_argument_value("timeout");
+  const chrono::MicroTime duration_timeout
+    = (timeout.is_empty() ? 600 : timeout.to_integer()) * 1_seconds;
 
   if (report == "true") {
     compile = "false";
@@ -859,9 +1004,324 @@ bool Application::profile(const Command &command) {
     data_path = "device@/home";
   }
 
-  APP_RETURN_ASSIGN_ERROR(
-    "This operation is not supported or functional right now");
+  const StringView path = command.get_argument_value("path");
+  const StringView build = command.get_argument_value("build");
+  const StringView dryrun = command.get_argument_value("dryrun");
+  const StringView name = command.get_argument_value("name");
+  const StringView synchronize = command.get_argument_value("synchronize");
+  const bool is_dryrun = dryrun == "true";
+
+  command.print_options(printer());
+
+  if (
+    !is_dryrun && (run == "true" || synchronize == "true")
+    && !is_connection_ready()) {
+    return printer().close_fail();
+  }
+
+  SlPrinter::Output printer_output_guard(printer());
+
+  const auto test_settings_path = PathString(path) / "sl_test_settings.json";
+  if (!FileSystem().exists(test_settings_path)) {
+    APP_RETURN_ASSIGN_ERROR(test_settings_path | " does not exist");
+  }
+
+  const TestSettings test_settings(
+    JsonDocument().load(File(test_settings_path)).to_object());
+
+  if (is_error()) {
+    APP_RETURN_ASSIGN_ERROR("failed to load " | test_settings_path);
+  }
+
+  const auto test_list = [&]() {
+    var::Vector<TestDetails> result;
+    for (const auto &details : test_settings.get_test_list()) {
+      if (
+        (name.is_empty() || details.key() == name)
+        && details.is_enabled()) {
+        result.push_back(details);
+      }
+    }
+    return result;
+  }();
+
+  if (test_list.count() == 0) {
+    APP_RETURN_ASSIGN_ERROR("no enabled tests found in " | test_settings_path);
+  }
+
+  if (configure == "true") {
+    Printer::Object po(printer().output(), "configure");
+    for (const auto &details : test_list) {
+      if (is_dryrun) {
+        printer().key(
+          details.key(),
+          test_settings.get_project_directory_path(path, details));
+      } else if (!configure_test(path, test_settings, details)) {
+        return printer().close_fail();
+      }
+    }
+  }
+
+  if (compile == "true") {
+    Printer::Object po(printer().output(), "compile");
+    for (const auto &details : test_list) {
+      const auto cmake_directory
+        = test_settings.get_cmake_directory_path(path, details);
+      printer().key(details.key(), cmake_directory);
+      if (is_dryrun) {
+        continue;
+      }
+
+      FileSystem().create_directory(
+        cmake_directory,
+        Dir::IsRecursive::yes,
+        Permissions(0777));
+
+      const auto cmake = Process::which("cmake");
+      if (
+        execute_system_command(
+          Process::Arguments(cmake).push(".."),
+          cmake_directory)
+        || execute_system_command(
+          Process::Arguments(cmake).push("--build").push("."),
+          cmake_directory)) {
+        APP_RETURN_ASSIGN_ERROR("failed to build test " | details.key());
+      }
+    }
+  }
+
+  const Link::Path data_link_path(data_path, connection()->driver());
+
+  for (const auto &details : test_list) {
+    if (run != "true" && synchronize != "true") {
+      break;
+    }
+
+    Printer::Object po(printer().output(), details.key());
+    const auto coverage_directory
+      = test_settings.get_coverage_directory_path(path, details);
+
+    if (run == "true") {
+      const auto project_directory
+        = test_settings.get_project_directory_path(path, details);
+      printer().key("run", project_directory);
+      if (!is_dryrun) {
+        GeneralString args = "install:path=" | project_directory;
+        args |= ",build=" | build;
+        args |= ",run=true";
+        if (!details.get_arguments().is_empty()) {
+          args |= ",args=" | details.get_arguments();
+        }
+
+        if (!install(Command(Command::Group(get_name()), args))) {
+          return false;
+        }
+
+        // the coverage data is written when the test exits
+        const int pid
+          = TaskManager("", connection()->driver()).get_pid(details.key());
+        if (pid <= 0) {
+          APP_RETURN_ASSIGN_ERROR(
+            "test `" | details.key() | "` is not running after install");
+        }
+        wait_for_exit(connection(), pid, duration_timeout);
+        API_RETURN_VALUE_IF_ERROR(false);
+      }
+    }
+
+    if (synchronize == "true") {
+      printer().key("synchronize", coverage_directory);
+      if (is_dryrun) {
+        continue;
+      }
+
+      FileSystem().create_directory(
+        coverage_directory,
+        Dir::IsRecursive::yes,
+        Permissions(0777));
+
+      Link::FileSystem data_file_system(data_link_path.driver());
+      for (const auto &entry :
+           data_file_system.read_directory(data_link_path.path())) {
+        if (Path::suffix(entry) != "gcda") {
+          continue;
+        }
+        File(File::IsOverwrite::yes, coverage_directory / entry)
+          .write(Link::File(
+            PathString(data_link_path.path()) / entry,
+            OpenMode::read_only(),
+            data_link_path.driver()));
+      }
+
+      const auto gcov = Process::which("arm-none-eabi-gcov");
+      for (const auto &source : details.get_source_list()) {
+        execute_system_command(
+          Process::Arguments(gcov)
+            .push("-b")
+            .push("-o")
+            .push(test_settings.get_cmake_directory_path(path, details))
+            .push(PathString(path) / source),
+          coverage_directory);
+      }
+
+      if (is_error()) {
+        APP_RETURN_ASSIGN_ERROR(
+          "failed to synchronize coverage data for " | details.key());
+      }
+    }
+  }
+
+  if (report == "true") {
+    Printer::Object po(printer().output(), "report");
+    // hit counts from every test (and `merge`) summed by source file
+    GcovAggregate aggregate;
+    for (const auto &details : test_list) {
+      const auto coverage_directory
+        = test_settings.get_coverage_directory_path(path, details);
+
+      StringList gcov_list;
+      if (FileSystem().directory_exists(coverage_directory)) {
+        for (const auto &entry :
+             FileSystem().read_directory(coverage_directory)) {
+          if (Path::suffix(entry) == "gcov") {
+            gcov_list.push_back(coverage_directory / entry);
+          }
+        }
+      }
+
+      if (is_dryrun) {
+        printer().key(
+          details.key(),
+          NumberString(gcov_list.count()).string_view());
+        continue;
+      }
+
+      const auto coverage = GcovParser().parse(gcov_list);
+      printer().object(details.key(), coverage);
+      aggregate.add(gcov_list);
+
+      const auto report_directory
+        = test_settings.get_report_directory_path(path, details);
+      FileSystem().create_directory(
+        report_directory,
+        Dir::IsRecursive::yes,
+        Permissions(0777));
+      JsonDocument().save(
+        coverage,
+        File(File::IsOverwrite::yes, report_directory / "coverage.json"));
+    }
+
+    if (!is_dryrun) {
+      print_coverage_summary(aggregate, merge, baseline, rebase == "true");
+    }
+  }
+
+  return is_success();
+}
+
+bool Application::print_coverage_summary(
+  GcovAggregate &aggregate,
+  const var::StringView merge,
+  const var::StringView baseline,
+  bool is_rebase) {
+
+  for (const auto &directory : merge.split("?")) {
+    if (directory.is_empty()) {
+      continue;
+    }
+    if (!FileSystem().directory_exists(directory)) {
+      APP_RETURN_ASSIGN_ERROR("merge directory `" | directory | "` does not exist");
+    }
+
+    StringList gcov_list;
+    for (const auto &entry : FileSystem().read_directory(directory)) {
+      if (Path::suffix(entry) == "gcov") {
+        gcov_list.push_back(PathString(directory) / entry);
+      }
+    }
+    aggregate.add(gcov_list);
+  }
+
+  const auto summary = aggregate.to_object();
+  const bool is_baseline_existing
+    = !baseline.is_empty() && FileSystem().exists(baseline);
+  const auto delta
+    = is_baseline_existing
+        ? GcovAggregate::get_delta(
+          summary,
+          JsonDocument().load(File(baseline)).to_object())
+        : JsonObject();
+
+  if (is_error()) {
+    APP_RETURN_ASSIGN_ERROR("failed to load baseline `" | baseline | "`");
+  }
+
+  const auto get_delta_string = [](const JsonObject &object) {
+    if (object.is_empty()) {
+      return String();
+    }
+    if (object.at("new").is_valid()) {
+      return String("new");
+    }
+    return String().format("%+0.2f", object.at("percentDelta").to_real());
+  };
+
+  const auto source_object = summary.at("sources").to_object();
+  const auto source_delta_object = delta.at("sources").to_object();
+
+  Printer::Object po(printer().output(), "summary");
+  printer().start_table(
+    StringViewList({"source", "lines", "executed", "percent", "delta"}));
+  for (const auto &path : source_object.get_key_list()) {
+    const auto source = source_object.at(path).to_object();
+    printer().append_table_row(StringViewList(
+      {path,
+       NumberString(source.at("lineCount").to_integer()),
+       NumberString(source.at("lineExecutionCount").to_integer()),
+       NumberString(source.at("percent").to_real(), "%0.2f"),
+       get_delta_string(source_delta_object.at(path).to_object())}));
+  }
+  printer().finish_table(printer::Printer::Level::info);
+
+  // with a baseline only the functions that changed are listed
+  if (is_baseline_existing) {
+    printer().start_table(
+      StringViewList({"function", "source", "percent", "delta"}));
+    for (const auto &path : source_delta_object.get_key_list()) {
+      const auto function_delta_object
+        = source_delta_object.at(path).to_object().at("functions").to_object();
+      const auto function_object
+        = source_object.at(path).to_object().at("functions").to_object();
+      for (const auto &name : function_delta_object.get_key_list()) {
+        printer().append_table_row(StringViewList(
+          {name,
+           path,
+           NumberString(
+             function_object.at(name).to_object().at("percent").to_real(),
+             "%0.2f"),
+           get_delta_string(function_delta_object.at(name).to_object())}));
+      }
+    }
+    printer().finish_table(printer::Printer::Level::info);
+  }
+
+  printer()
+    .key("sources", NumberString(aggregate.source_count()))
+    .key("percent", NumberString(summary.at("percent").to_real(), "%0.2f"))
+    .key(
+      "functions",
+      NumberString(summary.at("functionExecutionCount").to_integer()) | " of "
+        | NumberString(summary.at("functionCount").to_integer()) | " called");
+  if (is_baseline_existing) {
+    printer().key("delta", get_delta_string(delta));
+  }
+
+  if (!baseline.is_empty() && (is_rebase || !is_baseline_existing)) {
+    JsonDocument().save(summary, File(File::IsOverwrite::yes, baseline));
+    printer().key("baseline", baseline);
+  }
 
+  return is_success();
 }
 
 bool Application::configure_test(
@@ -7,11 +7,25 @@
 #include "Terminal.hpp"
 #include "settings/TestSettings.hpp"
 
+class GcovAggregate;
+
 class Application : public Connector {
 public:
   explicit Application(Terminal &terminal);
 
-  static void kill(Connection *connection, const StringView name);
+  // sends SIGINT to `name` and waits (up to `timeout`) for it to exit.
+  // Returns the time it took (zero if it was not running).
+  static chrono::MicroTime kill(
+    Connection *connection,
+    const StringView name,
+    const chrono::MicroTime &timeout);
+
+  // returns false (and assigns ETIMEDOUT) if `pid` is still running, or
+  // false with the link error if the task list can't be read
+  static bool wait_for_exit(
+    Connection *connection,
+    int pid,
+    const chrono::MicroTime &timeout);
 
 private:
   enum commands {
@@ -40,6 +54,14 @@ private:
     const var::String &path,
     const TestSettings &test_settings,
     const TestDetails &test_details);
+
+  // merges `aggregate` with the `merge` directories and compares it to
+  // `baseline`
+  bool print_coverage_summary(
+    GcovAggregate &aggregate,
+    const var::StringView merge,
+    const var::StringView baseline,
+    bool is_rebase);
 };
 
 #endif // APPLICATION_HPP
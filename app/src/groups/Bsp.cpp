@@ -1,7 +1,9 @@
 // COPYING: Copyright 2017-2020 Tyler Gilbert and Stratify Labs. All rights
 // reserved
 #include <chrono.hpp>
+#include <crypto.hpp>
 #include <fs.hpp>
+#include <hal/Flash.hpp>
 #include <printer.hpp>
 #include <sos.hpp>
 #include <sys.hpp>
@@ -10,6 +12,10 @@
 
 #include "Bsp.hpp"
 
+#include "settings/FilePathSettings.hpp"
+#include "utilities/DeviceCache.hpp"
+#include "utilities/ImagePipeline.hpp"
+#include "utilities/Keyring.hpp"
 #include "utilities/Packager.hpp"
 
 Bsp::Bsp() : Connector("os", "system") {}
@@ -137,6 +143,12 @@ bool Bsp::install(const Command &command) {
       "host computer. If no *path* is "
       "specified, the workspace is searched for an OS package that matches the "
       "connected device.")
+      + GROUP_ARG_OPT(
+        address,
+        int,
+        <none>,
+        "The flash address where the OS starts (required to rewrite sectors "
+        "with `differential` and `flashdevice`).")
       + GROUP_ARG_OPT(
         build_target,
         string,
@@ -148,12 +160,29 @@ bool Bsp::install(const Command &command) {
         500,
         "The number of milliseconds to wait between reconnect retries (used "
         "with reconnect and retry).")
+      + GROUP_ARG_OPT(
+        differential_diff,
+        bool,
+        false,
+        "Only rewrite the flash sectors that differ from the image on the "
+        "device (requires `flashdevice` and `address` while the OS is "
+        "running, otherwise see `record`). `flashdevice` must not be the "
+        "bank the OS is executing from. The device is reset (see "
+        "`reconnect`) after sectors are rewritten.")
       + GROUP_ARG_OPT(
         hash,
         bool,
         false,
         "Install the image with a SHA256 hash appended to the end of the "
         "binary.")
+      + GROUP_ARG_OPT(
+        record,
+        bool,
+        false,
+        "Skip the install if the image matches the host record of the last "
+        "image `sl` installed on the device (used with differential when the "
+        "device can't be read, the record is stale if the device was "
+        "programmed some other way).")
       + GROUP_ARG_OPT(
         rekey,
         bool,
@@ -220,6 +249,21 @@ bool Bsp::install(const Command &command) {
         50,
         "The number of times to retry reconnecting after install (used with "
         "reconnect, and delay).")
+      + GROUP_ARG_OPT(
+        sectorsize,
+        int,
+        4096,
+        "Sector size used for the host record of the installed image when "
+        "the device page layout is not available (used with differential).")
+      + GROUP_ARG_OPT(
+        pipeline,
+        bool,
+        false,
+        "Hash, sign and write the image in one pass, writing early pages "
+        "while later pages are still being prepared and showing the time "
+        "spent in each stage (requires `flashdevice` and `address` while the "
+        "OS is running). Installs from the bootloader and installs with "
+        "`key` or `publickey` use the installer.")
       + GROUP_ARG_OPT(
         verify,
         bool,
@@ -325,6 +369,7 @@ bool Bsp::install(const Command &command) {
 
   Installer installer(connection());
 
+  PathString project_name;
   if (!project_path.is_empty()) {
     SL_PRINTER_TRACE("importing project file");
     Project project = Project().import_file(
@@ -335,16 +380,439 @@ bool Bsp::install(const Command &command) {
     if (is_error()) {
       APP_RETURN_ASSIGN_ERROR("project not found at " | project_path);
     }
+    project_name = PathString(
+      project.get_name().is_empty() ? Path::name(project_path)
+                                    : project.get_name());
   }
 
-  installer.install(get_installer_options(command)
-                      .set_os(true)
-                      .set_binary_path(binary_path)
-                      .set_project_path(project_path));
+  const auto record_path = FilePathSettings::os_image_record_path(
+    connection()->info().serial_number().to_string());
+  const bool is_differential
+    = command.get_argument_value("differential") == "true"
+      && destination.is_empty();
+
+  SectorImage::SectorList image_sector_list;
+  if (is_differential) {
+    const auto image_path
+      = binary_path.is_empty()
+          ? find_os_image(
+            project_path,
+            command.get_argument_value("build"),
+            project_name)
+          : binary_path;
+
+    const auto result
+      = install_differential(command, image_path, image_sector_list);
+    if (result == Differential::written && is_success()) {
+      reset_device(command);
+    }
+    if (result != Differential::full || is_error()) {
+      DeviceCache::clear();
+      return is_success();
+    }
+  }
+
+  const bool is_pipeline = command.get_argument_value("pipeline") == "true"
+                           && destination.is_empty();
+
+  if (
+    is_pipeline
+    && install_pipeline(
+      command,
+      binary_path.is_empty()
+        ? find_os_image(
+          project_path,
+          command.get_argument_value("build"),
+          project_name)
+        : binary_path)) {
+    if (is_success()) {
+      reset_device(command);
+    }
+  } else {
+    installer.install(get_installer_options(command)
+                        .set_os(true)
+                        .set_binary_path(binary_path)
+                        .set_project_path(project_path));
+  }
+
+  DeviceCache::clear();
+
+  if (is_success() && destination.is_empty()) {
+    // keep the record in sync with what is on the device
+    if (image_sector_list.count()) {
+      SectorImage::save(record_path, image_sector_list);
+    } else if (FileSystem().exists(record_path)) {
+      FileSystem().remove(record_path);
+    }
+  }
 
   return is_success();
 }
 
+Bsp::Differential Bsp::install_differential(
+  const Command &command,
+  const var::StringView image_path,
+  SectorImage::SectorList &image_sector_list) {
+  printer::Printer::Object differential_object(
+    printer().output(),
+    "differential");
+
+  // these options change the image on every install
+  const bool is_image_modified
+    = command.get_argument_value("hash") == "true"
+      || command.get_argument_value("key") == "true"
+      || !command.get_argument_value("signkey").is_empty()
+      || !command.get_argument_value("publickey").is_empty()
+      || !workspace_settings().get_sign_key().is_empty();
+
+  if (is_image_modified || image_path.is_empty()) {
+    printer().key("mode", "full");
+    printer().key(
+      "reason",
+      is_image_modified ? "the image is modified (hash, key or signature)"
+                        : "no OS image found in the build directory");
+    return Differential::full;
+  }
+
+  const auto image = DataFile().write(File(image_path)).move();
+  if (is_error()) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      Differential::full,
+      "failed to read the OS image " | image_path);
+  }
+
+  const auto record_path = FilePathSettings::os_image_record_path(
+    connection()->info().serial_number().to_string());
+  const auto flash_device_path = command.get_argument_value("flashdevice");
+
+  printer().key("image", image_path);
+
+  if (
+    flash_device_path.is_empty()
+    || !connection()->is_connected_and_is_not_bootloader()) {
+    // the bootloader only erases the whole image so sectors can't be
+    // rewritten individually -- the record of the last image installed by
+    // `sl` is used to skip installs that don't change anything
+    if (command.get_argument_value("record") != "true") {
+      printer().key("mode", "full");
+      printer().key(
+        "reason",
+        "the device can't be read (use `record` to compare with the last "
+        "image installed by `sl`)");
+      return Differential::full;
+    }
+
+    image_sector_list = SectorImage::hash(
+      image.data(),
+      SectorImage::create_layout(
+        image.data().size(),
+        command.get_argument_value("sectorsize").to_unsigned_long()));
+
+    const auto record_list = SectorImage::load(record_path);
+    const auto changed_list
+      = SectorImage::get_changed(image_sector_list, record_list);
+
+    printer().key("mode", "record");
+    printer().key("sectors", NumberString(image_sector_list.count()));
+    printer().key("changed", NumberString(changed_list.count()));
+    if (
+      record_list.count() == image_sector_list.count()
+      && changed_list.count() == 0) {
+      printer().key("result", "unchanged");
+      return Differential::unchanged;
+    }
+    return Differential::full;
+  }
+
+  const auto address = command.get_argument_value("address");
+  if (address.is_empty()) {
+    printer().key("mode", "full");
+    printer().key("reason", "`address` is required to rewrite sectors");
+    return Differential::full;
+  }
+
+  hal::Flash flash_device(
+    Link::Path(flash_device_path, connection()->driver()).path(),
+    OpenMode::read_write(),
+    connection()->driver());
+
+  const u32 start_address = address.to_unsigned_long();
+  const auto layout
+    = get_flash_layout(flash_device, flash_device_path, start_address, image);
+  if (is_error()) {
+    return Differential::full;
+  }
+
+  image_sector_list = SectorImage::hash(image.data(), layout);
+  const auto device_sector_list
+    = SectorImage::hash_device(flash_device, start_address, image_sector_list);
+  if (is_error()) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      Differential::full,
+      "failed to read the image from " | flash_device_path);
+  }
+
+  const auto changed_list
+    = SectorImage::get_changed(image_sector_list, device_sector_list);
+
+  printer().key("mode", "device");
+  printer().key("sectors", NumberString(image_sector_list.count()));
+  printer().key("changed", NumberString(changed_list.count()));
+
+  if (changed_list.count() == 0) {
+    printer().key("result", "unchanged");
+    SectorImage::save(record_path, image_sector_list);
+    return Differential::unchanged;
+  }
+
+  printer().output().set_progress_key("writing");
+  for (u32 i = 0; i < changed_list.count(); i++) {
+    const auto &sector = changed_list.at(i);
+    flash_device.erase_page(sector.page());
+    flash_device.seek(start_address + sector.offset())
+      .write(View(image.data().data_u8() + sector.offset(), sector.size()));
+    if (is_error()) {
+      APP_RETURN_VALUE_ASSIGN_ERROR(
+        Differential::written,
+        "failed to write page " | NumberString(sector.page()));
+    }
+    printer().progress_callback()->update(i + 1, changed_list.count());
+  }
+  printer().progress_callback()->update(0, 0);
+  printer().output().set_progress_key("progress");
+
+  if (command.get_argument_value("verify") == "true") {
+    // only the rewritten sectors need to be checked
+    const auto verify_list = SectorImage::get_changed(
+      changed_list,
+      SectorImage::hash_device(flash_device, start_address, changed_list));
+    if (verify_list.count()) {
+      APP_RETURN_VALUE_ASSIGN_ERROR(
+        Differential::written,
+        "verify failed for " | NumberString(verify_list.count())
+          | " sectors");
+    }
+    printer().key("verified", NumberString(changed_list.count()));
+  }
+
+  SectorImage::save(record_path, image_sector_list);
+  printer().key("result", "written");
+  return Differential::written;
+}
+
+bool Bsp::install_pipeline(
+  const Command &command,
+  const var::StringView image_path) {
+  printer::Printer::Object pipeline_object(printer().output(), "pipeline");
+
+  const auto flash_device_path = command.get_argument_value("flashdevice");
+  const auto address = command.get_argument_value("address");
+  const auto sign_key = command.get_argument_value("signkey").is_empty()
+                          ? workspace_settings().get_sign_key()
+                          : command.get_argument_value("signkey");
+
+  // key insertion and the bootloader transfer are done inside the installer
+  const auto reason = [&]() -> var::StringView {
+    if (image_path.is_empty()) {
+      return "no OS image found in the build directory";
+    }
+    if (
+      flash_device_path.is_empty()
+      || !connection()->is_connected_and_is_not_bootloader()) {
+      return "requires `flashdevice` while the OS is running";
+    }
+    if (address.is_empty()) {
+      return "requires `address`";
+    }
+    if (
+      command.get_argument_value("key") == "true"
+      || !command.get_argument_value("publickey").is_empty()) {
+      return "key insertion is done by the installer";
+    }
+    return var::StringView();
+  }();
+
+  if (!reason.is_empty()) {
+    printer().key("mode", "installer");
+    printer().key("reason", reason);
+    return false;
+  }
+
+  hal::Flash flash_device(
+    Link::Path(flash_device_path, connection()->driver()).path(),
+    OpenMode::read_write(),
+    connection()->driver());
+
+  const u32 start_address = address.to_unsigned_long();
+  const auto layout = get_flash_layout(
+    flash_device,
+    flash_device_path,
+    start_address,
+    File(image_path));
+  if (is_error()) {
+    return true;
+  }
+
+  // the private key is decrypted before the first page is written
+  DigitalSignatureAlgorithm dsa(DigitalSignatureAlgorithm::Curve::secp256r1);
+  if (!sign_key.is_empty()) {
+    const auto keys_document = Keyring::get_keys(sign_key);
+    if (is_error()) {
+      return true;
+    }
+
+    const auto password
+      = command.get_argument_value("signkeypassword").is_empty()
+          ? StringView(Aes::Key::get_null_key256_string())
+          : command.get_argument_value("signkeypassword");
+
+    dsa = keys_document.get_digital_signature_algorithm(Aes::Key(
+      Aes::Key::Construct().set_key(password).set_initialization_vector(
+        keys_document.get_iv())));
+
+    if (is_error()) {
+      APP_RETURN_VALUE_ASSIGN_ERROR(
+        true,
+        "failed to decrypt the sign key `" | sign_key | "`");
+    }
+  }
+
+  printer().key("mode", "pipeline");
+  printer().key("image", image_path);
+
+  printer().output().set_progress_key("writing");
+  const auto result = ImagePipeline::install(
+    flash_device,
+    ImagePipeline::Options()
+      .set_image_path(image_path)
+      .set_start_address(start_address)
+      .set_layout(layout)
+      .set_append_hash(command.get_argument_value("hash") == "true")
+      .set_digital_signature_algorithm(sign_key.is_empty() ? nullptr : &dsa)
+      .set_progress_callback(printer().progress_callback()));
+  printer().output().set_progress_key("progress");
+
+  if (is_error()) {
+    return true;
+  }
+
+  const auto milliseconds = [](u64 microseconds) {
+    return NumberString(microseconds * 1.0f / 1000.0f, "%0.3fms");
+  };
+
+  const auto &timing = result.timing();
+  printer()
+    .key("imageSize", NumberString(result.image_size()))
+    .key("trailerSize", NumberString(result.trailer_size()))
+    .key("pages", NumberString(result.page_count()))
+    .key("hash", result.hash())
+    .key("signature", result.signature());
+
+  {
+    printer::Printer::Object timing_object(printer().output(), "timing");
+    printer()
+      .key("read", milliseconds(timing.read()))
+      .key("hash", milliseconds(timing.hash()))
+      .key("sign", milliseconds(timing.sign()))
+      .key("erase", milliseconds(timing.erase()))
+      .key("write", milliseconds(timing.write()))
+      .key("wait", milliseconds(timing.wait()))
+      .key("total", milliseconds(timing.total()));
+  }
+
+  return true;
+}
+
+SectorImage::SectorList Bsp::get_flash_layout(
+  hal::Flash &flash_device,
+  const var::StringView flash_device_path,
+  u32 start_address,
+  const fs::FileObject &image) {
+  // the flash device also holds the bootloader so the image has to be linked
+  // for `start_address` -- its reset vector is the second word of the vector
+  // table
+  const u32 image_size = image.size();
+  u32 reset_vector = 0;
+  if (image_size >= 2 * sizeof(u32)) {
+    image.seek(sizeof(u32)).read(View(reset_vector));
+    image.seek(0);
+  }
+  reset_vector &= ~u32(1);
+  if (
+    reset_vector < start_address
+    || reset_vector >= start_address + image_size) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      SectorImage::SectorList(),
+      "the OS image is not linked for address "
+        | NumberString(start_address, "0x%08X"));
+  }
+
+  const auto page_info_list = flash_device.get_page_info();
+  if (is_error() || page_info_list.count() == 0) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      SectorImage::SectorList(),
+      "failed to read the page layout of " | flash_device_path);
+  }
+
+  // pages before `start_address` are never erased or written
+  SectorImage::SectorList result;
+  u32 layout_size = 0;
+  for (const auto &page_info : page_info_list) {
+    if (page_info.address() < start_address) {
+      continue;
+    }
+    result.push_back(SectorImage::Sector()
+                       .set_page(page_info.page())
+                       .set_offset(page_info.address() - start_address)
+                       .set_size(page_info.size()));
+    layout_size += page_info.size();
+  }
+
+  if (result.count() == 0 || result.front().offset() != 0) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      SectorImage::SectorList(),
+      NumberString(start_address, "0x%08X")
+        | " is not the start of a page on " | flash_device_path);
+  }
+
+  if (layout_size < image_size) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      SectorImage::SectorList(),
+      "the OS image does not fit on " | flash_device_path);
+  }
+
+  return result;
+}
+
+void Bsp::reset_device(const Command &command) {
+  connection()->reset();
+  if (command.get_argument_value("reconnect") == "true") {
+    SL_PRINTER_TRACE("reconnect to device");
+    connection()->reconnect(
+      command.get_argument_value("retry").to_unsigned_long(),
+      command.get_argument_value("delay").to_unsigned_long() * 1_milliseconds);
+  }
+}
+
+var::PathString Bsp::find_os_image(
+  const var::StringView project_path,
+  const var::StringView build_name,
+  const var::StringView name) {
+  if (project_path.is_empty() || name.is_empty()) {
+    return PathString();
+  }
+
+  // `build_<name>_boot` holds the bootloader so only the exact build
+  // directory is used
+  const auto image_path
+    = project_path
+      / (PathString("build_")
+         & (build_name.is_empty() ? StringView("release") : build_name))
+      / name & ".bin";
+
+  return FileSystem().exists(image_path) ? image_path : PathString();
+}
+
 bool Bsp::invoke_bootloader(const Command &command) {
 
   printer().open_command("os.invokebootloader");
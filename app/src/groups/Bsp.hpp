@@ -3,7 +3,10 @@
 #ifndef BSP_HPP
 #define BSP_HPP
 
+#include <hal/Flash.hpp>
+
 #include "Connector.hpp"
+#include "utilities/SectorImage.hpp"
 
 class Bsp : public Connector {
 public:
@@ -26,6 +29,36 @@ private:
   bool execute_command_at(u32 list_offset, const Command &command) override;
 
   bool install(const Command &command);
+
+  enum class Differential { unchanged, written, full };
+
+  Differential install_differential(
+    const Command &command,
+    const var::StringView image_path,
+    SectorImage::SectorList &image_sector_list);
+
+  // returns false if the installer needs to be used instead
+  bool install_pipeline(
+    const Command &command,
+    const var::StringView image_path);
+
+  // pages of `flash_device` from `start_address` on (assigns an error if
+  // `image` isn't linked for `start_address` or doesn't fit)
+  SectorImage::SectorList get_flash_layout(
+    hal::Flash &flash_device,
+    const var::StringView flash_device_path,
+    u32 start_address,
+    const fs::FileObject &image);
+
+  // runs the image written without the installer (the installer resets and
+  // reconnects on its own)
+  void reset_device(const Command &command);
+
+  // `<project>/build_<build_name>/<name>.bin` if it exists
+  static var::PathString find_os_image(
+    const var::StringView project_path,
+    const var::StringView build_name,
+    const var::StringView name);
   bool invoke_bootloader(const Command &command);
   bool reset(const Command &command);
   bool publish(const Command &command);
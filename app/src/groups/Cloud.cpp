@@ -9,6 +9,8 @@
 #include "Application.hpp"
 #include "Cloud.hpp"
 #include "settings/HardwareSettings.hpp"
+#include "utilities/CloudStandIn.hpp"
+#include "utilities/DeviceCache.hpp"
 #include "utilities/Packager.hpp"
 
 /*
@@ -42,11 +44,16 @@ bool CloudGroup::execute_command_at(u32 list_offset, const Command &command) {
       return listen(command);
     case command_remove:
       return remove(command);
+    case command_standin:
+      return standin(command);
     }
   } else {
     if (list_offset == command_install){
       return install(command);
     }
+    if (list_offset == command_standin) {
+      return standin(command);
+    }
   }
 
   return false;
@@ -63,7 +70,8 @@ var::StringViewList CloudGroup::get_command_list() const {
     "sync",
     "connect",
     "listen",
-    "remove"};
+    "remove",
+    "standin"};
   API_ASSERT(list.count() == command_total);
 
   return list;
@@ -911,6 +919,9 @@ bool CloudGroup::install(const Command &command) {
       .set_update_apps(update == "true" && update_apps == "true")
       .set_update_app_directories(directories));
 
+  // an OS install replaces the filesystem
+  DeviceCache::clear();
+
   return is_success();
 }
 
@@ -919,19 +930,38 @@ var::Vector<CloudAppUpdate> CloudGroup::check_for_app_updates(
   IsForceReinstall is_reinstall) {
 
 
-  auto list = Link::FileSystem(connection()->driver())
-                .read_directory(path, Dir::IsRecursive(false));
+  // every appfs entry is an executable so the entry info is only worth
+  // fetching in regular directories where it rules out most files before
+  // their header is read
+  const bool is_appfs = path.string_view().find("/app/") == 0;
+  DeviceCache::DirectoryInfoList list;
+  if (is_appfs) {
+    for (const auto &item :
+         DeviceCache::read_directory(connection()->driver(), path)) {
+      list.push_back(DeviceCache::DirectoryInfo().set_name(item));
+    }
+  } else {
+    list = DeviceCache::read_directory_info(connection()->driver(), path, true);
+  }
 
   var::Vector<CloudAppUpdate> result;
 
-  for (const auto &item : list) {
+  for (const auto &entry : list) {
+    const auto &item = entry.name();
     const PathString app_path = PathString(path) / item;
 
+    if (
+      !is_appfs
+      && (!entry.info().is_file() || entry.info().size() < sizeof(appfs_file_t))) {
+      continue;
+    }
+
     if (item.string_view().at(0) != '.') {
 
       SL_PRINTER_TRACE("load application info for " + app_path);
 
-      Appfs::Info info = Appfs(connection()->driver()).get_info(app_path);
+      Appfs::Info info
+        = DeviceCache::get_appfs_info(connection()->driver(), app_path);
       if (info.is_valid()) { // non executable files will not have valid info
         // (like settings.json)
         printer().open_object(app_path.cstring());
@@ -1108,6 +1138,124 @@ bool CloudGroup::remove(const Command &command) {
   return is_success();
 }
 
+bool CloudGroup::standin(const Command &command) {
+
+  SL_PRINTER_TRACE_PERFORMANCE();
+  printer().open_command(GROUP_COMMAND_NAME);
+  GROUP_ADD_SESSION_REPORT_TAG();
+  Command reference(
+    Command::Group(get_name()),
+    GROUP_ARG_DESC(
+      standin,
+      "serves cloud storage downloads from a local directory so download "
+      "paths (`os.install`, `fs.download` and package downloads) can be "
+      "tested and benchmarked without the network. Downloads made by `sl` go "
+      "to it with `--cloud=http://localhost:<port>` or `SL_CLOUD_URL`. "
+      "Sign-in and documents still use the hosted service.")
+      + GROUP_ARG_OPT(port, integer, 8090, "The port to listen on.")
+      + GROUP_ARG_OPT(
+        path,
+        string,
+        <global>/standin,
+        "The directory that holds the objects served by the stand-in "
+        "(`<path>/<bucket>/<name>`).")
+      + GROUP_ARG_OPT(
+        latency,
+        integer,
+        0,
+        "Milliseconds to delay every request.")
+      + GROUP_ARG_OPT(
+        jitter,
+        integer,
+        0,
+        "Up to this many milliseconds are randomly added to `latency`.")
+      + GROUP_ARG_OPT(
+        failure_rate,
+        integer,
+        0,
+        "Percentage of requests that fail with `503`.")
+      + GROUP_ARG_OPT(
+        seed,
+        integer,
+        1,
+        "Seed for the jitter and failures (the same seed repeats the same "
+        "sequence).")
+      + GROUP_ARG_OPT(
+        duration,
+        integer,
+        0,
+        "Seconds to serve before stopping (0 serves until `ctrl+c`)."));
+
+  if (!command.is_valid(reference, printer())) {
+    return printer().close_fail();
+  }
+
+  const StringView port = command.get_argument_value("port");
+  const StringView path = command.get_argument_value("path");
+  const StringView latency = command.get_argument_value("latency");
+  const StringView jitter = command.get_argument_value("jitter");
+  const StringView failure_rate = command.get_argument_value("failure");
+  const StringView seed = command.get_argument_value("seed");
+  const StringView duration = command.get_argument_value("duration");
+
+  command.print_options(printer());
+
+  SlPrinter::Output printer_output_guard(printer());
+
+  if (failure_rate.to_integer() > 100) {
+    APP_RETURN_ASSIGN_ERROR("`failure` must be a percentage (0 to 100)");
+  }
+
+  const auto store_path = path.is_empty()
+                            ? FilePathSettings::global_directory() / "standin"
+                            : PathString(path);
+
+  CloudStandIn cloud_stand_in;
+  cloud_stand_in.set_port(port.is_empty() ? 8090 : port.to_integer())
+    .set_path(store_path)
+    .set_latency(latency.to_integer())
+    .set_jitter(jitter.to_integer())
+    .set_failure_rate(failure_rate.to_integer())
+    .set_seed(seed.is_empty() ? 1 : seed.to_integer());
+
+  cloud_stand_in.start();
+  if (is_error()) {
+    return printer().close_fail();
+  }
+
+  {
+    Printer::Object po(printer().active_printer(), "standin");
+    printer()
+      .key(
+        "url",
+        String("http://localhost:")
+          + NumberString(cloud_stand_in.port()).string_view())
+      .key("path", store_path);
+  }
+  printer().info("push `ctrl+c` to stop serving");
+
+  const u32 duration_seconds = duration.to_integer();
+  ClockTimer timer;
+  timer.start();
+  while (session_settings().is_interrupted() == false
+         && (duration_seconds == 0 || timer.seconds() < duration_seconds)) {
+    chrono::wait(100_milliseconds);
+  }
+
+  // releases the port before the next command (for example in daemon mode)
+  cloud_stand_in.stop();
+
+  const auto statistics = cloud_stand_in.statistics();
+  Printer::Object po(printer().active_printer(), "statistics");
+  printer()
+    .key("requests", NumberString(statistics.request_count()))
+    .key("injectedFailures", NumberString(statistics.failure_count()))
+    .key("objects", NumberString(statistics.object_count()))
+    .key("notFound", NumberString(statistics.not_found_count()));
+
+  return is_success();
+}
+
 void CloudGroup::apply_app_updates(const CloudAppUpdate &update) {
 
 
@@ -1116,10 +1264,12 @@ void CloudGroup::apply_app_updates(const CloudAppUpdate &update) {
 
   Printer::Object(printer().active_printer(), app_path);
 
-  const Appfs::Info info = Appfs(connection()->driver()).get_info(app_path);
+  const Appfs::Info info
+    = DeviceCache::get_appfs_info(connection()->driver(), app_path);
   // remove the application if it is present -- may have been deleted by the
   // OS update
   Link::FileSystem(connection()->driver()).remove(app_path);
+  DeviceCache::invalidate(app_path);
 
   SL_PRINTER_TRACE(
     "installing application " + update.project().get_document_id());
@@ -1139,6 +1289,8 @@ void CloudGroup::apply_app_updates(const CloudAppUpdate &update) {
       .set_external_data(update.info().is_data_external())
       .set_tightly_coupled_code(update.info().is_code_tightly_coupled())
       .set_tightly_coupled_data(update.info().is_data_tightly_coupled()));
+
+  DeviceCache::invalidate(update.path());
 }
 
 bool CloudGroup::check_for_update() { return false; }
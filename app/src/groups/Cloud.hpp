@@ -48,6 +48,7 @@ private:
     command_connect,
     command_listen,
     command_remove,
+    command_standin,
     command_total
   };
 
@@ -65,6 +66,7 @@ private:
   bool connect(const Command &command);
   bool listen(const Command &command);
   bool remove(const Command &command);
+  bool standin(const Command &command);
 
   bool is_project_path_valid(const StringView path);
 
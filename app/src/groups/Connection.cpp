@@ -16,6 +16,7 @@
 #include <usb/usb_link_transport_driver.h>
 #include <var.hpp>
 
+#include "utilities/DeviceCache.hpp"
 #include "utilities/OperatingSystem.hpp"
 
 Connection::Connection() : Group("connection", "conn") {}
@@ -281,6 +282,16 @@ bool Connection::connect(const Command &command) {
         int,
         500,
         "number of milliseconds to wait between reconnect attempts.")
+      + GROUP_ARG_OPT(
+        latency,
+        int,
+        0,
+        "per-packet latency in microseconds (`/sim` only).")
+      + GROUP_ARG_OPT(
+        bandwidth,
+        int,
+        <unlimited>,
+        "link bandwidth in bytes per second (`/sim` only).")
     //",delay_d=opt_int_500|number of milliseconds to wait between reconnect
     // attempts.||conn.connect:retry=5,delay=1000|"
   );
@@ -302,6 +313,9 @@ bool Connection::connect(const Command &command) {
   StringView parity = command.get_argument_value("parity");
   StringView is_save = command.get_argument_value("save");
 
+  StringView latency = command.get_argument_value("latency");
+  StringView bandwidth = command.get_argument_value("bandwidth");
+
   u32 retry_count = static_cast<u32>(retry.to_unsigned_long());
   u32 delay_ms = static_cast<u32>(delay.to_integer());
 
@@ -360,6 +374,13 @@ bool Connection::connect(const Command &command) {
   SlPrinter::Output printer_output_guard(printer());
   Link::DriverPath link_driver_path(path);
 
+  if (SimulatedDevice::is_simulated_path(path)) {
+    SimulatedDevice::set_options(
+      SimulatedDevice::Options()
+        .set_latency(latency.to_unsigned_long() * 1_microseconds)
+        .set_bandwidth(bandwidth.to_unsigned_long()));
+  }
+
   if (link_driver_path.is_valid() == false) {
     APP_RETURN_ASSIGN_ERROR(
       link_driver_path.path().string_view() + " is not a valid device path");
@@ -420,6 +441,7 @@ bool Connection::try_connect(const TryConnect &options) {
   if (is_success() && is_connected()) {
     session_settings().set_path(options.driver_path().path());
     session_settings().set_serial_number(info().serial_number().to_string());
+    DeviceCache::clear();
     return true;
   }
 
@@ -506,6 +528,11 @@ bool Connection::is_path_blacklisted(const var::StringView path) {
 }
 
 fs::PathList Connection::create_path_list(const var::StringView driver_name) {
+  // the simulated device is never picked up when connecting to `<any>`
+  if (driver_name == SimulatedDevice::driver_name()) {
+    return SimulatedDevice::get_path_list();
+  }
+
   if (sys::System::is_windows()) {
     return create_path_list_windows(driver_name);
   }
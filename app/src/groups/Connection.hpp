@@ -8,6 +8,7 @@
 #include <usb/usb_link_transport_driver.h>
 
 #include "../Group.hpp"
+#include "../utilities/SimulatedDevice.hpp"
 
 class Connection : public sos::Link, public Group {
 public:
@@ -59,7 +60,10 @@ private:
   fs::PathList create_path_list_posix(const var::StringView driver_name);
 
   void load_driver(const var::StringView path) {
-    if (path.find("/usb") == 0 || path.find("@usb") == 0) {
+    if (SimulatedDevice::is_simulated_path(path)) {
+      SL_PRINTER_TRACE("Load simulated device driver");
+      SimulatedDevice::load_driver(driver());
+    } else if (path.find("/usb") == 0 || path.find("@usb") == 0) {
       SL_PRINTER_TRACE("Load USB driver");
       usb_link_transport_load_driver(driver());
     } else {
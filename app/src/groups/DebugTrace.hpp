@@ -18,6 +18,7 @@ public:
   bool execute_trace(const Command &command);
 
 private:
+  friend class SelfBench;
   enum commands { command_trace, command_analyze, command_total };
 
   hal::FrameBuffer m_trace;
@@ -1,5 +1,8 @@
 ﻿// COPYING: Copyright 2017-2020 Tyler Gilbert and Stratify Labs. All rights
 // reserved
+#include <algorithm>
+#include <cstring>
+
 #include <chrono.hpp>
 #include <fs/File.hpp>
 #include <printer.hpp>
@@ -9,7 +12,11 @@
 #include <var.hpp>
 
 #include "FileSystem.hpp"
+#include "utilities/AssetfsReader.hpp"
+#include "utilities/DeviceCache.hpp"
 #include "utilities/Packager.hpp"
+#include "utilities/ThreadPool.hpp"
+#include "utilities/XmlStream.hpp"
 
 FileSystemGroup::FileSystemGroup() : Connector("filesystem", "fs") {}
 
@@ -125,7 +132,8 @@ bool FileSystemGroup::list(const Command &command) {
 
   SlPrinter::Output printer_output_guard(printer());
   Link::FileSystem source_file_system(source_path.driver());
-  FileInfo path_info = source_file_system.get_info(source_path.path());
+  FileInfo path_info
+    = DeviceCache::get_info(source_path.driver(), source_path.path());
 
   if (is_error()) {
     APP_RETURN_ASSIGN_ERROR(source_path.path_description() + " does not exist");
@@ -157,7 +165,17 @@ bool FileSystemGroup::list(const Command &command) {
   PathList list;
   {
     SlPrinter::Object progress_object(printer().output(), "progress");
-    if (path_info.is_directory()) {
+    if (path_info.is_directory() && details == "true" && recursive != "true") {
+      // one listing plus the entry info (shared with later commands)
+      const auto info_list = DeviceCache::read_directory_info(
+        source_path.driver(),
+        source_path.path(),
+        hide == "true");
+
+      for (const auto &item : info_list) {
+        list_entry(item.name(), item.info(), true);
+      }
+    } else if (path_info.is_directory()) {
 
       struct Context {
         int count = 0;
@@ -199,12 +217,21 @@ bool FileSystemGroup::list(const Command &command) {
     for (const auto &entry : list) {
       count++;
       printer().output().update_progress(count, list.count());
-      list_entry(
-        source_path.path(),
-        entry,
-        details == "true",
-        hide == "true",
-        source_path.driver());
+      if (is_error() || (hide == "true" && entry.string_view().find(".") == 0)) {
+        continue;
+      }
+
+      fs::FileInfo info;
+      if (details == "true") {
+        info = DeviceCache::get_info(
+          source_path.driver(),
+          source_path.path() / entry);
+        if (!info.is_valid()) {
+          SL_PRINTER_TRACE(
+            "failed to get info for " & source_path.path() / entry);
+        }
+      }
+      list_entry(entry, info, details == "true");
     }
     printer().output().update_progress(0, 0);
     printer().output().set_progress_key("details");
@@ -228,22 +255,22 @@ void FileSystemGroup::list_assets(
   const var::StringView path,
   const fs::FileObject &assets) {
 
-  DataFile asset_data;
-  asset_data.write(assets).seek(0);
+  // only the dirent table is read (not the payloads)
+  const AssetfsReader reader(assets);
+  if (is_error()) {
+    return;
+  }
 
-  u32 count = 0;
-  asset_data.read(View(count));
+  SL_PRINTER_TRACE(
+    GeneralString().format("asset has %d entries", reader.count()));
 
-  SL_PRINTER_TRACE(GeneralString().format("asset has %d entries", count));
+  const auto entry_list = reader.get_entry_list();
 
   printer().start_table(
     StringViewList({path, "type", "size", "owner", "mode"}));
-  for (u32 i = 0; i < count; i++) {
-    drive_assetfs_dirent_t entry;
-    asset_data.read(View(entry));
-
+  for (const auto &entry : entry_list) {
     printer().append_table_row(StringViewList(
-      {StringView(entry.name),
+      {StringView(entry.name, strnlen(entry.name, sizeof(entry.name))),
        "file",
        NumberString(entry.size),
        NumberString(entry.uid, "%d"),
@@ -253,54 +280,40 @@ void FileSystemGroup::list_assets(
   printer().finish_table();
 }
 
-bool FileSystemGroup::list_entry(
-  const var::StringView path,
+void FileSystemGroup::list_entry(
   const var::StringView entry,
-  bool is_details,
-  bool is_hide,
-  link_transport_mdriver_t *driver) {
-  API_RETURN_VALUE_IF_ERROR(false);
-  if (!is_hide || (entry.find(".") != 0)) {
-    fs::FileInfo info;
-
-    if (is_details) {
-      info = Link::FileSystem(driver).get_info(path / entry);
-
-      if (!info.is_valid()) {
-        SL_PRINTER_TRACE("failed to get info for " & path / entry);
-      }
-
-      var::String type;
-      if (info.is_directory()) {
-        type = "directory";
-      }
-      if (info.is_file()) {
-        type = "file";
-      }
-      if (info.is_device()) {
-        type = "device";
-      }
-      if (info.is_block_device()) {
-        type = "block device";
-      }
-      if (info.is_character_device()) {
-        type = "character device";
-      }
-      if (info.is_socket()) {
-        type = "socket";
-      }
-      printer().append_table_row(StringViewList(
-        {entry,
-         type,
-         NumberString(info.size()),
-         NumberString(info.owner(), "%d"),
-         NumberString(info.permissions().permissions() & 0777, "0%o")}));
+  const fs::FileInfo &info,
+  bool is_details) {
+  if (!is_details) {
+    printer().append_table_row(StringViewList({entry}));
+    return;
+  }
 
-    } else {
-      printer().append_table_row(StringViewList({entry}));
-    }
+  var::String type;
+  if (info.is_directory()) {
+    type = "directory";
   }
-  return true;
+  if (info.is_file()) {
+    type = "file";
+  }
+  if (info.is_device()) {
+    type = "device";
+  }
+  if (info.is_block_device()) {
+    type = "block device";
+  }
+  if (info.is_character_device()) {
+    type = "character device";
+  }
+  if (info.is_socket()) {
+    type = "socket";
+  }
+  printer().append_table_row(StringViewList(
+    {entry,
+     type,
+     NumberString(info.size()),
+     NumberString(info.owner(), "%d"),
+     NumberString(info.permissions().permissions() & 0777, "0%o")}));
 }
 
 bool FileSystemGroup::mkdir(const Command &command) {
@@ -352,6 +365,7 @@ bool FileSystemGroup::mkdir(const Command &command) {
       link_path.path(),
       FileSystem::IsRecursive::no,
       Permissions(mode_value));
+    DeviceCache::invalidate(link_path.path());
 
     if (is_success()) {
       printer().key("created", path);
@@ -410,7 +424,8 @@ bool FileSystemGroup::remove(const Command &command) {
 
   Link::FileSystem file_system(link_path.driver());
 
-  FileInfo path_info = file_system.get_info(link_path.path());
+  FileInfo path_info
+    = DeviceCache::get_info(link_path.driver(), link_path.path());
 
   if (is_error()) {
     APP_RETURN_ASSIGN_ERROR(link_path.path_description() + " does not exist");
@@ -419,15 +434,31 @@ bool FileSystemGroup::remove(const Command &command) {
   if (is_all == "true") {
     SL_PRINTER_TRACE("reading directory list");
 
-    PathList list = file_system.read_directory(link_path.path());
+    // entry info comes with the listing (or from an earlier `fs.list`)
+    const auto info_list
+      = DeviceCache::read_directory_info(link_path.driver(), link_path.path());
+    DeviceCache::invalidate(link_path.path());
 
-    SL_PRINTER_TRACE(String().format("processing %d items", list.count()));
+    SL_PRINTER_TRACE(
+      String().format("processing %d items", info_list.count()));
 
-    for (const PathString &entry : list) {
+    u32 fail_count = 0;
+    for (const auto &item : info_list) {
 
-      Link::Path link_file_path(path + "/" + entry, connection()->driver());
+      Link::Path link_file_path(path + "/" + item.name(), connection()->driver());
 
-      FileInfo info = file_system.get_info(link_file_path.path());
+      FileInfo info = item.info();
+      if (!info.is_valid()) {
+        // the listing couldn't stat this entry -- try once more before giving up
+        info = file_system.get_info(link_file_path.path());
+        if (is_error() || !info.is_valid()) {
+          API_RESET_ERROR();
+          printer().warning(
+            "failed to get info for " + link_file_path.path_description());
+          fail_count++;
+          continue;
+        }
+      }
 
       if (info.is_directory() && (is_recursive == "true")) {
 
@@ -438,7 +469,10 @@ bool FileSystemGroup::remove(const Command &command) {
           Dir::IsRecursive::yes);
 
         if (is_error()) {
-          printer().warning("failed to remove " + path);
+          API_RESET_ERROR();
+          printer().warning(
+            "failed to remove " + link_file_path.path_description());
+          fail_count++;
         }
       }
 
@@ -447,16 +481,27 @@ bool FileSystemGroup::remove(const Command &command) {
 
         file_system.remove(link_file_path.path());
         if (is_error()) {
-          printer().warning("failed to remove " + path);
+          API_RESET_ERROR();
+          printer().warning(
+            "failed to remove " + link_file_path.path_description());
+          fail_count++;
         }
       }
     }
 
+    if (fail_count) {
+      APP_RETURN_ASSIGN_ERROR(String().format(
+        "failed to remove %d items in %s",
+        fail_count,
+        link_path.path_description().cstring()));
+    }
+
     return is_success();
 
   } else {
 
     SL_PRINTER_TRACE("not removing all");
+    DeviceCache::invalidate(link_path.path());
 
     if (is_recursive == "true") {
       SL_PRINTER_TRACE("start recursive remove");
@@ -596,14 +641,15 @@ bool FileSystemGroup::copy(const Command &command) {
   Link::FileSystem destination_file_system(destination_link_path.driver());
 
   const FileInfo source_info
-    = source_file_system.get_info(source_link_path.path());
+    = DeviceCache::get_info(source_link_path.driver(), source_link_path.path());
   if (is_error()) {
     APP_RETURN_ASSIGN_ERROR(
       "failed to get info for " + source_link_path.path_description());
   }
 
-  const FileInfo destination_info
-    = destination_file_system.get_info(destination_link_path.path());
+  const FileInfo destination_info = DeviceCache::get_info(
+    destination_link_path.driver(),
+    destination_link_path.path());
 
   bool is_check_destination_overwrite = false;
   if (is_error()) {
@@ -616,6 +662,7 @@ bool FileSystemGroup::copy(const Command &command) {
   }
 
   PathList source_list;
+  DeviceCache::DirectoryInfoList source_info_list;
   if (source_info.is_directory()) {
     SL_PRINTER_TRACE("source is a directory");
 
@@ -633,6 +680,7 @@ bool FileSystemGroup::copy(const Command &command) {
         destination_link_path.path(),
         Dir::IsRecursive::yes,
         Permissions(0777));
+      DeviceCache::invalidate(destination_link_path.path());
 
       if (is_error()) {
         APP_RETURN_ASSIGN_ERROR("failed to create destination directory");
@@ -650,9 +698,19 @@ bool FileSystemGroup::copy(const Command &command) {
 
     SL_PRINTER_TRACE("Read list for " + source_link_path.path_description());
 
-    source_list = source_file_system.read_directory(
-      source_link_path.path(),
-      (is_recursive == "true" ? Dir::IsRecursive::yes : Dir::IsRecursive::no));
+    if (is_recursive == "true") {
+      source_list = source_file_system.read_directory(
+        source_link_path.path(),
+        Dir::IsRecursive::yes);
+    } else {
+      // the entry info replaces a stat per copied file
+      source_info_list = DeviceCache::read_directory_info(
+        source_link_path.driver(),
+        source_link_path.path());
+      for (const auto &item : source_info_list) {
+        source_list.push_back(item.name());
+      }
+    }
 
     for (auto &entry : source_list) {
       SL_PRINTER_TRACE("preparing to copy " + entry);
@@ -721,14 +779,19 @@ bool FileSystemGroup::copy(const Command &command) {
                                 && (destination_path.path().find("/app") == 0);
 
     if (is_check_destination_overwrite) {
-      is_destination_valid
-        = destination_file_system.get_info(destination_link_path.path())
-            .is_valid();
+      is_destination_valid = DeviceCache::get_info(
+                               destination_link_path.driver(),
+                               destination_link_path.path())
+                               .is_valid();
     }
 
     chrono::ClockTimer transfer_timer;
-    FileInfo local_source_info
-      = source_file_system.get_info(source_link_path.path());
+    const FileInfo local_source_info
+      = source_info_list.count() == source_list.count()
+          ? source_info_list.at(i).info()
+          : DeviceCache::get_info(
+            source_link_path.driver(),
+            source_link_path.path());
 
     printer().key("source", source_path.path_description());
     printer().key("destination", destination_path.path_description());
@@ -774,7 +837,8 @@ bool FileSystemGroup::copy(const Command &command) {
             .set_name(destination_path.path())
             .set_size(source_file.size()),
           destination_file_system.driver())
-          .append(source_file, printer().output().progress_callback());
+          .append(source_file, printer().progress_callback());
+        DeviceCache::invalidate(destination_path.path());
 
         if (is_error()) {
 
@@ -801,6 +865,7 @@ bool FileSystemGroup::copy(const Command &command) {
             destination_file_system.create_directory(
               destination_parent_path,
               Dir::IsRecursive::yes);
+            DeviceCache::invalidate(destination_parent_path);
 
             if (is_error()) {
               APP_RETURN_ASSIGN_ERROR(
@@ -831,9 +896,10 @@ bool FileSystemGroup::copy(const Command &command) {
               OpenMode::read_only(),
               source_path.driver()),
             File::Write().set_progress_callback(
-              printer().output().progress_callback()));
+              printer().progress_callback()));
 
         transfer_timer.stop();
+        DeviceCache::invalidate(destination_path.path());
       }
       printer().output().progress_key() = "progress";
 
@@ -908,6 +974,7 @@ bool FileSystemGroup::format(const Command &command) {
 
   printer().key(link_path.path_description(), "format");
   connection()->format(link_path.path());
+  DeviceCache::invalidate(link_path.path());
 
   printer().troubleshoot(
     "**Note.** The format command initiates the filesystem format but does "
@@ -1139,6 +1206,7 @@ bool FileSystemGroup::write(const Command &command) {
   printer().output().set_progress_key("progress");
 
   transfer_timer.stop();
+  DeviceCache::invalidate(destination_link_path.path());
 
   {
     Printer::Object po(printer().active_printer(), "transfer");
@@ -1252,53 +1320,46 @@ bool FileSystemGroup::read(const Command &command) {
   }
 
   // is a read to <assets>.assetfs/<filename>?
+  const auto assetfs_path = Path::parent_directory(source_link_path.path());
   const auto is_assetfs = [&]() {
-    if (source_link_path.is_device_path()) {
+    if (Path::suffix(assetfs_path) != "assetfs") {
       return false;
     }
-    const auto parent_directory
-      = Path::parent_directory(source_link_path.path());
-    const auto suffix = Path::suffix(parent_directory);
-    return suffix == "assetfs";
+    api::ErrorScope error_scope;
+    return Link::FileSystem(source_link_path.driver())
+      .get_info(assetfs_path)
+      .is_file();
   }();
 
-  DataFile asset_file;
   Link::File link_source_file;
+  AssetfsReader::Entry asset_entry = {};
 
   if (is_assetfs) {
 
-    const auto file_path = Path::parent_directory(source_link_path.path());
-
-    if (!FileSystem().exists(file_path)) {
-      APP_RETURN_ASSIGN_ERROR(source | " assetfs does not exist");
-    }
-
-    Data asset_data = DataFile().write(File(file_path)).data();
-    DataFile assetsfs_file(OpenMode::read_only());
-    assetsfs_file.data() = asset_data;
+    // the entry is streamed directly out of the bundle (host or device)
+    link_source_file = Link::File(
+                         assetfs_path,
+                         OpenMode::read_only(),
+                         source_link_path.driver())
+                         .move();
 
-    u32 count = 0;
-    assetsfs_file.read(View(count));
+    const AssetfsReader reader(link_source_file);
     const auto file_name = Path::name(source_link_path.path());
-    for (const auto i : api::Index(count)) {
-      MCU_UNUSED_ARGUMENT(i);
-      drive_assetfs_dirent_t entry;
-      assetsfs_file.read(View(entry));
-      if (file_name == entry.name) {
-        asset_file
-          .write(
-            assetsfs_file.seek(int(entry.start)),
-            File::Write().set_size(size_t(entry.size)))
-          .seek(0);
-        break;
-      }
-    }
+    asset_entry = reader.find(file_name);
 
-    if (asset_file.size() == 0) {
+    if (is_error() || !AssetfsReader::is_entry_valid(asset_entry)) {
       APP_RETURN_ASSIGN_ERROR(
         "failed to find " | file_name | " within assetfs " | source);
     }
 
+    const u32 asset_location = location.to_unsigned_long();
+    if (asset_location > asset_entry.size) {
+      APP_RETURN_ASSIGN_ERROR("location is beyond the end of " | file_name);
+    }
+
+    reader.seek(asset_entry, asset_location);
+    asset_entry.size -= asset_location;
+
   } else {
 
     if (!Link::FileSystem(source_link_path.driver())
@@ -1316,16 +1377,21 @@ bool FileSystemGroup::read(const Command &command) {
   }
 
   FileObject *source_file = &link_source_file;
-  if (is_assetfs) {
-    source_file = &asset_file;
-  }
 
-  SL_PRINTER_TRACE(
-    String().format("reading %d bytes from source", source_file->size()));
+  const u32 source_size
+    = is_assetfs ? asset_entry.size : u32(source_file->size());
 
-  const u32 size_to_read = size.to_integer() > 0      ? size.to_integer()
-                           : source_file->size() == 0 ? static_cast<u32>(-1)
-                                                      : source_file->size();
+  SL_PRINTER_TRACE(String().format("reading %d bytes from source", source_size));
+
+  const u32 size_to_read = [&]() -> u32 {
+    const u32 requested = size.to_integer() > 0 ? size.to_integer() : 0;
+    if (is_assetfs) {
+      return requested && requested < source_size ? requested : source_size;
+    }
+    return requested            ? requested
+           : source_size == 0 ? static_cast<u32>(-1)
+                              : source_size;
+  }();
 
   const u32 chunk_size_value
     = chunk_size.to_unsigned_long() ? chunk_size.to_unsigned_long() : 512;
@@ -1414,6 +1480,7 @@ bool FileSystemGroup::read(const Command &command) {
         .set_progress_callback(printer().progress_callback()));
 
     verify_timer.stop();
+    DeviceCache::invalidate(destination_link_path.path());
   }
 
   if (!is_assetfs) {
@@ -1744,7 +1811,11 @@ bool FileSystemGroup::convert(const Command &command) {
 
   Command reference(
     Command::Group(get_name()),
-    GROUP_ARG_DESC(convert, "converts files from xml to JSON format.")
+    GROUP_ARG_DESC(
+      convert,
+      "converts files from xml to JSON format. Unless `flat` is set, "
+      "attributes become `@<name>` keys, text mixed with child elements "
+      "becomes `#text` and repeated child elements become an array.")
       + GROUP_ARG_REQ(
         source_path,
         string,
@@ -1792,20 +1863,25 @@ bool FileSystemGroup::convert(const Command &command) {
   const auto destination_suffix = fs::Path::suffix(destination);
   if (suffix == "xml") {
 
-    DataFile input_file;
-    input_file.write(File(source));
     printer().output().key("destination", effective_destination);
 
-    const auto is_xml_flat = is_flat != "true" ? JsonDocument::IsXmlFlat::no
-                                               : JsonDocument::IsXmlFlat::yes;
+    if (is_flat == "true") {
+      // the flat structure needs the whole document (DOM converter)
+      DataFile input_file;
+      input_file.write(File(source));
 
-    const auto json_value = JsonDocument().from_xml_string(
-      input_file.data().add_null_terminator(),
-      is_xml_flat);
+      const auto json_value = JsonDocument().from_xml_string(
+        input_file.data().add_null_terminator(),
+        JsonDocument::IsXmlFlat::yes);
 
-    JsonDocument().save(
-      json_value,
-      File(File::IsOverwrite::yes, effective_destination));
+      JsonDocument().save(
+        json_value,
+        File(File::IsOverwrite::yes, effective_destination));
+    } else {
+      XmlStream::convert(
+        File(source),
+        File(File::IsOverwrite::yes, effective_destination));
+    }
 
   } else {
     APP_RETURN_ASSIGN_ERROR("unsupported suffix");
@@ -2287,7 +2363,6 @@ bool FileSystemGroup::gather_assets(const Command &command) {
   for (const AssetInfo &info : asset_info_list) {
     const PathString asset_destination
       = sanitize_asset_destination(info.get_destination());
-    DataFile assets_file(OpenMode::read_write().set_append());
 
     Printer::Object po(printer().active_printer(), asset_destination);
     auto source_list = info.get_source_list();
@@ -2298,9 +2373,22 @@ bool FileSystemGroup::gather_assets(const Command &command) {
         return asset_path().string_view() < a.asset_path().string_view();
       }
 
+      int compare_payload(const AssetEntry &a) const {
+        if (size() != a.size()) {
+          return size() < a.size() ? -1 : 1;
+        }
+        return memcmp(hash().data(), a.hash().data(), hash().count());
+      }
+
     private:
       API_AC(AssetEntry, PathString, host_path);
       API_AC(AssetEntry, PathString, asset_path);
+      API_AC(AssetEntry, crypto::Sha256::Hash, hash);
+      API_AF(AssetEntry, u32, size, 0);
+      API_AF(AssetEntry, u32, start, 0);
+      // offset of the entry whose payload is stored (self if not a duplicate)
+      API_AF(AssetEntry, u32, payload_offset, 0);
+      API_AB(AssetEntry, valid, false);
     };
 
     var::Vector<AssetEntry> asset_list;
@@ -2329,21 +2417,88 @@ bool FileSystemGroup::gather_assets(const Command &command) {
     SL_PRINTER_TRACE(
       "gathering " + NumberString(asset_list.count()) + " assets");
 
+    // size and hash the sources in parallel so identical payloads are
+    // stored once
+    printer().output().set_progress_key("hashing");
+    ThreadPool::execute(
+      ThreadPool::Execute()
+        .set_count(asset_list.count())
+        .set_progress_callback(printer().progress_callback()),
+      [&](size_t offset) {
+        auto &asset = asset_list.at(offset);
+        const auto file_info = FileSystem().get_info(asset.host_path());
+        if (file_info.is_file()) {
+          asset.set_size(file_info.size())
+            .set_hash(crypto::Sha256::get_hash(File(asset.host_path())))
+            .set_valid(is_success());
+        }
+        API_RESET_ERROR();
+      });
+    printer().output().set_progress_key("progress");
+
+    for (const auto &asset : asset_list) {
+      if (!asset.is_valid()) {
+        APP_RETURN_ASSIGN_ERROR("failed to read asset " | asset.host_path());
+      }
+    }
+
+    {
+      // group identical payloads -- ties go to the lowest offset so the
+      // payload owner always precedes its duplicates
+      var::Vector<u32> order;
+      order.reserve(asset_list.count());
+      for (const auto offset : api::Index(asset_list.count())) {
+        order.push_back(offset);
+      }
+
+      std::sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+        const int result = asset_list.at(a).compare_payload(asset_list.at(b));
+        return result != 0 ? result < 0 : a < b;
+      });
+
+      u32 payload_owner = 0;
+      for (const auto offset : api::Index(order.count())) {
+        const u32 current = order.at(offset);
+        if (
+          offset == 0
+          || asset_list.at(current).compare_payload(
+               asset_list.at(payload_owner))
+               != 0) {
+          payload_owner = current;
+        }
+        asset_list.at(current).set_payload_offset(payload_owner);
+      }
+    }
+
+    const u32 count = asset_list.count();
+    u32 duplicate_count = 0;
+    u32 duplicate_size = 0;
+    {
+      // payloads start after the header table (4 is the count)
+      u32 start = sizeof(drive_assetfs_dirent_t) * count + sizeof(count);
+      for (const auto offset : api::Index(asset_list.count())) {
+        auto &asset = asset_list.at(offset);
+        if (asset.payload_offset() == offset) {
+          asset.set_start(start);
+          start += ((asset.size() & ~0x03) + 4); // align at 4 byte boundary
+        } else {
+          asset.set_start(asset_list.at(asset.payload_offset()).start());
+          duplicate_count++;
+          duplicate_size += asset.size();
+        }
+      }
+    }
+
+    SL_PRINTER_TRACE("creating assets at " + asset_destination);
     if (asset_list.count() > 0) {
-      const u32 count = asset_list.count();
+      File assets_file(File::IsOverwrite::yes, asset_destination);
       assets_file.write(View(count));
 
-      // add header table
-      u32 start = sizeof(drive_assetfs_dirent_t) * asset_list.count()
-                  + sizeof(count); // 4 is the count
-
       for (const auto &asset : asset_list) {
-        SL_PRINTER_TRACE("gathering " + asset.host_path() + " for header");
-        const auto file_info = FileSystem().get_info(asset.host_path());
         drive_assetfs_dirent_t dirent = {};
         View(dirent.name).fill(0).copy(View(asset.asset_path().string_view()));
-        dirent.start = start;
-        dirent.size = file_info.size();
+        dirent.start = asset.start();
+        dirent.size = asset.size();
         dirent.mode = access.to_unsigned_long(String::Base::octal);
         dirent.uid = (owner == "user") ? SYSFS_USER : SYSFS_ROOT;
         assets_file.write(View(dirent));
@@ -2351,26 +2506,42 @@ bool FileSystemGroup::gather_assets(const Command &command) {
         SL_PRINTER_TRACE(
           "asset " + asset.host_path() + " starts at "
           + NumberString(dirent.start) + " size " + NumberString(dirent.size));
-
-        start += (((dirent.size) & ~0x03) + 4); // align at 4 byte boundary
       }
 
-      for (const auto &asset : asset_list) {
-        SL_PRINTER_TRACE(
-          "loading " + asset.host_path() + " to write to output");
+      printer().output().set_progress_key("writing");
+      for (const auto offset : api::Index(asset_list.count())) {
+        const auto &asset = asset_list.at(offset);
+        printer().update_progress(offset + 1, asset_list.count());
+        if (asset.payload_offset() != offset) {
+          printer().key(asset.host_path(), "duplicate");
+          continue;
+        }
+
+        SL_PRINTER_TRACE("streaming " + asset.host_path() + " to output");
         assets_file.write(File(asset.host_path()));
-        const int size = return_value();
-        int padding = (size & ~0x03) + 4 - size;
-        SL_PRINTER_TRACE("adding padding " + NumberString(padding));
+        const u32 padding = (asset.size() & ~0x03) + 4 - asset.size();
         Data padding_data(padding);
         View(padding_data).fill<u8>(0);
         assets_file.write(padding_data);
-        printer().key(asset.host_path(), NumberString(size).string_view());
+        printer().key(
+          asset.host_path(),
+          NumberString(asset.size()).string_view());
       }
+      printer().update_progress(0, 0);
+      printer().output().set_progress_key("progress");
+    } else {
+      File(File::IsOverwrite::yes, asset_destination);
     }
 
-    SL_PRINTER_TRACE("creating assets at " + asset_destination);
-    File(File::IsOverwrite::yes, asset_destination).write(assets_file.seek(0));
+    if (duplicate_count) {
+      printer()
+        .key("duplicates", NumberString(duplicate_count))
+        .key("duplicateBytes", NumberString(duplicate_size));
+    }
+
+    if (is_error()) {
+      APP_RETURN_ASSIGN_ERROR("failed to write " | asset_destination);
+    }
 
     if (encrypt == "true") {
       crypto::Aes::Key encryption_key;
@@ -2386,6 +2557,7 @@ bool FileSystemGroup::gather_assets(const Command &command) {
 
       printer().key("key", encryption_key.get_key256_string());
 
+      // the secure file reads the bundle back from disk (not from RAM)
       sos::Auth::create_secure_file(
         sos::Auth::CreateSecureFile()
           .set_padding_character(0)
@@ -2407,20 +2579,31 @@ bool FileSystemGroup::gather_assets(const Command &command) {
             .move();
 
       var::GeneralString line;
-      const auto &data = assets_file.data();
-      for (auto offset : api::Index(data.size())) {
-        if (offset % 16 == 0) {
-          c_file.write(line.append("\n").string_view());
-          line = "";
+      File assets_file(asset_destination);
+      Data buffer(4096);
+      size_t offset = 0;
+      while (assets_file.read(buffer).return_value() > 0) {
+        const size_t bytes_read = assets_file.return_value();
+        for (const auto i : api::Index(bytes_read)) {
+          if (offset++ % 16 == 0) {
+            c_file.write(line.append("\n").string_view());
+            line = "";
+          }
+          line
+            |= (NumberString(buffer.data_u8()[i], "0x%02X,").string_view());
+        }
+        if (is_error()) {
+          APP_RETURN_ASSIGN_ERROR("failed to write " | source_file);
         }
-        line |= (NumberString(data.data_u8()[offset], "0x%02X,").string_view());
       }
+      // only the read that ends the loop can fail here
+      API_RESET_ERROR();
 
       c_file.write(line.pop_back().append("\n};\n\n").string_view());
     }
   }
 
-  return true;
+  return is_success();
 }
 
 PathString
@@ -74,12 +74,10 @@ private:
 
   static GeneralString get_cipher_key(const StringView key, const StringView password);
 
-  static bool list_entry(
-    const StringView path,
+  static void list_entry(
     const StringView entry,
-    bool is_details,
-    bool is_hide,
-    link_transport_mdriver_t *driver);
+    const fs::FileInfo &info,
+    bool is_details);
 };
 
 #endif // FILESYSTEM_HPP
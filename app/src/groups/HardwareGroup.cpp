@@ -1,12 +1,13 @@
 #include <var.hpp>
 
 #include "HardwareGroup.hpp"
+#include "utilities/Inventory.hpp"
 
 HardwareGroup::HardwareGroup() : Group("hardware", "hw") {}
 
 var::StringViewList HardwareGroup::get_command_list() const {
 
-  StringViewList list = {"ping", "publish"};
+  StringViewList list = {"ping", "publish", "sync"};
   API_ASSERT(list.count() == command_total);
 
   return list;
@@ -21,6 +22,8 @@ bool HardwareGroup::execute_command_at(
     return ping(command);
   case command_publish:
     return publish(command);
+  case command_sync:
+    return sync(command);
   }
   return false;
 }
@@ -114,3 +117,92 @@ bool HardwareGroup::publish(const Command &command) {
 
   return is_success();
 }
+
+bool HardwareGroup::sync(const Command &command) {
+
+  printer().open_command(GROUP_COMMAND_NAME);
+  GROUP_ADD_SESSION_REPORT_TAG();
+
+  Command reference(
+    Command::Group(get_name()),
+    GROUP_ARG_DESC(
+      sync,
+      "keeps a local snapshot of hardware documents up to date and queries it. "
+      "Every hardware description already in the snapshot is pulled again "
+      "once it is older than `maxage`. The cloud has no collection listing or "
+      "changed-since query, so only ids given with `hardware` (or already in "
+      "the snapshot) are synced, and documents are pulled one at a time.")
+      + GROUP_ARG_OPT(
+        hardware_id,
+        string,
+        <none>,
+        "ids to add to the snapshot (separate multiple ids with `?`).")
+      + GROUP_ARG_OPT(
+        maxage,
+        integer,
+        0,
+        "Seconds before a document in the snapshot is pulled again (`0` "
+        "pulls every document on each sync).")
+      + GROUP_ARG_OPT(
+        refresh,
+        bool,
+        false,
+        "Pull every document regardless of `maxage`.")
+      + GROUP_ARG_OPT(
+        local,
+        bool,
+        false,
+        "Answer from the snapshot without contacting the cloud.")
+      + GROUP_ARG_OPT(
+        remove,
+        string,
+        <none>,
+        "ids to drop from the snapshot (separate multiple ids with `?`).")
+      + GROUP_ARG_OPT(
+        query,
+        string,
+        <none>,
+        "List the ids where `<key>=<value>` (use `.` to select nested keys)."));
+
+  if (!command.is_valid(reference, printer())) {
+    return printer().close_fail();
+  }
+
+  StringView identifier = command.get_argument_value("hardware");
+  StringView maxage = command.get_argument_value("maxage");
+  StringView refresh = command.get_argument_value("refresh");
+  StringView local = command.get_argument_value("local");
+  StringView remove = command.get_argument_value("remove");
+  StringView query = command.get_argument_value("query");
+
+  command.print_options(printer());
+
+  if (local != "true" && is_cloud_ready() == false) {
+    return printer().close_fail();
+  }
+
+  SlPrinter::Output printer_output_guard(printer());
+
+  Inventory("hardware").execute(
+    Inventory::Options()
+      .set_identifier(identifier)
+      .set_remove(remove)
+      .set_query(query)
+      .set_maximum_age(maxage.to_integer())
+      .set_refresh(refresh == "true")
+      .set_local(local == "true"),
+    [this](const StringView id) {
+      Hardware document(id);
+      if (!document.is_existing()) {
+        SL_PRINTER_TRACE(
+          "document traffic " + cloud_service().store().traffic());
+        API_RETURN_VALUE_ASSIGN_ERROR(
+          JsonObject(),
+          "hardware does not exist",
+          ENOENT);
+      }
+      return document.to_object();
+    });
+
+  return is_success();
+}
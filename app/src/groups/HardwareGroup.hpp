@@ -13,8 +13,9 @@ private:
 
   bool ping(const Command &command);
   bool publish(const Command &command);
+  bool sync(const Command &command);
 
-  enum commands { command_ping, command_publish, command_total };
+  enum commands { command_ping, command_publish, command_sync, command_total };
 };
 
 #endif // GROUP_HARDWARE_GROUP_HPP
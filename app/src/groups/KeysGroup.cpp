@@ -3,13 +3,23 @@
 #include <var.hpp>
 
 #include "KeysGroup.hpp"
+#include "settings/FilePathSettings.hpp"
+#include "utilities/Keyring.hpp"
+#include "utilities/ThreadPool.hpp"
 
 KeysGroup::KeysGroup() : Group("keys", "key") {}
 
 var::StringViewList KeysGroup::get_command_list() const {
 
   StringViewList list
-    = {"ping", "publish", "sign", "verify", "revoke", "remove", "download"};
+    = {"ping",
+       "publish",
+       "sign",
+       "verify",
+       "revoke",
+       "remove",
+       "download",
+       "cache"};
   API_ASSERT(list.count() == command_total);
 
   return list;
@@ -27,11 +37,13 @@ bool KeysGroup::execute_command_at(u32 list_offset, const Command &command) {
   case command_verify:
     return verify(command);
   case command_revoke:
-    return verify(command);
+    return revoke(command);
   case command_remove:
     return remove(command);
   case command_download:
     return download(command);
+  case command_cache:
+    return cache(command);
   }
   return false;
 }
@@ -277,7 +289,9 @@ bool KeysGroup::sign(const Command &command) {
         path,
         string,
         <path to file>,
-        "path to the file that you want to sign.")
+        "path to the file that you want to sign. Multiple paths can be "
+        "separated with `?`. A directory signs each file in the directory and "
+        "`*` can be used in the file name (e.g. `build/*.bin`).")
       + GROUP_ARG_OPT(
         append,
         bool,
@@ -292,7 +306,18 @@ bool KeysGroup::sign(const Command &command) {
         password_pwd,
         string,
         <null>,
-        "password for the private key."));
+        "password for the private key.")
+      + GROUP_ARG_OPT(
+        threads,
+        int,
+        <auto>,
+        "number of files to hash and copy at the same time.")
+      + GROUP_ARG_OPT(
+        maxage,
+        int,
+        86400,
+        "seconds a key from the keyring is used before it is downloaded "
+        "again (only when the cloud is available)."));
 
   if (!command.is_valid(reference, printer())) {
     return printer().close_fail();
@@ -308,10 +333,12 @@ bool KeysGroup::sign(const Command &command) {
   }(command.get_argument_value("password"));
   const StringView append = command.get_argument_value("append");
   const StringView suffix = command.get_argument_value("suffix");
+  const StringView threads = command.get_argument_value("threads");
+  const StringView maxage = command.get_argument_value("maxage");
 
   command.print_options(printer());
 
-  if (is_cloud_ready() == false) {
+  if (!Keyring::is_cached(identifier) && is_cloud_ready() == false) {
     return printer().close_fail();
   }
 
@@ -326,17 +353,18 @@ bool KeysGroup::sign(const Command &command) {
       "password length must be 64 characters to have a 256-bit AES key");
   }
 
-  if (
-    FileSystem().exists(path) == false
-    || FileSystem().get_info(path).is_file() == false) {
+  const auto path_list = get_path_list(path);
+  if (path_list.count() == 0) {
     APP_RETURN_ASSIGN_ERROR("could not find a file at " | path);
   }
 
-  Keys keys_document(identifier);
-
-  if (keys_document.is_valid() == false) {
-    APP_RETURN_ASSIGN_ERROR(
-      "the keys for id `" | identifier | "` do not exist");
+  // the key is fetched and decrypted once for all files
+  Keys keys_document = Keyring::get_keys(
+    identifier,
+    maxage.is_empty() ? Keyring::default_maximum_age()
+                      : maxage.to_unsigned_long());
+  if (is_error()) {
+    return false;
   }
 
   Aes::Key aes_key(
@@ -348,52 +376,128 @@ bool KeysGroup::sign(const Command &command) {
   }
 
   auto dsa = keys_document.get_digital_signature_algorithm(aes_key);
+  auto public_dsa
+    = keys_document.get_digital_signature_algorithm(Aes::Key().nullify());
 
-  // hash the file
+  if (is_error()) {
+    APP_RETURN_ASSIGN_ERROR("failed to load the keys for `" | identifier | "`");
+  }
 
-  const auto hash_string = [](const StringView path) {
-    Sha256 hash;
-    NullFile().write(File(path), hash);
-    return hash.to_string();
-  }(path);
+  class Item {
+  public:
+    PathString path;
+    PathString output_path;
+    GeneralString hash;
+    DigitalSignatureAlgorithm::Signature signature;
+    bool is_verified = false;
+    GeneralString error_message;
+  };
 
-  Sha256::Hash hash_value = Sha256::from_string(hash_string);
+  var::Vector<Item> item_list;
+  item_list.reserve(path_list.count());
+  for (const auto &entry : path_list) {
+    Item item;
+    item.path = entry;
+    if (append == "true") {
+      item.output_path = entry & suffix;
+    }
+    item_list.push_back(item);
+  }
 
   {
-    auto signature = dsa.sign(hash_value);
-    const bool is_verified
-      = keys_document.get_digital_signature_algorithm(Aes::Key().nullify())
-          .verify(signature, hash_value);
+    // the cipher contexts are not shared between threads
+    thread::Mutex dsa_mutex;
+
+    printer().output().set_progress_key("signing");
+    ThreadPool::execute(
+      ThreadPool::Execute()
+        .set_count(item_list.count())
+        .set_thread_count(threads.to_unsigned_long())
+        .set_progress_callback(printer().progress_callback()),
+      [&](size_t index) {
+        auto &item = item_list.at(index);
+
+        // hash and (when appending) copy the file in a single pass
+        Sha256 hash;
+        const File input_file(item.path);
+        const auto input_size = input_file.size();
+        if (item.output_path.is_empty()) {
+          NullFile().write(input_file, hash);
+        } else {
+          File(File::IsOverwrite::yes, item.output_path)
+            .write(input_file, hash);
+        }
+        item.hash = hash.to_string();
+
+        if (is_success()) {
+          const Sha256::Hash hash_value = Sha256::from_string(item.hash);
+          thread::Mutex::Guard mg(dsa_mutex);
+          item.signature = dsa.sign(hash_value);
+          // verify against the in-memory hash rather than rereading the file
+          item.is_verified = public_dsa.verify(item.signature, hash_value);
+        }
+
+        if (is_success() && item.is_verified && !item.output_path.is_empty()) {
+          File output_file(item.output_path, OpenMode::append_write_only());
+          sos::Auth::append(output_file, item.signature);
+          if (
+            is_success()
+            && output_file.size()
+                 != input_size + sizeof(auth_signature_marker_t)) {
+            item.error_message
+              = "failed to verify signature on signed file: "
+                | item.output_path;
+          }
+        }
+
+        if (is_error()) {
+          item.error_message = api::ExecutionContext::error().message();
+          API_RESET_ERROR();
+        } else if (!item.is_verified && item.error_message.is_empty()) {
+          item.error_message = "failed to sign " | item.path;
+        }
+      });
+    printer().output().set_progress_key("progress");
+  }
 
-    printer::Printer::Object po(printer().output(), "signature");
+  u32 fail_count = 0;
+  const auto print_item = [&](const Item &item, const StringView key) {
+    printer::Printer::Object po(printer().output(), key);
     printer()
       .output()
       .key("publicKey", dsa.key_pair().public_key().to_string())
-      .key("sha256", hash_string)
-      .key("signature", signature.to_string())
-      .key_bool("verified", is_verified);
+      .key("sha256", item.hash)
+      .key("signature", item.signature.to_string())
+      .key_bool("verified", item.is_verified);
 
-    if (is_verified == false) {
-      APP_RETURN_ASSIGN_ERROR("failed to sign " | path);
+    if (item.error_message.is_empty()) {
+      if (!item.output_path.is_empty()) {
+        printer().output().key("created", item.output_path);
+      }
+    } else {
+      fail_count++;
+      printer().output().key("error", item.error_message);
     }
+  };
 
-    if (append == "true") {
-      const auto output_file_path = path & suffix;
-      File output_file = File(File::IsOverwrite::yes, output_file_path)
-                           .write(File(path))
-                           .move();
-      sos::Auth::append(output_file, signature);
-      if (
-        sos::Auth::verify(File(output_file_path), dsa.key_pair().public_key())
-        == false) {
-        APP_RETURN_ASSIGN_ERROR(
-          "failed to verify signature on signed file: " | output_file_path);
-      } else {
-        printer().output().key("created", output_file_path);
-      }
+  if (item_list.count() == 1) {
+    print_item(item_list.front(), "signature");
+  } else {
+    printer::Printer::Object po(printer().output(), "signatures");
+    for (const auto &item : item_list) {
+      print_item(item, item.path);
     }
   }
 
+  if (fail_count) {
+    if (item_list.count() == 1) {
+      APP_RETURN_ASSIGN_ERROR(item_list.front().error_message);
+    }
+    APP_RETURN_ASSIGN_ERROR(
+      NumberString(fail_count) | " of " | NumberString(item_list.count())
+      | " files failed to sign");
+  }
+
   if (is_error()) {
     SL_PRINTER_TRACE("document traffic " + cloud_service().store().traffic());
     APP_RETURN_ASSIGN_ERROR("failed to download user `" + identifier + "`");
@@ -423,8 +527,10 @@ bool KeysGroup::verify(const Command &command) {
         path_source,
         string,
         <path to file>,
-        "path to the file that you want to sign (must specify `path` or "
-        "`hash`).")
+        "path to the file that you want to verify (must specify `path` or "
+        "`hash`). Multiple paths can be separated with `?`. A directory "
+        "verifies each file in the directory and `*` can be used in the file "
+        "name (e.g. `build/*.signed`).")
       + GROUP_ARG_OPT(
         strip,
         string,
@@ -436,7 +542,18 @@ bool KeysGroup::verify(const Command &command) {
         string,
         <hash to verify>,
         "256-bit hash (64 characters) to verify the signature on (must specify "
-        "`path` or `hash`)."));
+        "`path` or `hash`).")
+      + GROUP_ARG_OPT(
+        threads,
+        int,
+        <auto>,
+        "number of files to verify at the same time.")
+      + GROUP_ARG_OPT(
+        maxage,
+        int,
+        86400,
+        "seconds a key from the keyring is used before it is downloaded "
+        "again (only when the cloud is available)."));
 
   if (!command.is_valid(reference, printer())) {
     return printer().close_fail();
@@ -447,10 +564,12 @@ bool KeysGroup::verify(const Command &command) {
   const auto signature = command.get_argument_value("signature");
   const auto identifier = command.get_argument_value("key");
   const auto strip = command.get_argument_value("strip");
+  const auto threads = command.get_argument_value("threads");
+  const auto maxage = command.get_argument_value("maxage");
 
   command.print_options(printer());
 
-  if (is_cloud_ready() == false) {
+  if (!Keyring::is_cached(identifier) && is_cloud_ready() == false) {
     return printer().close_fail();
   }
 
@@ -465,101 +584,210 @@ bool KeysGroup::verify(const Command &command) {
     APP_RETURN_ASSIGN_ERROR("you must specify a `path` or a `hash` to verify");
   }
 
-  if (
-    path.is_empty() == false
-    && (FileSystem().exists(path) == false || FileSystem().get_info(path).is_file() == false)) {
+  const auto path_list = get_path_list(path);
+  if (path.is_empty() == false && path_list.count() == 0) {
     APP_RETURN_ASSIGN_ERROR("could not find a file at " | path);
   }
 
-  SlPrinter::Object so(printer().output(), "verify");
-  const auto signature_info = sos::Auth::get_signature_info(File(path));
-
-  const auto is_signed
-    = !path.is_empty() && signature_info.signature().is_valid();
-  if (signature.is_empty() && is_signed == false) {
+  if (path_list.count() > 1 && signature.is_empty() == false) {
     APP_RETURN_ASSIGN_ERROR(
-      "please specify a signed file or a `signature` " | path
-      | " is not signed");
+      "`signature` can only be used when verifying a single file");
   }
 
-  Keys keys_document(identifier);
-
-  const auto effective_signature
-    = is_signed ? signature_info.signature() : Dsa::Signature(signature);
+  SlPrinter::Object so(printer().output(), "verify");
 
-  if (keys_document.is_valid() == false) {
-    APP_RETURN_ASSIGN_ERROR(
-      "the keys for id `" | identifier | "` do not exist");
+  Keys keys_document = Keyring::get_keys(
+    identifier,
+    maxage.is_empty() ? Keyring::default_maximum_age()
+                      : maxage.to_unsigned_long());
+  if (is_error()) {
+    return false;
   }
 
   auto dsa
     = keys_document.get_digital_signature_algorithm(Aes::Key().nullify());
 
-  const auto is_verified = [&]() {
-    if (is_signed) {
-      printer().key(
-        "hash",
-        View(signature_info.hash()).to_string<GeneralString>());
-      return sos::Auth::verify(File(path), dsa.key_pair().public_key());
-    } else {
-      // hash the file
-      const auto hash_string
-        = [](const StringView path, const StringView hash) {
-            if (path.is_empty() == false) {
-              Sha256 sha256;
-              NullFile().write(File(path), sha256);
-              return sha256.to_string();
-            }
-            return var::GeneralString(hash);
-          }(path, hash);
-
-      Sha256::Hash hash_value = Sha256::from_string(hash_string);
-
-      printer().output().key("hash", hash_string);
-
-      return dsa.verify(
-        DigitalSignatureAlgorithm::Signature(signature),
-        hash_value);
-    }
-  }();
+  if (path.is_empty()) {
+    const Sha256::Hash hash_value = Sha256::from_string(hash);
+    const auto is_verified
+      = dsa.verify(DigitalSignatureAlgorithm::Signature(signature), hash_value);
 
-  printer()
-    .output()
-    .key("signature", effective_signature.to_string())
-    .key("publicKey", dsa.key_pair().public_key().to_string())
-    .key_bool("verified", is_verified);
-
-  if (is_verified == false) {
-    if (path.is_empty() == false) {
-      APP_RETURN_ASSIGN_ERROR("failed to verify " | path);
+    printer()
+      .output()
+      .key("hash", hash)
+      .key("signature", signature)
+      .key("publicKey", dsa.key_pair().public_key().to_string())
+      .key_bool("verified", is_verified);
+
+    if (is_verified == false) {
+      APP_RETURN_ASSIGN_ERROR("failed to verify " | hash);
     }
+    return is_success();
+  }
+
+  class Item {
+  public:
+    PathString path;
+    PathString output_path;
+    GeneralString hash;
+    DigitalSignatureAlgorithm::Signature signature;
+    bool is_signed = false;
+    bool is_verified = false;
+    GeneralString error_message;
+  };
 
-    APP_RETURN_ASSIGN_ERROR("failed to verify " | hash);
+  var::Vector<Item> item_list;
+  item_list.reserve(path_list.count());
+  for (const auto &entry : path_list) {
+    Item item;
+    item.path = entry;
+    item_list.push_back(item);
   }
 
-  if (is_error()) {
-    SL_PRINTER_TRACE("document traffic " + cloud_service().store().traffic());
-    APP_RETURN_ASSIGN_ERROR("failed to download user `" + identifier + "`");
+  {
+    thread::Mutex dsa_mutex;
+
+    printer().output().set_progress_key("verifying");
+    ThreadPool::execute(
+      ThreadPool::Execute()
+        .set_count(item_list.count())
+        .set_thread_count(threads.to_unsigned_long())
+        .set_progress_callback(printer().progress_callback()),
+      [&](size_t index) {
+        auto &item = item_list.at(index);
+
+        // the signature marker is read from the end of the file and the
+        // rest is hashed (and copied when stripping) in a single pass
+        const File input_file(item.path);
+        const u32 input_size = input_file.size();
+
+        if (input_size >= sizeof(auth_signature_marker_t)) {
+          auth_signature_marker_t marker;
+          input_file.seek(input_size - sizeof(marker))
+            .read(View(&marker, sizeof(marker)));
+          // parses the marker without rereading the file
+          const auto signature_info
+            = sos::Auth::get_signature_info(
+              ViewFile(View(&marker, sizeof(marker))));
+          item.is_signed = signature_info.signature().is_valid();
+          if (item.is_signed) {
+            item.signature = signature_info.signature();
+          }
+        }
+
+        if (!item.is_signed) {
+          if (signature.is_empty()) {
+            item.error_message
+              = "please specify a signed file or a `signature` " | item.path
+                | " is not signed";
+            return;
+          }
+          item.signature = DigitalSignatureAlgorithm::Signature(signature);
+        }
+
+        if (!strip.is_empty()) {
+          const auto path_suffix = Path::suffix(item.path);
+          if (!item.is_signed) {
+            item.error_message = "Cannot strip signature. File is not signed";
+            return;
+          }
+          if (path_suffix != strip) {
+            item.error_message
+              = "Cannot strip signature. File suffix `" | path_suffix
+                | "` does not match strip suffix `" | strip | "`.";
+            return;
+          }
+          item.output_path = Path::no_suffix(item.path);
+        }
+
+        const u32 content_size
+          = item.is_signed ? input_size - sizeof(auth_signature_marker_t)
+                           : input_size;
+
+        Sha256 sha256;
+        const auto stream_content = [&](const FileObject &output_file) {
+          Data buffer(4096);
+          input_file.seek(0);
+          u32 offset = 0;
+          while (offset < content_size && is_success()) {
+            const u32 page_size = content_size - offset > buffer.size()
+                                    ? buffer.size()
+                                    : content_size - offset;
+            const View page(buffer.data(), page_size);
+            input_file.read(page);
+            sha256.update(page);
+            output_file.write(page);
+            offset += page_size;
+          }
+        };
+
+        if (item.output_path.is_empty()) {
+          stream_content(NullFile());
+        } else {
+          stream_content(File(File::IsOverwrite::yes, item.output_path));
+        }
+        item.hash = sha256.to_string();
+
+        if (is_success()) {
+          const Sha256::Hash hash_value = Sha256::from_string(item.hash);
+          thread::Mutex::Guard mg(dsa_mutex);
+          item.is_verified = dsa.verify(item.signature, hash_value);
+        }
+
+        if (is_error()) {
+          item.error_message = api::ExecutionContext::error().message();
+          API_RESET_ERROR();
+        } else if (!item.is_verified) {
+          item.error_message = "failed to verify " | item.path;
+        }
+
+        if (!item.error_message.is_empty() && !item.output_path.is_empty()) {
+          // only verified files are stripped
+          FileSystem().remove(item.output_path);
+          API_RESET_ERROR();
+          item.output_path = PathString();
+        }
+      });
+    printer().output().set_progress_key("progress");
   }
 
-  if (!strip.is_empty()) {
-    if (!is_signed) {
-      APP_RETURN_ASSIGN_ERROR("Cannot strip signature. File is not signed");
+  u32 fail_count = 0;
+  printer().output().key("publicKey", dsa.key_pair().public_key().to_string());
+  if (item_list.count() == 1) {
+    const auto &item = item_list.front();
+    printer()
+      .output()
+      .key("hash", item.hash)
+      .key("signature", item.signature.to_string())
+      .key_bool("verified", item.is_verified);
+    if (!item.output_path.is_empty()) {
+      printer().output().key("stripped", item.output_path);
     }
+    if (!item.error_message.is_empty()) {
+      APP_RETURN_ASSIGN_ERROR(item.error_message);
+    }
+    return is_success();
+  }
 
-    const auto path_suffix = Path::suffix(path);
-    if (path_suffix != strip) {
-      APP_RETURN_ASSIGN_ERROR(
-        "Cannot strip signature. File suffix `" | path_suffix
-        | "` does not match strip suffix `" | strip | "`.");
+  printer().start_table(
+    StringViewList({"path", "verified", "hash", "stripped", "error"}));
+  for (const auto &item : item_list) {
+    if (!item.error_message.is_empty()) {
+      fail_count++;
     }
+    printer().append_table_row(StringViewList(
+      {item.path,
+       item.is_verified ? "true" : "false",
+       item.hash,
+       item.output_path,
+       item.error_message}));
+  }
+  printer().finish_table(printer::Printer::Level::info);
 
-    const auto output = Path::no_suffix(path);
-    const auto input_file = File(path);
-    const auto original_size = input_file.size();
-    const auto stripped_size = original_size - sizeof(auth_signature_marker_t);
-    File(File::IsOverwrite::yes, output)
-      .write(input_file, File::Write().set_size(stripped_size));
+  if (fail_count) {
+    APP_RETURN_ASSIGN_ERROR(
+      NumberString(fail_count) | " of " | NumberString(item_list.count())
+      | " files failed to verify");
   }
 
   return is_success();
@@ -609,6 +837,10 @@ bool KeysGroup::revoke(const Command &command) {
     keys_document.set_status("revoked").save();
   }
 
+  if (is_success() && Keyring::is_cached(identifier)) {
+    Keyring::save(identifier, keys_document);
+  }
+
   printer().object(identifier, keys_document.to_object());
 
   return is_success();
@@ -639,6 +871,9 @@ bool KeysGroup::remove(const Command &command) {
   SlPrinter::Output printer_output_guard(printer());
 
   Keys(identifier).remove();
+  if (is_success() && Keyring::is_cached(identifier)) {
+    Keyring::remove(identifier);
+  }
 
   if (is_error()) {
     SL_PRINTER_TRACE("document traffic " + cloud_service().store().traffic());
@@ -720,3 +955,220 @@ bool KeysGroup::download(const Command &command) {
 
   return is_success();
 }
+
+bool KeysGroup::cache(const Command &command) {
+
+  printer().open_command(GROUP_COMMAND_NAME);
+  GROUP_ADD_SESSION_REPORT_TAG();
+
+  Command reference(
+    Command::Group(get_name()),
+    GROUP_ARG_DESC(
+      cache,
+      "downloads keys to the local keyring used by `keys.sign` and "
+      "`keys.verify` and shows the contents of the keyring.")
+      + GROUP_ARG_OPT(
+        key_id,
+        string,
+        <none>,
+        "ids of the keys to download. Multiple ids can be separated with "
+        "`?`.")
+      + GROUP_ARG_OPT(
+        refresh,
+        bool,
+        false,
+        "download the keys again even if they are already in the keyring "
+        "(applies to all keys in the keyring if `key` is not specified).")
+      + GROUP_ARG_OPT(
+        remove,
+        bool,
+        false,
+        "remove the keys from the keyring (all keys if `key` is not "
+        "specified)."));
+
+  if (!command.is_valid(reference, printer())) {
+    return printer().close_fail();
+  }
+
+  const auto identifier = command.get_argument_value("key");
+  const auto refresh = command.get_argument_value("refresh");
+  const auto remove = command.get_argument_value("remove");
+
+  command.print_options(printer());
+
+  const auto identifier_list = [&]() {
+    StringViewList result;
+    for (const auto &entry : identifier.split("?")) {
+      if (!entry.is_empty()) {
+        result.push_back(entry);
+      }
+    }
+    return result;
+  }();
+
+  const auto entry_list = Keyring::get_entry_list();
+
+  const auto is_download
+    = remove != "true"
+      && (!identifier_list.is_empty()
+          || (refresh == "true" && !entry_list.is_empty()));
+
+  if (is_download && is_cloud_ready() == false) {
+    return printer().close_fail();
+  }
+
+  SlPrinter::Output printer_output_guard(printer());
+
+  if (remove == "true") {
+    SlPrinter::Object removed_object(printer().output(), "removed");
+    const auto remove_entry = [&](const StringView id) {
+      Keyring::remove(id);
+      printer().key(id, Keyring::get_key_path(id));
+    };
+    if (identifier_list.is_empty()) {
+      for (const auto &entry : entry_list) {
+        remove_entry(entry.id());
+      }
+    } else {
+      for (const auto &id : identifier_list) {
+        remove_entry(id);
+      }
+    }
+  } else if (is_download) {
+    SlPrinter::Object download_object(printer().output(), "downloaded");
+    const auto download_entry = [&](const StringView id) {
+      if (refresh != "true" && Keyring::is_cached(id)) {
+        printer().key(id, "cached");
+        return true;
+      }
+
+      Keys keys_document(id);
+      if (keys_document.is_valid() == false) {
+        APP_RETURN_ASSIGN_ERROR("the keys for id `" | id | "` do not exist");
+      }
+
+      if (is_success()) {
+        Keyring::save(id, keys_document);
+      }
+
+      if (is_error()) {
+        SL_PRINTER_TRACE(
+          "document traffic " + cloud_service().store().traffic());
+        return false;
+      }
+      printer().key(id, keys_document.get_status());
+      return true;
+    };
+
+    if (identifier_list.is_empty()) {
+      for (const auto &entry : entry_list) {
+        if (!download_entry(entry.id())) {
+          break;
+        }
+      }
+    } else {
+      for (const auto &id : identifier_list) {
+        if (!download_entry(id)) {
+          break;
+        }
+      }
+    }
+  }
+
+  if (is_error()) {
+    APP_RETURN_ASSIGN_ERROR("failed to update the keyring");
+  }
+
+  {
+    SlPrinter::Object keyring_object(printer().output(), "keyring");
+    printer().key("path", FilePathSettings::keyring_directory());
+    // times are seconds since the epoch
+    for (const auto &entry : Keyring::get_entry_list()) {
+      SlPrinter::Object entry_object(printer().output(), entry.id());
+      printer()
+        .key("status", entry.status())
+        .key("cached", NumberString(entry.cached()))
+        .key("revoked", NumberString(entry.revoked()));
+    }
+  }
+
+  return is_success();
+}
+
+fs::PathList KeysGroup::get_path_list(const var::StringView path) {
+  fs::PathList result;
+  for (const auto &entry : path.split("?")) {
+    if (entry.is_empty()) {
+      continue;
+    }
+
+    const auto name = Path::name(entry);
+    if (name.find("*") != StringView::npos) {
+      const auto parent = Path::parent_directory(entry);
+      const auto directory = parent.is_empty() ? StringView(".") : parent;
+      if (!FileSystem().directory_exists(directory)) {
+        continue;
+      }
+      for (const auto &candidate : FileSystem().read_directory(directory)) {
+        const auto candidate_path = parent.is_empty()
+                                      ? PathString(candidate)
+                                      : PathString(parent) / candidate;
+        if (
+          is_wildcard_match(name, candidate)
+          && FileSystem().get_info(candidate_path).is_file()) {
+          result.push_back(candidate_path);
+        }
+      }
+      continue;
+    }
+
+    if (!FileSystem().exists(entry)) {
+      continue;
+    }
+
+    const auto info = FileSystem().get_info(entry);
+    if (info.is_file()) {
+      result.push_back(entry);
+    } else if (info.is_directory()) {
+      for (const auto &candidate : FileSystem().read_directory(entry)) {
+        const auto candidate_path = PathString(entry) / candidate;
+        if (FileSystem().get_info(candidate_path).is_file()) {
+          result.push_back(candidate_path);
+        }
+      }
+    }
+  }
+  return result;
+}
+
+bool KeysGroup::is_wildcard_match(
+  const var::StringView pattern,
+  const var::StringView name) {
+  // `*` matches any sequence of characters
+  size_t pattern_offset = 0;
+  size_t name_offset = 0;
+  size_t star_offset = StringView::npos;
+  size_t star_name_offset = 0;
+  while (name_offset < name.length()) {
+    if (
+      pattern_offset < pattern.length()
+      && pattern.at(pattern_offset) == name.at(name_offset)
+      && pattern.at(pattern_offset) != '*') {
+      pattern_offset++;
+      name_offset++;
+    } else if (
+      pattern_offset < pattern.length() && pattern.at(pattern_offset) == '*') {
+      star_offset = pattern_offset++;
+      star_name_offset = name_offset;
+    } else if (star_offset != StringView::npos) {
+      pattern_offset = star_offset + 1;
+      name_offset = ++star_name_offset;
+    } else {
+      return false;
+    }
+  }
+  while (pattern_offset < pattern.length() && pattern.at(pattern_offset) == '*') {
+    pattern_offset++;
+  }
+  return pattern_offset == pattern.length();
+}
@@ -18,6 +18,13 @@ private:
   bool revoke(const Command &command);
   bool remove(const Command &command);
   bool download(const Command&command);
+  bool cache(const Command &command);
+
+  // expands a `?` separated list of files, directories, and `*` patterns
+  static fs::PathList get_path_list(const var::StringView path);
+  static bool is_wildcard_match(
+    const var::StringView pattern,
+    const var::StringView name);
 
   enum commands {
     command_ping,
@@ -27,6 +34,7 @@ private:
     command_revoke,
     command_remove,
     command_download,
+    command_cache,
     command_total
   };
 };
@@ -3,6 +3,8 @@
 #include <var.hpp>
 
 #include "Mcu.hpp"
+#include "utilities/ThreadPool.hpp"
+#include "utilities/XmlStream.hpp"
 
 Mcu::Mcu() : Group("mcu", "mcu") {}
 
@@ -369,44 +371,103 @@ bool Mcu::process_stm32(const Command &command) {
   const PathString loader_path
     = Path::parent_directory(source) / "../bin/FlashLoader";
 
-  JsonObject stm32_config = JsonDocument().load_xml(File(source));
-
+  File input_file(source);
   API_RETURN_VALUE_IF_ERROR(false);
 
-  printer().object("configuration", stm32_config);
-
-  JsonArray device_array
-    = stm32_config.at("Root").to_object().at("Device").to_array();
-
-  for (u32 i = 0; i < device_array.count(); i++) {
-    const StringView device_id
-      = device_array.at(i).to_object().at("DeviceID").to_string_view();
-    Printer::Object device_printer_object(printer().output(), device_id);
-    const PathString loader_elf = loader_path / device_id & ".stldr";
-
-    if (FileSystem().exists(loader_elf)) {
-      printer().key("elf", loader_path / device_id & ".stldr");
-      const auto json_file_path = destination / device_id & ".json";
-      JsonDocument().save(
-        device_array.at(i),
-        File(File::IsOverwrite::yes, json_file_path));
-
-      // create an abbreviated JSON file
-      const JsonObject input_object = JsonDocument().load(File(json_file_path));
-      const auto json_brief_file_path = destination / device_id & "_brief.json";
-      JsonDocument().save(
-        JsonObject()
-          .insert("name", input_object.at("Name"))
-          .insert("type", input_object.at("Type"))
-          .insert("series", input_object.at("Series"))
-          .insert("cpu", input_object.at("CPU"))
-          .insert("deviceId", input_object.at("DeviceID"))
-          .insert("vendor", input_object.at("Vendor")),
-        File(File::IsOverwrite::yes, json_brief_file_path));
-
-      File(File::IsOverwrite::yes, destination / device_id & ".elf")
-        .write(File(loader_elf));
+  struct Device {
+    JsonObject object;
+    PathString device_id;
+    PathString loader_elf;
+    bool is_loader = false;
+    bool is_written = false;
+  };
+
+  // devices are streamed from the XML and written in batches so the whole
+  // configuration is never held in memory
+  var::Vector<Device> device_list;
+  const size_t batch_count = ThreadPool::default_thread_count() * 2;
+  device_list.reserve(batch_count);
+  u32 device_count = 0;
+  PathString failed_device_id;
+
+  const auto process_batch = [&]() {
+    ThreadPool::execute(
+      ThreadPool::Execute().set_count(device_list.count()),
+      [&](size_t offset) {
+        auto &device = device_list.at(offset);
+        device.is_loader = FileSystem().exists(device.loader_elf);
+        if (device.is_loader == false) {
+          return;
+        }
+
+        const auto &input_object = device.object;
+        JsonDocument().save(
+          input_object,
+          File(
+            File::IsOverwrite::yes,
+            destination / device.device_id.string_view() & ".json"));
+
+        // create an abbreviated JSON file from the element already in memory
+        JsonDocument().save(
+          JsonObject()
+            .insert("name", input_object.at("Name"))
+            .insert("type", input_object.at("Type"))
+            .insert("series", input_object.at("Series"))
+            .insert("cpu", input_object.at("CPU"))
+            .insert("deviceId", input_object.at("DeviceID"))
+            .insert("vendor", input_object.at("Vendor")),
+          File(
+            File::IsOverwrite::yes,
+            destination / device.device_id.string_view() & "_brief.json"));
+
+        File(
+          File::IsOverwrite::yes,
+          destination / device.device_id.string_view() & ".elf")
+          .write(File(device.loader_elf));
+
+        device.is_written = is_success();
+        API_RESET_ERROR();
+      });
+
+    for (const auto &device : device_list) {
+      Printer::Object device_printer_object(
+        printer().output(),
+        device.device_id);
+      if (device.is_loader) {
+        printer().key("elf", device.loader_elf);
+        if (!device.is_written && failed_device_id.is_empty()) {
+          failed_device_id = device.device_id;
+        }
+      }
     }
+    device_list.clear();
+  };
+
+  const auto root_name = XmlStream(input_file).for_each_child(
+    [&](const StringView name, const JsonValue &value) {
+      if (name != "Device" || !value.is_object()) {
+        return;
+      }
+
+      const JsonObject object = value.to_object();
+      const auto device_id = object.at("DeviceID").to_string_view();
+      device_list.push_back(
+        Device{object, device_id, loader_path / device_id & ".stldr"});
+      device_count++;
+      if (device_list.count() == batch_count) {
+        process_batch();
+      }
+    });
+
+  API_RETURN_VALUE_IF_ERROR(false);
+  process_batch();
+
+  printer().key("root", root_name);
+  printer().key("devices", NumberString(device_count));
+
+  if (!failed_device_id.is_empty()) {
+    APP_RETURN_ASSIGN_ERROR(
+      "failed to write the files for " | failed_device_id.string_view());
   }
 
   return is_success();
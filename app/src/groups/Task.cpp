@@ -14,7 +14,6 @@ sos::TaskManager::Info TaskSnapshot::m_invalid_info
 TaskSnapshot Task::m_latest_snapshot(chrono::ClockTime::get_system_time());
 
 Task::Task() : Updater("task", "task") {
-  m_max_queue_count = 5000;
   set_update_period(100_milliseconds);
 }
 
@@ -39,7 +38,7 @@ bool Task::update() {
 
     TaskSnapshot snapshot(timestamp);
     TaskSnapshot update_latest_snapshot(timestamp);
-    auto task_info_list = m_task_manager.get_info();
+    auto task_info_list = read_task_info_list();
 
     for (auto &info : task_info_list) {
       if (info.is_valid() && info.is_enabled()) {
@@ -54,111 +53,115 @@ bool Task::update() {
 
     m_latest_snapshot = update_latest_snapshot;
 
-    // history is a queue of snapshots
-    m_task_history.push_back(m_latest_snapshot);
-    if (m_task_history.count() == m_max_queue_count) {
-      m_task_history.pop_front();
-    }
+    m_task_series.append(
+      u64(timestamp.seconds()) * 1000000 + timestamp.nanoseconds() / 1000,
+      snapshot.task_info_list());
   }
 
   return is_running();
 }
 
-TaskSnapshotSummary &
-TaskSnapshotSummary::operator<<(const sos::TaskManager::Info &info) {
-
-  if (info.is_valid()) {
-    if (last_info().is_valid() && info.timer() > last_info().timer()) {
-      m_cpu_time += info.timer() - last_info().timer();
+var::Vector<sos::TaskManager::Info> Task::read_task_info_list() {
+  chrono::ClockTimer request_timer;
+  request_timer.start();
+
+  u64 idle_delta = 0;
+  u64 total_delta = 0;
+  const auto update_slot = [&](u32 id, const sos::TaskManager::Info &info) {
+    auto &slot = m_slot_list.at(id);
+    const auto &previous = slot.info();
+    const bool is_same_task = previous.is_valid() && info.is_valid()
+                              && previous.pid() == info.pid()
+                              && previous.thread_id() == info.thread_id();
+    const u64 delta = is_same_task && info.timer() > previous.timer()
+                        ? info.timer() - previous.timer()
+                        : 0;
+
+    total_delta += delta;
+    if (info.pid() == 0 && info.thread_id() == 0) {
+      idle_delta += delta;
     }
 
-    if (info.stack_size() > maximum_stack_size()) {
-      set_maximum_stack_size(info.stack_size());
+    const bool is_changed = !is_same_task || delta
+                            || info.is_enabled() != previous.is_enabled()
+                            || info.stack_size() != previous.stack_size()
+                            || info.heap_size() != previous.heap_size();
+    const u32 unchanged_count = is_changed ? 0 : slot.unchanged_count() + 1;
+
+    // unchanged tasks are read again after 2, 4, 8 then 16 samples
+    const u32 interval = 1 << (unchanged_count < 4 ? unchanged_count : 4);
+    slot.set_info(info)
+      .set_unchanged_count(unchanged_count)
+      .set_next_sample(m_sample_count + interval);
+  };
+
+  const bool is_full_scan = !m_sampling.is_delta() || m_slot_list.count() == 0
+                            || (m_sample_count % discovery_interval()) == 0;
+
+  if (is_full_scan) {
+    const auto task_info_list = m_task_manager.get_info();
+    // one request per slot plus the one that finds the end of the table
+    m_request_count += task_info_list.count() + 1;
+    m_slot_list.resize(task_info_list.count());
+    for (const auto id : api::Index(task_info_list.count())) {
+      update_slot(id, task_info_list.at(id));
     }
-
-    if (info.heap_size() > maximum_heap_size()) {
-      set_maximum_heap_size(info.heap_size());
+  } else {
+    for (const auto id : api::Index(m_slot_list.count())) {
+      const auto &slot = m_slot_list.at(id);
+      if (slot.info().is_enabled() && m_sample_count >= slot.next_sample()) {
+        auto info = m_task_manager.get_info(id);
+        m_request_count++;
+        if (is_error()) {
+          API_RESET_ERROR();
+          info = sos::TaskManager::Info::invalid();
+        }
+        update_slot(id, info);
+      }
     }
   }
-  set_last_info(info);
 
-  return *this;
-}
+  request_timer.stop();
+  m_request_microseconds += request_timer.microseconds();
+  m_sample_count++;
 
+  // tasks that were not read are assumed idle so the total is still the CPU
+  // time for the whole interval
+  if (m_sampling.is_adaptive() && total_delta) {
+    adapt_update_period(1.0f - idle_delta * 1.0f / total_delta);
+  }
 
-#if 0
-var::String
-Task::create_analysis_chart(const TaskSnapshotList &snapshot_list) const {
-
-
-	ChartJs chart;
-	chart.set_type(ChartJs::type_line);
-
-	u32 color = 0;
-	for (const TaskSummaryList &list : task_info_table.table()) {
-
-		ChartJsDataSet memory_usage_data_set
-				= ChartJsDataSet()
-				.set_label(
-					"memory " + list.name()
-					+ String().format(" %d.%d", list.pid(), list.thread_id()))
-				.set_background_color(ChartJsColor::create_transparent())
-				.set_border_color(ChartJsColor::get_standard(color++).set_alpha(128));
-
-		ChartJsDataSet cpu_usage_data_set
-				= ChartJsDataSet()
-				.set_label(
-					"CPU " + list.name()
-					+ String().format(" %d.%d", list.pid(), list.thread_id()))
-				.set_background_color(ChartJsColor::create_transparent())
-				.set_border_color(ChartJsColor::get_standard(color++).set_alpha(128));
-
-		for (const TaskSummary &summary : list.list()) {
-			String timestamp = summary.timestamp().to_string();
-			// printer().object(timestamp, task_info_snapshot.task_info());
-
-			memory_usage_data_set.append(
-						ChartJsStringDataPoint()
-						.set_x(timestamp)
-						.set_y(NumberString(summary.memory_usage()))
-						.to_object());
-
-			cpu_usage_data_set.append(
-						ChartJsStringDataPoint()
-						.set_x(timestamp)
-						.set_y(NumberString(
-										 summary.cpu_time() * 100.0f / summary.total_cpu_time()))
-						.to_object());
-		}
-
-		chart.data().append(memory_usage_data_set).append(cpu_usage_data_set);
-	}
-
-	chart.options()
-			.set_scales(
-				ChartJsScales()
-				.append_x_axis(
-					ChartJsAxis()
-					.set_display(true)
-					.set_type(ChartJsAxis::type_linear)
-					.set_scale_label(
-						ChartJsScaleLabel().set_display(true).set_label("timestamp")))
-				.append_y_axis(
-					ChartJsAxis()
-					.set_type(ChartJsAxis::type_linear)
-					.set_display(true)
-					.set_ticks(
-						ChartJsAxisTicks().set_minimum(0).set_maximum(100).set_step_size(
-							10))
-					.set_scale_label(ChartJsScaleLabel().set_display(true).set_label(
-														 "Utilization Percentage"))))
-			.set_legend(ChartJsLegend().set_display(true))
-			.set_title(ChartJsTitle().set_display(true).set_text("Task Analysis"));
-
-	return JsonDocument().stringify(chart.to_object());
+  var::Vector<sos::TaskManager::Info> result;
+  result.reserve(m_slot_list.count());
+  for (const auto &slot : m_slot_list) {
+    result.push_back(slot.info());
+  }
+  return result;
 }
 
-#endif
+void Task::adapt_update_period(float busy) {
+  u32 period = update_period().milliseconds();
+
+  // sample faster as soon as the load moves by more than 5% and slow down
+  // after the load has been steady for 5 samples
+  const float change = busy > m_busy ? busy - m_busy : m_busy - busy;
+  if (change > 0.05f) {
+    period /= 2;
+    m_stable_count = 0;
+  } else if (++m_stable_count >= 5) {
+    period = period * 3 / 2 + 1;
+    m_stable_count = 0;
+  }
+  m_busy = busy;
+
+  if (period < m_sampling.minimum_period()) {
+    period = m_sampling.minimum_period();
+  }
+  if (period > m_sampling.maximum_period()) {
+    period = m_sampling.maximum_period();
+  }
+  set_update_period(period * 1_milliseconds);
+}
 
 bool Task::finalize() {
 
@@ -175,27 +178,23 @@ bool Task::finalize() {
   SlPrinter::Output printer_output_guard(printer());
 
   SL_PRINTER_TRACE(
-    String().format("history has %d items", m_task_history.count()));
+    String().format("history has %d samples", m_task_series.count()));
 
-  TaskSnapshotList snapshot_list(m_task_history);
-  SL_PRINTER_TRACE("Get unique task list");
+  if (m_task_series.series_list().count()) {
 
-  if (snapshot_list.unique_task_list().count()) {
-
-    SL_PRINTER_TRACE("Get total CPU time");
+    const u64 total_cpu_time = m_task_series.get_total_cpu_time();
 
     {
       SL_PRINTER_TRACE("timing object");
       json::JsonObject timing_object;
       timing_object.insert(
         "cpuCycles",
-        JsonString(
-          String().format("%ld cycles", snapshot_list.total_cpu_time())));
+        JsonString(String().format("%ld cycles", total_cpu_time)));
       timing_object.insert(
         "totalTime",
         JsonString(String().format("%ld us", m_timer.microseconds())));
 
-      float cpuFrequency = 1.0f * snapshot_list.total_cpu_time()
+      float cpuFrequency = 1.0f * total_cpu_time
                            / (1.0f * m_timer.microseconds() / 1000000.0f);
       timing_object.insert(
         "cpuFrequency",
@@ -206,6 +205,40 @@ bool Task::finalize() {
       printer().object("timing", timing_object);
     }
 
+    {
+      const u64 duration
+        = m_task_series.get_timestamp(m_task_series.count() - 1)
+          - m_task_series.get_timestamp(0);
+      const float sample_rate
+        = duration ? (m_task_series.count() - 1) * 1000000.0f / duration : 0.0f;
+
+      json::JsonObject sampling_object;
+      sampling_object.insert(
+        "mode",
+        JsonString(m_sampling.is_delta() ? "delta" : "full"));
+      sampling_object.insert_bool("adaptive", m_sampling.is_adaptive());
+      sampling_object.insert("samples", JsonInteger(m_sample_count));
+      sampling_object.insert(
+        "effectiveRate",
+        JsonString(String().format("%0.2f Hz", static_cast<double>(sample_rate))));
+      sampling_object.insert("linkRequests", JsonInteger(m_request_count));
+      sampling_object.insert(
+        "requestsPerSample",
+        JsonString(String().format(
+          "%0.2f",
+          m_sample_count ? m_request_count * 1.0 / m_sample_count : 0.0)));
+      sampling_object.insert(
+        "linkTime",
+        JsonString(String().format("%lld us", m_request_microseconds)));
+      sampling_object.insert(
+        "linkTimePerSample",
+        JsonString(String().format(
+          "%lld us",
+          m_sample_count ? m_request_microseconds / m_sample_count : 0)));
+
+      printer().object("sampling", sampling_object);
+    }
+
     {
       // summary table
 
@@ -222,44 +255,52 @@ bool Task::finalize() {
          "maximumHeap",
          "maximumMemoryUsage"}));
 
-      for (const sos::TaskManager::Info &task :
-           snapshot_list.unique_task_list()) {
-        TaskSnapshotSummary summary = snapshot_list.get_task_snapshot_summary(
-          TaskSnapshotList::GetSnapshotSummaryOptions().set_task_info(task));
-
+      for (const auto &series : m_task_series.series_list()) {
+        const u64 cpu_time = series.get_cpu_time();
         printer().append_table_row(StringViewList(
           {String().format(
              "%s-%d.%d",
-             NameString(summary.task_info().name()).cstring(),
-             summary.task_info().id(),
-             summary.task_info().pid()),
-           summary.task_info().name(),
-           String().format(F32U, summary.task_info().id()),
-           String().format(F32U, summary.task_info().pid()),
-           String().format("%lld", summary.cpu_time()),
+             series.name().cstring(),
+             series.id(),
+             series.pid()),
+           series.name(),
+           String().format(F32U, series.id()),
+           String().format(F32U, series.pid()),
+           String().format("%lld", cpu_time),
            String().format(
              "%0.6f",
-             static_cast<double>(
-               summary.get_cpu_utilization(snapshot_list.total_cpu_time()))),
-           String().format("%ld", summary.maximum_stack_size()),
-           summary.task_info().is_thread()
+             total_cpu_time ? cpu_time * 100.0 / total_cpu_time : 0.0),
+           String().format("%ld", series.get_maximum_stack_size()),
+           series.is_thread()
              ? String("NA")
-             : String().format("%ld", summary.maximum_heap_size()),
+             : String().format("%ld", series.get_maximum_heap_size()),
            String().format(
              "%0.2f",
-             static_cast<double>(summary.get_memory_utilization()))}));
+             static_cast<double>(series.get_memory_utilization()))}));
       }
       printer().finish_table(printer::Printer::Level::info);
     }
+  }
 
+  if (m_export_list.count()) {
+    SlPrinter::Object export_object(printer().output(), "export");
+    for (const auto &item : m_export_list) {
+      export_file(m_task_series, item.path(), item.format());
+      if (is_error()) {
+        APP_RETURN_ASSIGN_ERROR("failed to export to " | item.path());
+      }
+      printer().key(item.path(), item.format());
+    }
+    m_export_list = var::Vector<Export>();
   }
+
   SL_PRINTER_TRACE("finalize task manager");
   return is_success();
 }
 
 var::StringViewList Task::get_command_list() const {
 
-  StringViewList list = {"list", "signal", "analyze"};
+  StringViewList list = {"list", "signal", "analyze", "export"};
   API_ASSERT(list.count() == command_total);
 
   return list;
@@ -275,6 +316,8 @@ bool Task::execute_command_at(u32 list_offset, const Command &command) {
     return signal(command);
   case command_analyze:
     return analyze(command);
+  case command_export:
+    return execute_export(command);
   }
 
   return false;
@@ -590,7 +633,31 @@ bool Task::analyze(const Command &command) {
         period_p,
         int,
         100,
-        "period in milliseconds to sample task activity."));
+        "period in milliseconds to sample task activity (the starting period "
+        "if `adaptive` is `true`).")
+      + GROUP_ARG_OPT(
+        adaptive,
+        bool,
+        false,
+        "sample faster when CPU activity changes and slower when it is "
+        "steady.")
+      + GROUP_ARG_OPT(
+        minperiod,
+        int,
+        10,
+        "shortest period in milliseconds when `adaptive` is `true`.")
+      + GROUP_ARG_OPT(
+        maxperiod,
+        int,
+        1000,
+        "longest period in milliseconds when `adaptive` is `true`.")
+      + GROUP_ARG_OPT(
+        delta,
+        bool,
+        false,
+        "only read tasks that changed since they were last read (tasks that "
+        "stay unchanged are read less often and all tasks are read every 16 "
+        "samples). Reduces the link traffic while sampling."));
 
   if (!command.is_valid(reference, printer())) {
 
@@ -600,6 +667,10 @@ bool Task::analyze(const Command &command) {
   StringView name = command.get_argument_value("name");
   StringView duration = command.get_argument_value("duration");
   StringView period = command.get_argument_value("period");
+  const StringView adaptive = command.get_argument_value("adaptive");
+  const StringView minperiod = command.get_argument_value("minperiod");
+  const StringView maxperiod = command.get_argument_value("maxperiod");
+  const StringView delta = command.get_argument_value("delta");
   StringView is_save = command.get_argument_value("save");
   StringView is_details = command.get_argument_value("details");
 
@@ -620,7 +691,27 @@ bool Task::analyze(const Command &command) {
   }
   SlPrinter::Output printer_output_guard(printer());
 
+  m_sampling = Sampling()
+                 .set_adaptive(adaptive == "true")
+                 .set_delta(delta == "true")
+                 .set_minimum_period(
+                   minperiod.is_empty() ? 10 : minperiod.to_integer())
+                 .set_maximum_period(
+                   maxperiod.is_empty() ? 1000 : maxperiod.to_integer());
+
+  if (m_sampling.minimum_period() == 0
+      || m_sampling.minimum_period() > m_sampling.maximum_period()) {
+    APP_RETURN_ASSIGN_ERROR("`minperiod` must be between 1 and `maxperiod`");
+  }
+
   m_filter_list = FilterList(name);
+  m_task_series.clear();
+  m_slot_list = var::Vector<Slot>();
+  m_sample_count = 0;
+  m_stable_count = 0;
+  m_busy = 0.0f;
+  m_request_count = 0;
+  m_request_microseconds = 0;
 
   printer().info("task analysis enabled");
   printer().debug("preparing for task analysis");
@@ -630,3 +721,113 @@ bool Task::analyze(const Command &command) {
 
   return is_success();
 }
+
+bool Task::execute_export(const Command &command) {
+
+  printer().open_command("task.export");
+  add_session_report_tag("export");
+
+  Command reference(
+    Command::Group(get_name()),
+    GROUP_ARG_DESC(
+      export,
+      "exports the samples collected by `task.analyze` when the analysis "
+      "finishes or converts a previously exported binary file.")
+      + GROUP_ARG_REQ(
+        path_dest,
+        string,
+        <host path>,
+        "host path of the file to create.")
+      + GROUP_ARG_OPT(
+        format,
+        string,
+        <suffix of path>,
+        "`csv`, `binary` (compact columns that can be converted later with "
+        "`source`), or `html` (self-contained report with charts).")
+      + GROUP_ARG_OPT(
+        source,
+        string,
+        <none>,
+        "binary file from a previous export to convert immediately rather "
+        "than exporting the current analysis."));
+
+  if (!command.is_valid(reference, printer())) {
+    return printer().close_fail();
+  }
+
+  const auto path = command.get_argument_value("path");
+  const auto format
+    = get_export_format(command.get_argument_value("format"), path);
+  const auto source = command.get_argument_value("source");
+
+  command.print_options(printer());
+
+  SlPrinter::Output printer_output_guard(printer());
+
+  if (format.is_empty()) {
+    APP_RETURN_ASSIGN_ERROR("`format` must be `csv`, `binary`, or `html`");
+  }
+
+  if (source.is_empty()) {
+    if (is_initialized() == false) {
+      APP_RETURN_ASSIGN_ERROR(
+        "use `task.analyze` before `task.export` or specify `source`");
+    }
+
+    // the file is written when the analysis finishes
+    m_export_list.push_back(Export().set_path(path).set_format(format));
+    printer().key("pending", path);
+    return is_success();
+  }
+
+  if (FileSystem().exists(source) == false) {
+    APP_RETURN_ASSIGN_ERROR("could not find a file at " | source);
+  }
+
+  const auto series = TaskSeries::load_binary(File(source));
+  if (is_error()) {
+    APP_RETURN_ASSIGN_ERROR("failed to load task samples from " | source);
+  }
+
+  export_file(series, path, format);
+  if (is_error()) {
+    APP_RETURN_ASSIGN_ERROR("failed to export to " | path);
+  }
+
+  printer()
+    .key("samples", NumberString(series.count()))
+    .key("tasks", NumberString(series.series_list().count()))
+    .key(path, format);
+
+  return is_success();
+}
+
+var::StringView Task::get_export_format(
+  const var::StringView format,
+  const var::StringView path) {
+  const auto value = format.is_empty() ? fs::Path::suffix(path) : format;
+  if (value == "csv") {
+    return "csv";
+  }
+  if (value == "binary" || value == "bin") {
+    return "binary";
+  }
+  if (value == "html" || value == "htm") {
+    return "html";
+  }
+  return var::StringView();
+}
+
+void Task::export_file(
+  const TaskSeries &series,
+  const var::StringView path,
+  const var::StringView format) {
+  const File file(File::IsOverwrite::yes, path);
+  if (format == "csv") {
+    series.save_csv(file);
+  } else if (format == "binary") {
+    series.save_binary(file);
+  } else {
+    series.save_html(file, "Task Analysis " | fs::Path::name(path));
+  }
+}
@@ -8,6 +8,7 @@
 #include <sos.hpp>
 #include <var.hpp>
 
+#include "utilities/TaskSeries.hpp"
 #include "utilities/Updater.hpp"
 
 class TaskSnapshot {
@@ -34,201 +35,12 @@ public:
     return m_invalid_info;
   }
 
-  u64 get_minimum_cpu_time() const {
-    u64 result = 0;
-    for (const auto &info : task_info_list()) {
-      if (result == 0 || info.timer() < result) {
-        result = info.timer();
-      }
-    }
-    return result;
-  }
-
-  u64 get_maximum_cpu_time() const {
-    u64 result = 0;
-    for (const auto &info : task_info_list()) {
-      if (result == 0 || info.timer() > result) {
-        result = info.timer();
-      }
-    }
-    return result;
-  }
-
-  static u64
-  get_total_cpu_time(const TaskSnapshot &first, const TaskSnapshot &last) {
-    u64 result = 0;
-    for (const sos::TaskManager::Info &info : first.task_info_list()) {
-      u32 offset = last.task_info_list().find_offset(info);
-      if (offset < last.task_info_list().count()) {
-        if (last.task_info_list().at(offset).timer() > info.timer()) {
-          result += (last.task_info_list().at(offset).timer() - info.timer());
-        }
-      }
-    }
-    return result;
-  }
-
 private:
   chrono::ClockTime m_timestamp;
   API_AC(TaskSnapshot, var::Vector<sos::TaskManager::Info>, task_info_list);
   static sos::TaskManager::Info m_invalid_info;
 };
 
-class TaskSnapshotSummary {
-public:
-  TaskSnapshotSummary() : m_task_info(sos::TaskManager::Info::invalid()) {}
-
-  TaskSnapshotSummary(
-    const sos::TaskManager::Info &info,
-    const chrono::ClockTime &timestamp)
-    : m_task_info(info), m_timestamp(timestamp) {
-    m_maximum_stack_size = info.stack_size();
-    m_maximum_heap_size = info.heap_size();
-    set_last_info(sos::TaskManager::Info::invalid());
-  }
-
-  bool is_valid() const { return task_info().is_valid(); }
-
-  TaskSnapshotSummary &operator<<(const sos::TaskManager::Info &info);
-
-  bool operator==(const TaskSnapshotSummary &a) const {
-    return (a.task_info().id() == task_info().id())
-           && (a.task_info().pid() == task_info().pid());
-  }
-
-  float get_memory_utilization() const {
-    float result = 0.0f;
-    if (task_info().is_thread()) {
-      result = (maximum_stack_size() * 100.0f) / task_info().memory_size();
-    } else {
-      result = ((maximum_heap_size() + maximum_stack_size()) * 100.0f)
-               / task_info().memory_size();
-    }
-    return result;
-  }
-
-  float get_cpu_utilization(u64 total) const {
-    return cpu_time() * 100.0f / total;
-  }
-
-private:
-  API_AC(TaskSnapshotSummary, sos::TaskManager::Info, task_info);
-  API_AC(TaskSnapshotSummary, sos::TaskManager::Info, last_info);
-  API_AC(TaskSnapshotSummary, chrono::ClockTime, timestamp);
-  API_AF(TaskSnapshotSummary, u64, cpu_time, 0);
-  API_AF(TaskSnapshotSummary, u64, total_cpu_time, 0);
-  API_AF(TaskSnapshotSummary, u32, maximum_heap_size, 0);
-  API_AF(TaskSnapshotSummary, u32, maximum_stack_size, 0);
-};
-
-class TaskSnapshotList : public AppAccess {
-public:
-  TaskSnapshotList(const var::Deque<TaskSnapshot> &history) {
-    list().reserve(history.count());
-    for (const auto &item : history) {
-      list().push_back(item);
-    }
-
-    for (const TaskSnapshot &snapshot : list()) {
-      for (const sos::TaskManager::Info &task_info : snapshot.task_info_list()) {
-        u32 offset = m_unique_task_list.find_offset(task_info);
-        if (offset == m_unique_task_list.count()) {
-          m_unique_task_list.push_back(task_info);
-        }
-      }
-    }
-
-    u64 sum_cpu_time = 0;
-    for (const sos::TaskManager::Info &task : unique_task_list()) {
-      TaskSnapshotSummary summary = get_task_snapshot_summary(
-        TaskSnapshotList::GetSnapshotSummaryOptions().set_task_info(task));
-      if (summary.is_valid()) {
-        sum_cpu_time += summary.cpu_time();
-      }
-    }
-    m_total_cpu_time = sum_cpu_time;
-  }
-
-  size_t count() const { return list().count(); }
-
-  class GetSnapshotSummaryOptions {
-    API_AF(GetSnapshotSummaryOptions, u32, offset, 0);
-    API_AF(GetSnapshotSummaryOptions, u32, count, 0);
-    API_AC(GetSnapshotSummaryOptions, sos::TaskManager::Info, task_info);
-  };
-
-  TaskSnapshotSummary
-  get_task_snapshot_summary(const GetSnapshotSummaryOptions &options) const {
-    API_ASSERT(options.count() != 1);
-    u32 count = options.count();
-    if (count == 0) {
-      count = list().count();
-    }
-    if (options.offset() + count > list().count()) {
-      SL_PRINTER_TRACE("offset invalid for " + options.task_info().name());
-      return TaskSnapshotSummary();
-    }
-
-    u32 find_first = options.offset();
-    const TaskSnapshot *first_pointer;
-    {
-      bool is_valid = false;
-      do {
-        first_pointer = &list().at(find_first);
-        is_valid = first_pointer->task_info(options.task_info()).is_valid();
-        if (!is_valid) {
-          find_first++;
-        }
-      } while (!is_valid && find_first < options.offset() + count);
-
-      if (find_first == options.offset() + count) {
-        SL_PRINTER_TRACE("Didn't find first for " + options.task_info().name());
-        return TaskSnapshotSummary();
-      }
-    }
-
-    u32 find_last = options.offset() + count - 1;
-    const TaskSnapshot *last_pointer;
-    {
-      bool is_valid = false;
-      do {
-        last_pointer = &list().at(find_last);
-        is_valid = last_pointer->task_info(options.task_info()).is_valid();
-        if (!is_valid) {
-          find_last--;
-        }
-      } while (!is_valid && find_last > options.offset());
-
-      if (find_last == options.offset() + count) {
-        return TaskSnapshotSummary();
-      }
-    }
-
-    const TaskSnapshot &first(*first_pointer);
-    const TaskSnapshot &last(*last_pointer);
-
-    // get total CPU time between first and last
-
-    TaskSnapshotSummary result = TaskSnapshotSummary(
-      first.task_info(options.task_info()),
-      first.timestamp());
-
-    result.set_total_cpu_time(TaskSnapshot::get_total_cpu_time(first, last));
-
-    for (u32 i = 0; i < count; i++) {
-      // this will set the stack and heap to the max over the window
-      result << list().at(options.offset() + i).task_info(options.task_info());
-    }
-
-    return result;
-  }
-
-private:
-  API_AC(TaskSnapshotList, var::Vector<TaskSnapshot>, list);
-  API_RAF(TaskSnapshotList, u64, total_cpu_time, 0);
-  API_RAC(TaskSnapshotList, var::Vector<sos::TaskManager::Info>, unique_task_list);
-};
-
 class Task : public Updater {
 public:
   Task();
@@ -257,6 +69,7 @@ public:
   }
 
   bool analyze(const Command &command);
+  bool execute_export(const Command &command);
 
 private:
   class FilterList {
@@ -319,9 +132,43 @@ private:
     }
   };
 
-  u32 m_max_queue_count;
+  class Export {
+    API_AC(Export, var::PathString, path);
+    API_AC(Export, var::KeyString, format);
+  };
+
+  class Sampling {
+    // period follows changes in CPU activity
+    API_AB(Sampling, adaptive, false);
+    // only tasks that changed are read again on the next sample
+    API_AB(Sampling, delta, false);
+    API_AF(Sampling, u32, minimum_period, 10);
+    API_AF(Sampling, u32, maximum_period, 1000);
+  };
+
+  // last information read from a task slot (the offset is the task id)
+  class Slot {
+    API_AC(Slot, sos::TaskManager::Info, info);
+    API_AF(Slot, u32, unchanged_count, 0);
+    API_AF(Slot, u32, next_sample, 0);
+  };
+
+  // all slots are read on this sample interval in delta mode so new tasks are
+  // found
+  static constexpr u32 discovery_interval() { return 16; }
+
   sos::TaskManager m_task_manager;
-  var::Deque<TaskSnapshot> m_task_history;
+  TaskSeries m_task_series;
+  // written when the capture finishes
+  var::Vector<Export> m_export_list;
+  Sampling m_sampling;
+  var::Vector<Slot> m_slot_list;
+  u32 m_sample_count = 0;
+  u32 m_stable_count = 0;
+  float m_busy = 0.0f;
+  // link cost of sampling
+  u32 m_request_count = 0;
+  u64 m_request_microseconds = 0;
   chrono::ClockTimer m_timer;
   chrono::ClockTime m_start_time;
   static TaskSnapshot m_latest_snapshot;
@@ -331,17 +178,27 @@ private:
     command_list,
     command_signal,
     command_analyze,
+    command_export,
     command_total
   };
 
   var::StringViewList get_command_list() const override;
   bool execute_command_at(u32 list_offset, const Command &command) override;
 
-  // TaskSummaryTable create_task_summary_table(int total_samples = 50);
-  // var::Vector<var::Datum> summarize_history(int samples_per_datum);
-
   bool list(const Command &command);
   bool signal(const Command &command);
+
+  var::Vector<sos::TaskManager::Info> read_task_info_list();
+  // `busy` is the fraction of CPU time not used by the idle task
+  void adapt_update_period(float busy);
+
+  // `csv`, `binary` or `html` from `format` or the suffix of `path`
+  static var::StringView
+  get_export_format(const var::StringView format, const var::StringView path);
+  static void export_file(
+    const TaskSeries &series,
+    const var::StringView path,
+    const var::StringView format);
 };
 
 #endif // TASK_HPP
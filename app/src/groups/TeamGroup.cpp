@@ -1,3 +1,5 @@
+#include <fs.hpp>
+#include <json.hpp>
 #include <var.hpp>
 
 #include "TeamGroup.hpp"
@@ -5,7 +7,7 @@
 TeamGroup::TeamGroup() : Group("team", "team") {}
 
 var::StringViewList TeamGroup::get_command_list() const {
-  StringViewList list = {"ping", "add", "update", "create"};
+  StringViewList list = {"ping", "add", "update", "create", "import"};
   API_ASSERT(list.count() == command_total);
 
   return list;
@@ -21,6 +23,8 @@ bool TeamGroup::execute_command_at(u32 list_offset, const Command &command) {
     return update(command);
   case command_create:
     return create(command);
+  case command_import:
+    return execute_import(command);
   }
   return false;
 }
@@ -284,3 +288,320 @@ bool TeamGroup::create(const Command &command) {
 
   return is_success();
 }
+
+bool TeamGroup::execute_import(const Command &command) {
+
+  printer().open_command("team.import");
+  GROUP_ADD_SESSION_REPORT_TAG();
+
+  Command reference(
+    Command::Group(get_name()),
+    GROUP_ARG_DESC(
+      import,
+      "adds and updates the users on a team from a CSV or JSON list. Only "
+      "users whose permissions differ from the list are written.")
+      + GROUP_ARG_REQ(
+        path,
+        string,
+        <path>,
+        "CSV file with the columns `user,create,remove,read,write,admin` (a "
+        "header row starting with `user` selects the column order) or a JSON "
+        "array of objects with the same keys (or an object keyed by user). A "
+        "missing or empty permission is `true` for `read` and `false` for the "
+        "others.")
+      + GROUP_ARG_OPT(
+        dryrun,
+        bool,
+        false,
+        "show changes to be made without making them")
+      + GROUP_ARG_REQ(
+        team_id,
+        string,
+        <team id>,
+        "team id for users to import."));
+
+  if (!command.is_valid(reference, printer())) {
+    return printer().close_fail();
+  }
+
+  StringView team_id = command.get_argument_value("team");
+  StringView path = command.get_argument_value("path");
+  StringView dryrun = command.get_argument_value("dryrun");
+
+  command.print_options(printer());
+
+  SlPrinter::Output printer_output_guard(printer());
+
+  const auto member_list = load_member_list(path);
+  if (is_error()) {
+    return printer().close_fail();
+  }
+
+  // checked once for the whole list rather than once per user
+  if (is_cloud_ready() == false) {
+    return printer().close_fail();
+  }
+
+  struct Result {
+    var::String user;
+    var::StringView action;
+    var::String changes;
+    var::String error_message;
+  };
+
+  var::Vector<Result> result_list;
+  result_list.reserve(member_list.count());
+
+  // users are written one at a time: every Team::User document goes through
+  // the one process-wide cloud_service() connection, which isn't safe to
+  // share between threads
+  for (const auto &member : member_list) {
+    if (session_settings().is_interrupted()) {
+      break;
+    }
+
+    Result result{member.user(), "unchanged", var::String(), var::String()};
+
+    SL_PRINTER_TRACE("fetch team user " + member.user());
+    Team::User user(team_id, member.user());
+    const bool is_existing = user.is_existing();
+    if (!is_existing) {
+      // not on the team yet
+      API_RESET_ERROR();
+    }
+
+    const auto compare = [&](
+                           const var::StringView name,
+                           bool current,
+                           bool target) {
+      if (!is_existing || current != target) {
+        result.changes += var::String(result.changes.is_empty() ? "" : " ")
+                          + name + "=" + (target ? "true" : "false");
+      }
+    };
+
+    compare("create", user.is_create(), member.is_create());
+    compare("remove", user.is_remove(), member.is_remove());
+    compare("read", user.is_read(), member.is_read());
+    compare("write", user.is_write(), member.is_write());
+    compare("admin", user.is_admin(), member.is_admin());
+
+    if (!is_existing) {
+      result.action = "add";
+    } else if (!result.changes.is_empty()) {
+      result.action = "update";
+    }
+
+    if (dryrun != "true" && result.action != "unchanged") {
+      // CloudAPI requires all docs have a permissions entry
+      user.set_permissions("private")
+        .set_document_id(member.user())
+        .set_user_id(member.user())
+        .set_team_id(team_id)
+        .set_create(member.is_create())
+        .set_remove(member.is_remove())
+        .set_read(member.is_read())
+        .set_write(member.is_write())
+        .set_admin(member.is_admin())
+        .save();
+
+      if (is_error()) {
+        SL_PRINTER_TRACE(
+          "failed to save user " + cloud_service().store().traffic());
+        result.error_message = api::ExecutionContext::error().message();
+        API_RESET_ERROR();
+      }
+    }
+
+    result_list.push_back(result);
+  }
+
+  u32 add_count = 0;
+  u32 update_count = 0;
+  u32 fail_count = 0;
+  printer().start_table(
+    StringViewList({"user", "action", "changes", "error"}));
+  for (const auto &result : result_list) {
+    if (!result.error_message.is_empty()) {
+      fail_count++;
+    } else if (result.action == "add") {
+      add_count++;
+    } else if (result.action == "update") {
+      update_count++;
+    }
+    printer().append_table_row(StringViewList(
+      {result.user, result.action, result.changes, result.error_message}));
+  }
+  printer().finish_table(printer::Printer::Level::info);
+
+  {
+    Printer::Object po(printer().active_printer(), "summary");
+    printer()
+      .key_bool("dryRun", dryrun == "true")
+      .key("added", NumberString(add_count))
+      .key("updated", NumberString(update_count))
+      .key(
+        "unchanged",
+        NumberString(result_list.count() - add_count - update_count - fail_count))
+      .key("failed", NumberString(fail_count));
+  }
+
+  if (result_list.count() < member_list.count()) {
+    APP_RETURN_ASSIGN_ERROR("import was interrupted");
+  }
+
+  if (fail_count) {
+    APP_RETURN_ASSIGN_ERROR(
+      NumberString(fail_count) | " of " | NumberString(result_list.count())
+      | " users failed to import");
+  }
+
+  return is_success();
+}
+
+TeamGroup::MemberList TeamGroup::load_member_list(const var::StringView path) {
+  if (!FileSystem().exists(path)) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      MemberList(),
+      "`" | path | "` does not exist");
+  }
+
+  MemberList result;
+
+  const auto push_member = [&](const Member &member) {
+    if (member.user().is_empty()) {
+      return false;
+    }
+    for (const auto &item : result) {
+      if (item.user() == member.user()) {
+        return false;
+      }
+    }
+    result.push_back(member);
+    return true;
+  };
+
+  if (Path::suffix(path) == "json") {
+    const auto value = JsonDocument().load(File(path));
+    if (is_error()) {
+      APP_RETURN_VALUE_ASSIGN_ERROR(
+        MemberList(),
+        "failed to parse `" | path | "`");
+    }
+
+    const auto to_member
+      = [](const var::StringView user, const JsonObject &object) {
+          // missing or empty values keep the Member defaults
+          const auto get_value
+            = [&](const var::StringView key, bool default_value) {
+                const auto entry = object.at(key);
+                if (!entry.is_valid() || entry.is_null()) {
+                  return default_value;
+                }
+                if (entry.is_string() && entry.to_string_view().is_empty()) {
+                  return default_value;
+                }
+                return entry.to_bool() || is_true(entry.to_string_view());
+              };
+          const Member defaults;
+          return Member()
+            .set_user(user)
+            .set_create(get_value("create", defaults.is_create()))
+            .set_remove(get_value("remove", defaults.is_remove()))
+            .set_read(get_value("read", defaults.is_read()))
+            .set_write(get_value("write", defaults.is_write()))
+            .set_admin(get_value("admin", defaults.is_admin()));
+        };
+
+    if (value.is_array()) {
+      const auto array = value.to_array();
+      for (u32 i = 0; i < array.count(); i++) {
+        const auto object = array.at(i).to_object();
+        if (!push_member(to_member(object.at("user").to_string_view(), object))) {
+          APP_RETURN_VALUE_ASSIGN_ERROR(
+            MemberList(),
+            "entry " | NumberString(i) | " has a missing or duplicate `user`");
+        }
+      }
+    } else {
+      const auto object = value.to_object();
+      for (const auto &key : object.get_key_list()) {
+        if (!push_member(to_member(key, object.at(key).to_object()))) {
+          APP_RETURN_VALUE_ASSIGN_ERROR(
+            MemberList(),
+            "entry `" | key | "` has an empty or duplicate user");
+        }
+      }
+    }
+    return result;
+  }
+
+  // CSV: the default column order matches the `team.add` options
+  var::Vector<var::String> column_list
+    = {"user", "create", "remove", "read", "write", "admin"};
+
+  File input_file(path);
+  GeneralString line;
+  u32 line_number = 0;
+  bool is_first_row = true;
+  while ((line = input_file.get_line()).is_empty() == false) {
+    line_number++;
+    String condensed_line = String(line.string_view());
+    condensed_line
+      .replace(String::Replace().set_old_string(" ").set_new_string(""))
+      .replace(String::Replace().set_old_string("\r").set_new_string(""))
+      .replace(String::Replace().set_old_string("\n").set_new_string(""))
+      .replace(String::Replace().set_old_string("\t").set_new_string(""));
+
+    if (condensed_line.is_empty() || condensed_line.string_view().at(0) == '#') {
+      continue;
+    }
+
+    // the header is the first row that isn't blank or a comment
+    const auto token_list = condensed_line.string_view().split(",");
+    const bool is_header = is_first_row && token_list.at(0) == "user";
+    is_first_row = false;
+    if (is_header) {
+      column_list.clear();
+      for (const auto &token : token_list) {
+        column_list.push_back(String(token));
+      }
+      continue;
+    }
+
+    Member member;
+    for (u32 i = 0; i < token_list.count() && i < column_list.count(); i++) {
+      const auto &column = column_list.at(i);
+      const auto token = token_list.at(i);
+      if (token.is_empty()) {
+        // same as a missing JSON key: keep the Member default
+        continue;
+      }
+      if (column == "user") {
+        member.set_user(token);
+      } else if (column == "create") {
+        member.set_create(is_true(token));
+      } else if (column == "remove") {
+        member.set_remove(is_true(token));
+      } else if (column == "read") {
+        member.set_read(is_true(token));
+      } else if (column == "write") {
+        member.set_write(is_true(token));
+      } else if (column == "admin") {
+        member.set_admin(is_true(token));
+      }
+    }
+
+    if (!push_member(member)) {
+      APP_RETURN_VALUE_ASSIGN_ERROR(
+        MemberList(),
+        "line " | NumberString(line_number) | " has a missing or duplicate user");
+    }
+  }
+
+  return result;
+}
+
+bool TeamGroup::is_true(const var::StringView value) {
+  return value == "true" || value == "1" || value == "yes" || value == "x";
+}
@@ -13,6 +13,7 @@ private:
     command_add,
     command_update,
     command_create,
+    command_import,
     command_total
   };
 
@@ -23,6 +24,25 @@ private:
   bool add(const Command &command);
   bool update(const Command &command);
   bool create(const Command &command);
+  bool execute_import(const Command &command);
+
+  // one row of a `team.import` list (a missing or empty value in the CSV or
+  // JSON keeps the default below)
+  class Member {
+    API_AC(Member, var::String, user);
+    API_AB(Member, create, false);
+    API_AB(Member, remove, false);
+    API_AB(Member, read, true);
+    API_AB(Member, write, false);
+    API_AB(Member, admin, false);
+  };
+
+  using MemberList = var::Vector<Member>;
+
+  // CSV (`user,create,remove,read,write,admin` with an optional header row) or
+  // JSON (an array of objects or an object keyed by user id)
+  static MemberList load_member_list(const var::StringView path);
+  static bool is_true(const var::StringView value);
 };
 
 #endif // TEAMGROUP_HPP
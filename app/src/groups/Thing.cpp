@@ -1,12 +1,13 @@
 #include <var.hpp>
 
 #include "Thing.hpp"
+#include "utilities/Inventory.hpp"
 
 ThingGroup::ThingGroup() : Group("thing", "thing") {}
 
 var::StringViewList ThingGroup::get_command_list() const {
 
-  StringViewList list = {"ping"};
+  StringViewList list = {"ping", "sync"};
   API_ASSERT(list.count() == command_total);
 
   return list;
@@ -17,6 +18,8 @@ bool ThingGroup::execute_command_at(u32 list_offset, const Command &command) {
   switch (list_offset) {
   case command_ping:
     return ping(command);
+  case command_sync:
+    return sync(command);
   }
   return false;
 }
@@ -63,3 +66,92 @@ bool ThingGroup::ping(const Command &command) {
 
   return is_success();
 }
+
+bool ThingGroup::sync(const Command &command) {
+
+  printer().open_command(GROUP_COMMAND_NAME);
+  GROUP_ADD_SESSION_REPORT_TAG();
+
+  Command reference(
+    Command::Group(get_name()),
+    GROUP_ARG_DESC(
+      sync,
+      "keeps a local snapshot of thing documents up to date and queries it. "
+      "Every thing already in the snapshot is pulled again once it is "
+      "older than `maxage`. The cloud has no collection listing or "
+      "changed-since query, so only ids given with `identifier` (or already "
+      "in the snapshot) are synced, and documents are pulled one at a time.")
+      + GROUP_ARG_OPT(
+        identifier_id,
+        string,
+        <none>,
+        "ids to add to the snapshot (separate multiple ids with `?`).")
+      + GROUP_ARG_OPT(
+        maxage,
+        integer,
+        0,
+        "Seconds before a document in the snapshot is pulled again (`0` "
+        "pulls every document on each sync).")
+      + GROUP_ARG_OPT(
+        refresh,
+        bool,
+        false,
+        "Pull every document regardless of `maxage`.")
+      + GROUP_ARG_OPT(
+        local,
+        bool,
+        false,
+        "Answer from the snapshot without contacting the cloud.")
+      + GROUP_ARG_OPT(
+        remove,
+        string,
+        <none>,
+        "ids to drop from the snapshot (separate multiple ids with `?`).")
+      + GROUP_ARG_OPT(
+        query,
+        string,
+        <none>,
+        "List the ids where `<key>=<value>` (use `.` to select nested keys)."));
+
+  if (!command.is_valid(reference, printer())) {
+    return printer().close_fail();
+  }
+
+  StringView identifier = command.get_argument_value("identifier");
+  StringView maxage = command.get_argument_value("maxage");
+  StringView refresh = command.get_argument_value("refresh");
+  StringView local = command.get_argument_value("local");
+  StringView remove = command.get_argument_value("remove");
+  StringView query = command.get_argument_value("query");
+
+  command.print_options(printer());
+
+  if (local != "true" && is_cloud_ready() == false) {
+    return printer().close_fail();
+  }
+
+  SlPrinter::Output printer_output_guard(printer());
+
+  Inventory("thing").execute(
+    Inventory::Options()
+      .set_identifier(identifier)
+      .set_remove(remove)
+      .set_query(query)
+      .set_maximum_age(maxage.to_integer())
+      .set_refresh(refresh == "true")
+      .set_local(local == "true"),
+    [this](const StringView id) {
+      Thing document(id);
+      if (!document.is_existing()) {
+        SL_PRINTER_TRACE(
+          "document traffic " + cloud_service().store().traffic());
+        API_RETURN_VALUE_ASSIGN_ERROR(
+          JsonObject(),
+          "thing does not exist",
+          ENOENT);
+      }
+      return document.to_object();
+    });
+
+  return is_success();
+}
@@ -12,8 +12,9 @@ private:
   bool execute_command_at(u32 list_offset, const Command &command) override;
 
   bool ping(const Command &command);
+  bool sync(const Command &command);
 
-  enum commands { command_ping, command_total };
+  enum commands { command_ping, command_sync, command_total };
 };
 
 #endif // GROUPS_THING_HPP
@@ -39,7 +39,10 @@
 #include "settings/Credentials.hpp"
 #include "settings/GlobalSettings.hpp"
 
+#include "utilities/Daemon.hpp"
+#include "utilities/DeviceCache.hpp"
 #include "utilities/LocalServer.hpp"
+#include "utilities/SelfBench.hpp"
 
 static volatile bool m_is_interrupted = false;
 
@@ -70,6 +73,18 @@ int main(int argc, char *argv[]) {
         .set_publisher("Stratify Labs, Inc")
         .set_version(VERSION));
 
+#if __sl_bench
+  return SelfBench(cli).execute();
+#endif
+
+  {
+    // a running daemon already holds the connection and settings
+    Daemon::Client daemon_client(cli);
+    if (daemon_client.is_connected()) {
+      return daemon_client.execute();
+    }
+  }
+
   int result = 0;
   Connection connection;
   Connector::set_connection(&connection);
@@ -139,7 +154,8 @@ int main(int argc, char *argv[]) {
       Group::printer().output(),
       "command line processing complete");
 
-    const bool is_listening = Group::session_settings().is_listen_mode();
+    const bool is_listening = Group::session_settings().is_listen_mode()
+                              || Group::session_settings().is_daemon_mode();
 
     LocalServer local_server;
     if (App::session_settings().is_listen_mode()) {
@@ -148,6 +164,11 @@ int main(int argc, char *argv[]) {
         .start();
     }
 
+    Daemon daemon;
+    if (App::session_settings().is_daemon_mode()) {
+      daemon.start();
+    }
+
     // message for debug tracing
     if (
       terminal.is_running() || task.is_running() || debug_trace.is_running()
@@ -169,25 +190,27 @@ int main(int argc, char *argv[]) {
         is_terminal = true;
       }
 
-      MicroTime minimum_update_period = 10000_seconds;
+      // recomputed every pass because `task.analyze:adaptive` changes the
+      // task period while the loop runs
+      const auto get_minimum_update_period = [&]() {
+        MicroTime result = 10000_seconds;
 
-      if (
-        terminal.is_initialized()
-        && (terminal.update_period() < minimum_update_period)) {
-        minimum_update_period = terminal.update_period();
-      }
+        if (
+          terminal.is_initialized() && (terminal.update_period() < result)) {
+          result = terminal.update_period();
+        }
 
-      if (
-        task.is_initialized()
-        && (task.update_period() < minimum_update_period)) {
-        minimum_update_period = task.update_period();
-      }
+        if (task.is_initialized() && (task.update_period() < result)) {
+          result = task.update_period();
+        }
 
-      if (
-        debug_trace.is_initialized()
-        && (debug_trace.update_period() < minimum_update_period)) {
-        minimum_update_period = debug_trace.update_period();
-      }
+        if (
+          debug_trace.is_initialized()
+          && (debug_trace.update_period() < result)) {
+          result = debug_trace.update_period();
+        }
+        return result;
+      };
 
 #if 1
       thread::Signal sigint(thread::Signal::Number::interrupt);
@@ -208,8 +231,15 @@ int main(int argc, char *argv[]) {
         is_busy |= terminal.update();
         is_busy |= task.update();
         is_busy |= debug_trace.update();
+        is_busy |= daemon.update();
 
-        wait(minimum_update_period);
+        // output written while idling is flushed within the flush interval
+        PrinterOutput::update();
+        const auto minimum_update_period = get_minimum_update_period();
+        wait(
+          minimum_update_period < PrinterOutput::flush_interval()
+            ? minimum_update_period
+            : PrinterOutput::flush_interval());
 
         // check to see if the connection failed -- exit if it did
 
@@ -229,6 +259,11 @@ int main(int argc, char *argv[]) {
       task.finalize();
     }
 
+    // finish any forwarded command before the connection is closed
+    daemon.stop();
+
+    DeviceCache::print_statistics();
+
     // need to save the settings before other objects are destroyed
     App::finalize();
 
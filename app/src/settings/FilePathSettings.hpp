@@ -37,6 +37,27 @@ public:
     return global_directory() / "sl_global_cloud_settings.json";
   }
 
+  // sector hashes of the last OS image installed on a device
+  static var::PathString
+  os_image_record_path(const var::StringView serial_number) {
+    return global_directory() / "os_images" / serial_number & ".json";
+  }
+
+  // local copies of key documents used by `keys.sign` and `keys.verify`
+  static var::PathString keyring_directory() {
+    return global_directory() / "keyring";
+  }
+
+  // snapshots of thing and hardware documents kept by `*.sync`
+  static var::PathString inventory_directory() {
+    return global_directory() / "inventory";
+  }
+
+  // the socket is shared by every directory so clients anywhere find it
+  static var::PathString daemon_socket_path() {
+    return global_directory() / "sl_daemon.sock";
+  }
+
   static var::StringView credentials_path() { return "sl_credentials.json"; }
 
   static var::PathString global_credentials_path() {
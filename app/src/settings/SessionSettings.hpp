@@ -22,11 +22,14 @@ class SessionSettings {
   API_ACCESS_BOOL(SessionSettings, interactive, false);
   API_ACCESS_BOOL(SessionSettings, listen_mode, false);
   API_ACCESS_FUNDAMENTAL(SessionSettings, u16, listen_port, 3000);
+  API_ACCESS_BOOL(SessionSettings, daemon_mode, false);
   API_ACCESS_COMPOUND(
     SessionSettings,
     var::PathString,
     web_path); // for the report
   API_ACCESS_BOOL(SessionSettings, offline_mode, false);
+  // base URL of a `cloud.standin` server (`--cloud` or `SL_CLOUD_URL`)
+  API_ACCESS_STRING(SessionSettings, cloud_url);
   API_ACCESS_BOOL(SessionSettings, update_checked, false);
   API_ACCESS_BOOL(SessionSettings, upgrade_available, false);
   API_ACCESS_BOOL(SessionSettings, archive_history, false);
@@ -2,9 +2,11 @@
 
 #include <var.hpp>
 
+#include "sos_crt_symbols.hpp"
+
 String sos_crt_symbols_get_signature(){ return String("0x00000380"); }
 
-const char * sos_symbols[] = {
+constexpr const char * sos_symbols[] = {
 	"global_impure_ptr",
 	"impure_ptr",
 	"_sf_fake_stdin",
@@ -660,3 +662,641 @@ u32 sos_crt_symbols_get_count(){ return 648; }
 
 String sos_crt_symbols_get_entry(u32 value){ if( value < sos_crt_symbols_get_count() ){ return String(sos_symbols[value]); } return String(); }
 
+u32 sos_crt_symbols_get_name_offset(){ return 1; }
+
+constexpr const char * sos_sorted_symbols[] = {
+	"Unwind_Complete",
+	"Unwind_DeleteException",
+	"Unwind_GetDataRelBase",
+	"Unwind_GetLanguageSpecificData",
+	"Unwind_GetRegionStart",
+	"Unwind_GetTextRelBase",
+	"Unwind_RaiseException",
+	"Unwind_Resume",
+	"Unwind_Resume_or_Rethrow",
+	"Unwind_VRS_Get",
+	"Unwind_VRS_Set",
+	"_absvdi2",
+	"_absvsi2",
+	"_addvdi3",
+	"_addvsi3",
+	"_aeabi_cdcmpeq",
+	"_aeabi_cdrcmple",
+	"_aeabi_cfcmpeq",
+	"_aeabi_cfrcmple",
+	"_aeabi_d2f",
+	"_aeabi_d2iz",
+	"_aeabi_d2lz",
+	"_aeabi_d2uiz",
+	"_aeabi_d2ulz",
+	"_aeabi_dadd",
+	"_aeabi_dcmpeq",
+	"_aeabi_dcmpge",
+	"_aeabi_dcmpgt",
+	"_aeabi_dcmple",
+	"_aeabi_dcmplt",
+	"_aeabi_dcmpun",
+	"_aeabi_ddiv",
+	"_aeabi_dmul",
+	"_aeabi_dneg",
+	"_aeabi_drsub",
+	"_aeabi_dsub",
+	"_aeabi_f2d",
+	"_aeabi_f2iz",
+	"_aeabi_f2lz",
+	"_aeabi_f2uiz",
+	"_aeabi_f2ulz",
+	"_aeabi_fadd",
+	"_aeabi_fcmpeq",
+	"_aeabi_fcmpge",
+	"_aeabi_fcmpgt",
+	"_aeabi_fcmple",
+	"_aeabi_fcmplt",
+	"_aeabi_fcmpun",
+	"_aeabi_fdiv",
+	"_aeabi_fmul",
+	"_aeabi_fneg",
+	"_aeabi_frsub",
+	"_aeabi_fsub",
+	"_aeabi_i2d",
+	"_aeabi_i2f",
+	"_aeabi_idiv",
+	"_aeabi_idivmod",
+	"_aeabi_l2d",
+	"_aeabi_l2f",
+	"_aeabi_lasr",
+	"_aeabi_ldivmod",
+	"_aeabi_llsl",
+	"_aeabi_llsr",
+	"_aeabi_ui2d",
+	"_aeabi_ui2f",
+	"_aeabi_uidiv",
+	"_aeabi_uidivmod",
+	"_aeabi_ul2d",
+	"_aeabi_ul2f",
+	"_aeabi_uldivmod",
+	"_aeabi_unwind_cpp_pr0",
+	"_aeabi_unwind_cpp_pr1",
+	"_assert_func",
+	"_bswapdi2",
+	"_bswapsi2",
+	"_clzdi2",
+	"_clzsi2",
+	"_cmpdf2",
+	"_cmpdi2",
+	"_cmpsf2",
+	"_cxa_atexit",
+	"_div0",
+	"_divdc3",
+	"_divdi3",
+	"_divsc3",
+	"_errno",
+	"_ffsdi2",
+	"_gedf2",
+	"_gesf2",
+	"_gnu_f2h_ieee",
+	"_gnu_h2f_ieee",
+	"_gnu_unwind_frame",
+	"_ledf2",
+	"_lesf2",
+	"_locale_mb_cur_max",
+	"_moddi3",
+	"_modsi3",
+	"_muldc3",
+	"_muldi3",
+	"_mulsc3",
+	"_mulvdi3",
+	"_mulvsi3",
+	"_negdi2",
+	"_negvdi2",
+	"_negvsi2",
+	"_paritydi2",
+	"_paritysi2",
+	"_popcountdi2",
+	"_popcountsi2",
+	"_powidf2",
+	"_powisf2",
+	"_sf_fake_stderr",
+	"_sf_fake_stdin",
+	"_sf_fake_stdout",
+	"_sinit",
+	"_subvdi3",
+	"_subvsi3",
+	"_ucmpdi2",
+	"_udivdi3",
+	"_umoddi3",
+	"_umodsi3",
+	"abs",
+	"absf",
+	"aise",
+	"ait",
+	"aitpid",
+	"alarm",
+	"allinfo",
+	"alloc",
+	"and",
+	"anf",
+	"anhf",
+	"ask_setstackguard",
+	"atherr",
+	"aunch",
+	"blen",
+	"bort",
+	"brlen",
+	"brtf",
+	"brtowc",
+	"bs",
+	"bsinit",
+	"bsrtowcs",
+	"bstowcs",
+	"btowc",
+	"calblnf",
+	"calbnf",
+	"canf",
+	"ccept",
+	"ccess",
+	"ched_get_priority_max",
+	"ched_get_priority_min",
+	"ched_getparam",
+	"ched_getscheduler",
+	"ched_rr_get_interval",
+	"ched_setparam",
+	"ched_setscheduler",
+	"ched_yield",
+	"close",
+	"cntl",
+	"cosf",
+	"coshf",
+	"crtomb",
+	"cscasecmp",
+	"cscat",
+	"cschr",
+	"cscmp",
+	"cscoll",
+	"cscpy",
+	"cscspn",
+	"csftime",
+	"cslen",
+	"csncasecmp",
+	"csncat",
+	"csncmp",
+	"csncpy",
+	"cspbrk",
+	"csrchr",
+	"csrtombs",
+	"csspn",
+	"csstr",
+	"cstod",
+	"cstof",
+	"cstok",
+	"cstol",
+	"cstold",
+	"cstoll",
+	"cstombs",
+	"cstoul",
+	"cstoull",
+	"csxfrm",
+	"ctob",
+	"ctomb",
+	"ctrans",
+	"ctype",
+	"ctype_",
+	"dexpf",
+	"dimf",
+	"div",
+	"ead",
+	"eaddir",
+	"eaddir_r",
+	"ealloc",
+	"earbyintf",
+	"ecv",
+	"ecvfrom",
+	"eekdir",
+	"eilf",
+	"elect",
+	"elldir",
+	"em_close",
+	"em_destroy",
+	"em_getvalue",
+	"em_init",
+	"em_open",
+	"em_post",
+	"em_timedwait",
+	"em_trywait",
+	"em_unlink",
+	"em_wait",
+	"emainderf",
+	"emchr",
+	"emcmp",
+	"emcpy",
+	"emmove",
+	"emove",
+	"emquof",
+	"emset",
+	"ename",
+	"end",
+	"endmsg",
+	"endto",
+	"eof",
+	"ernel_request",
+	"ernel_request_api",
+	"error",
+	"etaddrinfo",
+	"etbuf",
+	"etc",
+	"etchar",
+	"etenv",
+	"eteuid",
+	"ethostbyname",
+	"ethostbyname_r",
+	"etlocale",
+	"etpeername",
+	"etpid",
+	"ets",
+	"etsockname",
+	"etsockopt",
+	"ettimeofday",
+	"etuid",
+	"etvbuf",
+	"etwc",
+	"etwchar",
+	"evfs_signal_callback",
+	"ewind",
+	"ewinddir",
+	"exit",
+	"extafterf",
+	"flush",
+	"fprintf",
+	"free_r",
+	"fscanf",
+	"fwprintf",
+	"fwscanf",
+	"gammaf",
+	"getc",
+	"getpos",
+	"gets",
+	"getwc",
+	"getws",
+	"global_impure_ptr",
+	"hmod",
+	"hown",
+	"hutdown",
+	"ibernate",
+	"ifftime",
+	"igaction",
+	"ignal",
+	"igpending",
+	"igprocmask",
+	"igqueue",
+	"igsuspend",
+	"igtimedwait",
+	"igwait",
+	"igwaitinfo",
+	"ileno",
+	"ill",
+	"ime",
+	"imer_create",
+	"imer_delete",
+	"imer_getoverrun",
+	"imer_gettime",
+	"imer_settime",
+	"imes",
+	"impure_ptr",
+	"ind",
+	"inf",
+	"inhf",
+	"initef",
+	"ink",
+	"intf",
+	"io_cancel",
+	"io_error",
+	"io_fsync",
+	"io_listio",
+	"io_read",
+	"io_return",
+	"io_suspend",
+	"io_write",
+	"isten",
+	"iv",
+	"kdir",
+	"kfs",
+	"ktime",
+	"larm",
+	"ldiv",
+	"learerr",
+	"leep",
+	"lock",
+	"lock_getcpuclockid",
+	"lock_getres",
+	"lock_gettime",
+	"lock_settime",
+	"logbf",
+	"loorf",
+	"lose",
+	"losedir",
+	"lrintf",
+	"lroundf",
+	"maf",
+	"malloc_r",
+	"maxf",
+	"mdir",
+	"memchr",
+	"memcmp",
+	"memcpy",
+	"memmove",
+	"memset",
+	"minf",
+	"modf",
+	"mtime",
+	"mtime_r",
+	"net_addr",
+	"net_ntoa",
+	"net_ntop",
+	"net_pton",
+	"ngetc",
+	"ngetwc",
+	"nlink",
+	"nmount",
+	"nprintf",
+	"nstall",
+	"ocaleconv",
+	"ocaltime",
+	"ocaltime_r",
+	"ocket",
+	"octl",
+	"odff",
+	"og10f",
+	"og1pf",
+	"og2f",
+	"ogbf",
+	"ogf",
+	"olower",
+	"onnect",
+	"open",
+	"opysignf",
+	"os_trace_event",
+	"os_trace_stack",
+	"osf",
+	"oshf",
+	"osix_trace_attr_destroy",
+	"osix_trace_attr_getclockres",
+	"osix_trace_attr_getcreatetime",
+	"osix_trace_attr_getgenversion",
+	"osix_trace_attr_getinherited",
+	"osix_trace_attr_getlogfullpolicy",
+	"osix_trace_attr_getlogsize",
+	"osix_trace_attr_getmaxdatasize",
+	"osix_trace_attr_getmaxsystemeventsize",
+	"osix_trace_attr_getmaxusereventsize",
+	"osix_trace_attr_getname",
+	"osix_trace_attr_getstreamfullpolicy",
+	"osix_trace_attr_getstreamsize",
+	"osix_trace_attr_init",
+	"osix_trace_attr_setinherited",
+	"osix_trace_attr_setlogfullpolicy",
+	"osix_trace_attr_setlogsize",
+	"osix_trace_attr_setmaxdatasize",
+	"osix_trace_attr_setname",
+	"osix_trace_attr_setstreamfullpolicy",
+	"osix_trace_attr_setstreamsize",
+	"osix_trace_clear",
+	"osix_trace_close",
+	"osix_trace_create",
+	"osix_trace_create_withlog",
+	"osix_trace_event",
+	"osix_trace_event_addr",
+	"osix_trace_eventid_equal",
+	"osix_trace_eventid_get_name",
+	"osix_trace_eventid_open",
+	"osix_trace_eventset_add",
+	"osix_trace_eventset_del",
+	"osix_trace_eventset_empty",
+	"osix_trace_eventset_fill",
+	"osix_trace_eventset_ismember",
+	"osix_trace_eventtypelist_getnext_id",
+	"osix_trace_eventtypelist_rewind",
+	"osix_trace_flush",
+	"osix_trace_get_attr",
+	"osix_trace_get_filter",
+	"osix_trace_get_status",
+	"osix_trace_getnext_event",
+	"osix_trace_open",
+	"osix_trace_rewind",
+	"osix_trace_set_filter",
+	"osix_trace_shutdown",
+	"osix_trace_start",
+	"osix_trace_stop",
+	"osix_trace_timedgetnext_event",
+	"osix_trace_trid_eventid_open",
+	"osix_trace_trygetnext_event",
+	"oundf",
+	"ount",
+	"oupper",
+	"owctrans",
+	"owerdown",
+	"owf",
+	"owlower",
+	"owupper",
+	"pen",
+	"pendir",
+	"printf",
+	"putc",
+	"puts",
+	"putwc",
+	"putws",
+	"q_close",
+	"q_getattr",
+	"q_notify",
+	"q_open",
+	"q_receive",
+	"q_send",
+	"q_setattr",
+	"q_timedreceive",
+	"q_timedsend",
+	"q_unlink",
+	"qrtf",
+	"rand",
+	"read",
+	"ree",
+	"reeaddrinfo",
+	"reopen",
+	"rexpf",
+	"rfcf",
+	"rff",
+	"rintf",
+	"rite",
+	"roundf",
+	"rt_import_argv",
+	"rt_load_data",
+	"runcf",
+	"salnum",
+	"salpha",
+	"sblank",
+	"scanf",
+	"scntrl",
+	"sctime",
+	"sctime_r",
+	"sdigit",
+	"search",
+	"seek",
+	"setpos",
+	"sgraph",
+	"sinf",
+	"sinhf",
+	"sleep",
+	"slower",
+	"snprintf",
+	"sort",
+	"sprint",
+	"sprintf",
+	"spunct",
+	"sscanf",
+	"sspace",
+	"stat",
+	"supper",
+	"swalnum",
+	"swalpha",
+	"swblank",
+	"swcntrl",
+	"swctype",
+	"swdigit",
+	"swgraph",
+	"swlower",
+	"swprint",
+	"swprintf",
+	"swpunct",
+	"swscanf",
+	"swspace",
+	"swupper",
+	"swxdigit",
+	"sxdigit",
+	"sync",
+	"tan2f",
+	"tanf",
+	"tanhf",
+	"tat",
+	"tell",
+	"texit",
+	"thread_attr_destroy",
+	"thread_attr_getdetachstate",
+	"thread_attr_getguardsize",
+	"thread_attr_getinheritsched",
+	"thread_attr_getschedparam",
+	"thread_attr_getschedpolicy",
+	"thread_attr_getscope",
+	"thread_attr_getstackaddr",
+	"thread_attr_getstacksize",
+	"thread_attr_init",
+	"thread_attr_setdetachstate",
+	"thread_attr_setguardsize",
+	"thread_attr_setinheritsched",
+	"thread_attr_setschedparam",
+	"thread_attr_setschedpolicy",
+	"thread_attr_setscope",
+	"thread_attr_setstackaddr",
+	"thread_attr_setstacksize",
+	"thread_cancel",
+	"thread_cond_broadcast",
+	"thread_cond_destroy",
+	"thread_cond_init",
+	"thread_cond_signal",
+	"thread_cond_timedwait",
+	"thread_cond_wait",
+	"thread_condattr_destroy",
+	"thread_condattr_getclock",
+	"thread_condattr_getpshared",
+	"thread_condattr_init",
+	"thread_condattr_setclock",
+	"thread_condattr_setpshared",
+	"thread_create",
+	"thread_exit",
+	"thread_getschedparam",
+	"thread_join",
+	"thread_kill",
+	"thread_mutex_destroy",
+	"thread_mutex_getprioceiling",
+	"thread_mutex_init",
+	"thread_mutex_lock",
+	"thread_mutex_setprioceiling",
+	"thread_mutex_trylock",
+	"thread_mutex_unlock",
+	"thread_mutexattr_destroy",
+	"thread_mutexattr_getprioceiling",
+	"thread_mutexattr_getprotocol",
+	"thread_mutexattr_getpshared",
+	"thread_mutexattr_gettype",
+	"thread_mutexattr_init",
+	"thread_mutexattr_setprioceiling",
+	"thread_mutexattr_setprotocol",
+	"thread_mutexattr_setpshared",
+	"thread_mutexattr_settype",
+	"thread_self",
+	"thread_setcancelstate",
+	"thread_setcanceltype",
+	"thread_setschedparam",
+	"thread_sigmask",
+	"thread_testcancel",
+	"time",
+	"toff",
+	"tohl",
+	"tohs",
+	"toi",
+	"tol",
+	"tonl",
+	"tons",
+	"towc",
+	"trcat",
+	"trchr",
+	"trcmp",
+	"trcoll",
+	"trcpy",
+	"trcspn",
+	"trerror",
+	"trftime",
+	"trlen",
+	"trncasecmp",
+	"trncat",
+	"trncmp",
+	"trncpy",
+	"trnlen",
+	"trpbrk",
+	"trptime",
+	"trrchr",
+	"trspn",
+	"trstr",
+	"trtod",
+	"trtof",
+	"trtok",
+	"trtok_r",
+	"trtol",
+	"trtoll",
+	"trtoul",
+	"trtoull",
+	"trxfrm",
+	"utc",
+	"utchar",
+	"uts",
+	"utwc",
+	"utwchar",
+	"wait",
+	"wide",
+	"wprintf",
+	"write",
+	"wscanf",
+	"xecve",
+	"xit",
+	"xp2f",
+	"xpf",
+	"xpm1f",
+	"ypotf",
+	"ystem",
+};
+
+static_assert(sos_crt_symbols_is_sorted(sos_sorted_symbols, 625), "sos_sorted_symbols must be sorted");
+
+static_assert(sos_crt_symbols_is_same_set(sos_symbols, 648, sos_sorted_symbols), "sos_symbols and sos_sorted_symbols must hold the same names");
+
+u32 sos_crt_symbols_get_sorted_count(){ return 625; }
+
+const char * sos_crt_symbols_get_sorted_entry(u32 value){ if( value < sos_crt_symbols_get_sorted_count() ){ return sos_sorted_symbols[value]; } return nullptr; }
+
@@ -7,5 +7,67 @@ var::String sos_crt_symbols_get_signature();
 u32 sos_crt_symbols_get_count();
 var::String sos_crt_symbols_get_entry(u32 value);
 
+// leading characters of each symbol name that are not in the tables (tables
+// imported before `admin.import` kept full names drop the first character)
+u32 sos_crt_symbols_get_name_offset();
+
+// the same symbols sorted (strcmp order) without duplicates for lookups
+u32 sos_crt_symbols_get_sorted_count();
+const char *sos_crt_symbols_get_sorted_entry(u32 value);
+
+constexpr int sos_crt_symbols_compare(const char *a, const char *b) {
+  while (*a != 0 && *a == *b) {
+    a++;
+    b++;
+  }
+  return static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b);
+}
+
+// used by the generated file to check the table at compile time
+constexpr bool
+sos_crt_symbols_is_sorted(const char *const *list, unsigned int count) {
+  for (unsigned int i = 1; i < count; i++) {
+    if (sos_crt_symbols_compare(list[i - 1], list[i]) >= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// used by the generated file to check that both tables hold the same names
+template <unsigned int sorted_count>
+constexpr bool sos_crt_symbols_is_same_set(
+  const char *const *list,
+  unsigned int count,
+  const char *const (&sorted_list)[sorted_count]) {
+  bool is_found[sorted_count] = {};
+  for (unsigned int i = 0; i < count; i++) {
+    unsigned int low = 0;
+    unsigned int high = sorted_count;
+    while (low < high) {
+      const unsigned int middle = low + (high - low) / 2;
+      const int result = sos_crt_symbols_compare(sorted_list[middle], list[i]);
+      if (result == 0) {
+        is_found[middle] = true;
+        break;
+      }
+      if (result < 0) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    if (low >= high) {
+      return false;
+    }
+  }
+
+  for (unsigned int i = 0; i < sorted_count; i++) {
+    if (!is_found[i]) {
+      return false;
+    }
+  }
+  return true;
+}
 
 #endif // SOS_CRT_SYMBOLS_HPP
@@ -0,0 +1,90 @@
+#include <cstring>
+
+#include "AssetfsReader.hpp"
+
+AssetfsReader::AssetfsReader(const fs::FileObject &file) {
+  API_RETURN_IF_ERROR();
+  m_size = file.size();
+  file.seek(0).read(View(m_count));
+
+  if (
+    is_error() || (return_value() != sizeof(m_count))
+    || (header_size() + u64(m_count) * sizeof(Entry) > m_size)) {
+    API_RETURN_ASSIGN_ERROR("invalid assetfs header", EINVAL);
+  }
+
+  m_file = &file;
+}
+
+AssetfsReader::Entry AssetfsReader::get_entry(u32 offset) const {
+  Entry result = {};
+  API_RETURN_VALUE_IF_ERROR(result);
+  if (!is_valid() || offset >= count()) {
+    return result;
+  }
+
+  m_file->seek(int(header_size() + offset * sizeof(Entry))).read(View(result));
+  if (return_value() != sizeof(Entry)) {
+    result = {};
+  }
+  return result;
+}
+
+AssetfsReader::EntryList AssetfsReader::get_entry_list() const {
+  EntryList result;
+  API_RETURN_VALUE_IF_ERROR(result);
+  if (!is_valid() || count() == 0) {
+    return result;
+  }
+
+  result.resize(count());
+  m_file->seek(int(header_size()))
+    .read(View(result.data(), result.count() * sizeof(Entry)));
+
+  if (return_value() != int(result.count() * sizeof(Entry))) {
+    return EntryList();
+  }
+  return result;
+}
+
+AssetfsReader::Entry AssetfsReader::find(const var::StringView name) const {
+  // the bundler sorts the dirent table by name
+  u32 low = 0;
+  u32 high = count();
+  while (low < high && is_success()) {
+    const u32 middle = low + (high - low) / 2;
+    const auto entry = get_entry(middle);
+    const int result = compare(entry, name);
+    if (result == 0) {
+      return entry;
+    }
+    if (result < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return Entry{};
+}
+
+const fs::FileObject &
+AssetfsReader::seek(const Entry &entry, u32 location) const {
+  API_ASSERT(is_valid());
+  if (entry.start + entry.size > m_size) {
+    API_RETURN_VALUE_ASSIGN_ERROR(
+      *m_file,
+      "assetfs entry exceeds the file size",
+      EINVAL);
+  }
+  return m_file->seek(int(entry.start + location));
+}
+
+int AssetfsReader::compare(const Entry &entry, const var::StringView name) {
+  const var::StringView entry_name(
+    entry.name,
+    strnlen(entry.name, sizeof(entry.name)));
+  if (entry_name == name) {
+    return 0;
+  }
+  return entry_name < name ? -1 : 1;
+}
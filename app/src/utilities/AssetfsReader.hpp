@@ -0,0 +1,48 @@
+#ifndef UTILITIES_ASSETFSREADER_HPP
+#define UTILITIES_ASSETFSREADER_HPP
+
+#include <fs/File.hpp>
+#include <sos/fs/drive_assetfs.h>
+#include <var.hpp>
+
+#include "App.hpp"
+
+// Random access to a `.assetfs` bundle using seek + partial reads. Only the
+// header table is read to find an entry, so it works the same for host
+// `fs::File` and device `sos::Link::File` objects.
+class AssetfsReader : public AppAccess {
+public:
+  using Entry = drive_assetfs_dirent_t;
+  using EntryList = var::Vector<Entry>;
+
+  explicit AssetfsReader(const fs::FileObject &file);
+
+  bool is_valid() const { return m_file != nullptr; }
+  u32 count() const { return m_count; }
+
+  Entry get_entry(u32 offset) const;
+
+  // reads the full dirent table in a single transaction
+  EntryList get_entry_list() const;
+
+  // binary search of the (name sorted) dirent table
+  Entry find(const var::StringView name) const;
+
+  static bool is_entry_valid(const Entry &entry) {
+    return entry.name[0] != 0;
+  }
+
+  // seeks the underlying file to the entry so that at most `entry.size` bytes
+  // can be streamed from it
+  const fs::FileObject &seek(const Entry &entry, u32 location = 0) const;
+
+private:
+  const fs::FileObject *m_file = nullptr;
+  u32 m_count = 0;
+  size_t m_size = 0;
+
+  static int compare(const Entry &entry, const var::StringView name);
+  static u32 header_size() { return sizeof(u32); }
+};
+
+#endif // UTILITIES_ASSETFSREADER_HPP
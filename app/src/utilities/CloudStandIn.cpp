@@ -0,0 +1,308 @@
+#include <chrono.hpp>
+#include <fs.hpp>
+#include <inet.hpp>
+#include <json.hpp>
+
+#include "CloudStandIn.hpp"
+
+CloudStandIn::~CloudStandIn() { stop(); }
+
+CloudStandIn &CloudStandIn::start() {
+  m_random = seed() ? seed() : 1;
+
+  if (!fs::FileSystem().directory_exists(path())) {
+    fs::FileSystem().create_directory(path(), fs::Dir::IsRecursive::yes);
+  }
+
+  m_is_running = true;
+  m_listen_thread = thread::Thread(
+    thread::Thread::Attributes().set_detach_state(
+      thread::Thread::DetachState::joinable),
+    thread::Thread::Construct().set_argument(this).set_function(
+      [](void *args) -> void * {
+        reinterpret_cast<CloudStandIn *>(args)->listen();
+        return nullptr;
+      }));
+
+  return *this;
+}
+
+void CloudStandIn::stop() {
+  if (!m_is_running) {
+    return;
+  }
+  m_is_running = false;
+
+  {
+    // a connection that sends nothing unblocks accept() in the listen thread
+    api::ErrorScope error_scope;
+    inet::HttpClient().connect("localhost", port());
+  }
+  m_listen_thread.join();
+}
+
+CloudStandIn::Statistics CloudStandIn::statistics() const {
+  thread::Mutex::Guard mg(m_mutex);
+  return m_statistics;
+}
+
+inet::Url CloudStandIn::redirect(const inet::Url &url) {
+  const auto base = session_settings().cloud_url();
+  if (base.is_empty() || url.domain_name().find("googleapis.com") == var::StringView::npos) {
+    return url;
+  }
+  return inet::Url(var::String(base) + url.path());
+}
+
+void CloudStandIn::listen() {
+  inet::AddressInfo address_info(
+    inet::AddressInfo::Construct()
+      .set_family(inet::Socket::Family::inet)
+      .set_service(var::NumberString(port()))
+      .set_type(inet::Socket::Type::stream)
+      .set_flags(inet::AddressInfo::Flags::passive));
+
+  const inet::SocketAddress &server_listen_address
+    = address_info.list().at(0);
+
+  inet::Socket server_listen_socket
+    = inet::Socket(server_listen_address)
+        .set_option(inet::SocketOption(
+          inet::Socket::Level::socket,
+          inet::Socket::NameFlags::socket_reuse_address))
+        .bind_and_listen(server_listen_address)
+        .move();
+
+  // requests are served one at a time so injected delays and failures
+  // happen in a repeatable order
+  while (m_is_running && is_success()) {
+    inet::SocketAddress accept_address;
+    inet::Socket accept_socket = server_listen_socket.accept(accept_address);
+    inet::HttpServer(accept_socket.move())
+      .run([this](
+             inet::HttpServer *server,
+             const inet::Http::Request &request) {
+        return respond(server, request);
+      });
+    API_RESET_ERROR();
+  }
+}
+
+inet::Http::IsStop CloudStandIn::respond(
+  inet::HttpServer *server,
+  const inet::Http::Request &request) {
+
+  if (request.method() == inet::Http::Method::null) {
+    return inet::Http::IsStop::yes;
+  }
+
+  const auto target = request.path();
+  const auto query_offset = target.find("?");
+  const auto request_path = target.get_substring_with_length(query_offset);
+  const auto query = query_offset == var::StringView::npos
+                       ? var::StringView()
+                       : target.get_substring_at_position(query_offset + 1);
+
+  const auto is_fail = inject();
+
+  const Reply reply = [&]() {
+    if (is_fail) {
+      return get_error(
+        inet::Http::Status::service_unavailable,
+        "injected failure");
+    }
+
+    if (request.method() != inet::Http::Method::get) {
+      return get_error(inet::Http::Status::bad_request, "unsupported method");
+    }
+
+    if (request_path.find("/v0/b/") == 0) {
+      return respond_object(
+        request_path.get_substring_at_position(
+          var::StringView("/v0/b/").length()),
+        query);
+    }
+
+    return get_error(inet::Http::Status::not_found, "unknown path");
+  }();
+
+  {
+    thread::Mutex::Guard mg(m_mutex);
+    m_statistics.set_request_count(m_statistics.request_count() + 1);
+    if (is_fail) {
+      m_statistics.set_failure_count(m_statistics.failure_count() + 1);
+    } else if (reply.status() == inet::Http::Status::not_found) {
+      m_statistics.set_not_found_count(m_statistics.not_found_count() + 1);
+    }
+  }
+
+  SL_PRINTER_TRACE(
+    "standin " + inet::Http::to_string(reply.status()) + " " + target);
+
+  const auto content_type = reply.content_type().is_empty()
+                              ? var::StringView("application/json")
+                              : reply.content_type().string_view();
+
+  if (reply.file_path().is_empty()) {
+    server->add_header_field("Content-Length", var::NumberString(reply.body().length()))
+      .add_header_field("Content-Type", content_type)
+      .add_header_field("Connection", "close")
+      .send(inet::Http::Response(server->http_version(), reply.status()))
+      .send(fs::ViewFile(reply.body()));
+  } else {
+    const fs::File file(reply.file_path());
+    server->add_header_field("Content-Length", var::NumberString(file.size()))
+      .add_header_field("Content-Type", content_type)
+      .add_header_field("Connection", "close")
+      .send(inet::Http::Response(server->http_version(), reply.status()))
+      .send(file);
+  }
+
+  return inet::Http::IsStop::yes;
+}
+
+CloudStandIn::Reply CloudStandIn::respond_object(
+  const var::StringView object_path,
+  const var::StringView query) {
+
+  {
+    thread::Mutex::Guard mg(m_mutex);
+    m_statistics.set_object_count(m_statistics.object_count() + 1);
+  }
+
+  // `<bucket>/o/<encoded name>`
+  const auto segment_list = object_path.split("/");
+  if (segment_list.count() < 3 || segment_list.at(1) != "o") {
+    return get_error(inet::Http::Status::bad_request, "invalid object path");
+  }
+
+  const auto bucket = segment_list.at(0);
+  const auto name = decode(object_path.get_substring_at_position(
+    bucket.length() + var::StringView("/o/").length()));
+
+  if (
+    bucket.is_empty() || name.is_empty() || !is_path_safe(bucket)
+    || !is_path_safe(name)) {
+    return get_error(inet::Http::Status::bad_request, "invalid object name");
+  }
+
+  const auto object_file_path = path() / bucket / name;
+
+  const auto get_metadata = [&]() {
+    return json::JsonDocument().stringify(
+      json::JsonObject()
+        .insert("name", json::JsonString(name))
+        .insert("bucket", json::JsonString(bucket))
+        .insert(
+          "size",
+          json::JsonString(var::NumberString(
+            fs::FileSystem().get_info(object_file_path).size())))
+        .insert("contentType", json::JsonString("application/octet-stream"))
+        .insert("downloadTokens", json::JsonString("standin")));
+  };
+
+  if (!fs::FileSystem().exists(object_file_path)) {
+    return get_error(inet::Http::Status::not_found, "object not found");
+  }
+
+  if (get_query_value(query, "alt") == "media") {
+    return Reply()
+      .set_file_path(object_file_path)
+      .set_content_type("application/octet-stream");
+  }
+  return Reply().set_body(get_metadata());
+}
+
+bool CloudStandIn::inject() {
+  u32 delay = latency();
+  bool is_fail = false;
+  {
+    thread::Mutex::Guard mg(m_mutex);
+    if (jitter()) {
+      delay += get_random() % (jitter() + 1);
+    }
+    if (failure_rate()) {
+      is_fail = (get_random() % 100) < failure_rate();
+    }
+  }
+
+  if (delay) {
+    chrono::wait(delay * 1_milliseconds);
+  }
+  return is_fail;
+}
+
+u32 CloudStandIn::get_random() {
+  // xorshift32: same sequence for the same seed on every host
+  m_random ^= m_random << 13;
+  m_random ^= m_random >> 17;
+  m_random ^= m_random << 5;
+  return m_random;
+}
+
+CloudStandIn::Reply CloudStandIn::get_error(
+  inet::Http::Status status,
+  const var::StringView message) {
+  return Reply().set_status(status).set_body(json::JsonDocument().stringify(
+    json::JsonObject().insert(
+      "error",
+      json::JsonObject()
+        .insert("code", json::JsonInteger(static_cast<int>(status)))
+        .insert("message", json::JsonString(message))
+        .insert(
+          "status",
+          json::JsonString(inet::Http::to_string(status))))));
+}
+
+var::String CloudStandIn::decode(const var::StringView value) {
+  const auto to_nibble = [](char c) -> int {
+    if (c >= '0' && c <= '9') {
+      return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+      return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+      return c - 'A' + 10;
+    }
+    return -1;
+  };
+
+  var::String result;
+  for (size_t i = 0; i < value.length(); i++) {
+    const char c = value.at(i);
+    if (c == '%' && i + 2 < value.length()) {
+      const int high = to_nibble(value.at(i + 1));
+      const int low = to_nibble(value.at(i + 2));
+      if (high >= 0 && low >= 0) {
+        const char decoded = static_cast<char>(high * 16 + low);
+        result += var::StringView(&decoded, 1);
+        i += 2;
+        continue;
+      }
+    }
+    result += var::StringView(c == '+' ? " " : &c, 1);
+  }
+  return result;
+}
+
+var::StringView CloudStandIn::get_query_value(
+  const var::StringView query,
+  const var::StringView key) {
+  for (const auto &pair : query.split("&")) {
+    const auto offset = pair.find("=");
+    if (offset != var::StringView::npos && pair.get_substring_with_length(offset) == key) {
+      return pair.get_substring_at_position(offset + 1);
+    }
+  }
+  return var::StringView();
+}
+
+bool CloudStandIn::is_path_safe(const var::StringView path) {
+  for (const auto &segment : path.split("/")) {
+    if (segment == ".." || segment == ".") {
+      return false;
+    }
+  }
+  return path.find("\\") == var::StringView::npos;
+}
@@ -0,0 +1,85 @@
+#ifndef UTILITIES_CLOUDSTANDIN_HPP
+#define UTILITIES_CLOUDSTANDIN_HPP
+
+#include <inet/Http.hpp>
+#include <inet/Url.hpp>
+#include <thread.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+
+// Local stand-in for cloud storage downloads served by `cloud.standin`.
+//
+// cloud::CloudService builds its own auth, document and storage URLs so only
+// the downloads `sl` makes itself (OperatingSystem::download_file) can be
+// pointed at the stand-in. It serves `GET /v0/b/<bucket>/o/<name>` (the
+// object with `alt=media`, otherwise its metadata) from
+// `path()/<bucket>/<name>` so a store can be seeded and inspected.
+//
+// Every request is delayed by `latency` plus up to `jitter` milliseconds and
+// `failure_rate` percent of requests fail with 503. The delays and failures
+// come from a generator seeded with `seed` so runs are repeatable.
+class CloudStandIn : public AppAccess {
+public:
+  class Statistics {
+    API_AF(Statistics, u32, request_count, 0);
+    API_AF(Statistics, u32, failure_count, 0);
+    API_AF(Statistics, u32, object_count, 0);
+    API_AF(Statistics, u32, not_found_count, 0);
+  };
+
+  ~CloudStandIn();
+
+  CloudStandIn &start();
+
+  // wakes the listen thread and waits for it to finish
+  void stop();
+
+  Statistics statistics() const;
+
+  // rewrites downloads from the hosted service to the base URL set with
+  // `--cloud` or `SL_CLOUD_URL` (cloud::CloudService requests are not covered)
+  static inet::Url redirect(const inet::Url &url);
+
+private:
+  API_AF(CloudStandIn, u16, port, 8090);
+  API_AC(CloudStandIn, var::PathString, path);
+  API_AF(CloudStandIn, u32, latency, 0);
+  API_AF(CloudStandIn, u32, jitter, 0);
+  API_AF(CloudStandIn, u32, failure_rate, 0);
+  API_AF(CloudStandIn, u32, seed, 1);
+
+  volatile bool m_is_running = false;
+  thread::Thread m_listen_thread;
+  mutable thread::Mutex m_mutex;
+  Statistics m_statistics;
+  u32 m_random = 0;
+
+  class Reply {
+    API_AF(Reply, inet::Http::Status, status, inet::Http::Status::ok);
+    API_AC(Reply, var::String, body);
+    // sent instead of `body` if not empty
+    API_AC(Reply, var::PathString, file_path);
+    API_AC(Reply, var::KeyString, content_type);
+  };
+
+  void listen();
+  inet::Http::IsStop
+  respond(inet::HttpServer *server, const inet::Http::Request &request);
+
+  Reply respond_object(
+    const var::StringView object_path,
+    const var::StringView query);
+
+  // delay and whether to fail the request
+  bool inject();
+  u32 get_random();
+
+  static Reply get_error(inet::Http::Status status, const var::StringView message);
+  static var::String decode(const var::StringView value);
+  static var::StringView
+  get_query_value(const var::StringView query, const var::StringView key);
+  static bool is_path_safe(const var::StringView path);
+};
+
+#endif // UTILITIES_CLOUDSTANDIN_HPP
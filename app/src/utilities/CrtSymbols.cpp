@@ -0,0 +1,117 @@
+#include <cstring>
+
+#include <swd/Elf.hpp>
+
+#include "sos_crt_symbols.hpp"
+
+#include "CrtSymbols.hpp"
+
+bool CrtSymbols::is_exported(const var::StringView name) {
+  const u32 name_offset = sos_crt_symbols_get_name_offset();
+  if (name.length() <= name_offset) {
+    return false;
+  }
+  const var::String key(name.get_substring_at_position(name_offset));
+  u32 low = 0;
+  u32 high = sos_crt_symbols_get_sorted_count();
+  while (low < high) {
+    const u32 middle = low + (high - low) / 2;
+    const int result = sos_crt_symbols_compare(
+      sos_crt_symbols_get_sorted_entry(middle),
+      key.cstring());
+    if (result == 0) {
+      return true;
+    }
+    if (result < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return false;
+}
+
+var::StringList
+CrtSymbols::get_missing_symbol_list(const fs::FileObject &elf) {
+  constexpr u16 section_index_undefined = 0;
+  constexpr u8 binding_weak = 2;
+
+  const auto symbol_list = swd::Elf(elf).get_symbol_list();
+  if (is_error()) {
+    return var::StringList();
+  }
+
+  var::StringList result;
+  for (const auto &symbol : symbol_list) {
+    if (
+      symbol.section_index() != section_index_undefined
+      || symbol.name().is_empty() || (symbol.info() >> 4) == binding_weak) {
+      continue;
+    }
+
+    if (
+      !is_exported(symbol.name())
+      && result.find_offset(symbol.name()) == result.count()) {
+      result.push_back(symbol.name());
+    }
+  }
+  return result;
+}
+
+var::PathString CrtSymbols::find_application_elf(
+  const var::StringView project_path,
+  const var::StringView binary_path,
+  const var::StringView build_name,
+  const var::StringView name) {
+
+  if (!binary_path.is_empty()) {
+    const auto base = fs::Path::no_suffix(binary_path);
+    for (const auto &candidate :
+         {var::PathString(base & ".elf"), var::PathString(base)}) {
+      if (is_elf(candidate)) {
+        return candidate;
+      }
+    }
+    return var::PathString();
+  }
+
+  if (project_path.is_empty()) {
+    return var::PathString();
+  }
+
+  const auto build_prefix
+    = var::PathString("build_")
+      & (build_name.is_empty() ? var::StringView("release") : build_name);
+
+  const auto directory_list = fs::FileSystem().read_directory(project_path);
+  for (const auto &directory : directory_list) {
+    if (directory.string_view().find(build_prefix) != 0) {
+      continue;
+    }
+
+    const auto build_path = project_path / directory;
+    for (const auto &candidate :
+         {var::PathString(build_path / name & ".elf"),
+          var::PathString(build_path / name)}) {
+      if (is_elf(candidate)) {
+        return candidate;
+      }
+    }
+  }
+  API_RESET_ERROR();
+  return var::PathString();
+}
+
+bool CrtSymbols::is_elf(const var::StringView path) {
+  if (!fs::FileSystem().exists(path)) {
+    return false;
+  }
+
+  char magic[4] = {};
+  fs::File(path).read(var::View(magic, sizeof(magic)));
+  if (is_error()) {
+    API_RESET_ERROR();
+    return false;
+  }
+  return memcmp(magic, "\x7f" "ELF", sizeof(magic)) == 0;
+}
@@ -0,0 +1,34 @@
+#ifndef UTILITIES_CRTSYMBOLS_HPP
+#define UTILITIES_CRTSYMBOLS_HPP
+
+#include <fs.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+
+// Checks application ELF imports against the symbols the OS exports through
+// the CRT table (sos_crt_symbols.cpp) so a missing symbol is reported before
+// anything is transferred to the device.
+class CrtSymbols : public AppAccess {
+public:
+  // `name` is the symbol name as it appears in the ELF (compared without the
+  // leading characters the table doesn't have, see
+  // sos_crt_symbols_get_name_offset())
+  static bool is_exported(const var::StringView name);
+
+  // returns the undefined (non-weak) symbols of `elf` the OS doesn't export
+  static var::StringList get_missing_symbol_list(const fs::FileObject &elf);
+
+  // finds the ELF for a binary image or a project build directory
+  // (empty if there isn't one)
+  static var::PathString find_application_elf(
+    const var::StringView project_path,
+    const var::StringView binary_path,
+    const var::StringView build_name,
+    const var::StringView name);
+
+private:
+  static bool is_elf(const var::StringView path);
+};
+
+#endif // UTILITIES_CRTSYMBOLS_HPP
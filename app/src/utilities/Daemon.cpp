@@ -0,0 +1,359 @@
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+#if !defined __win32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#if !defined MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#include <fs.hpp>
+#include <thread.hpp>
+
+#include "Group.hpp"
+
+#include "Daemon.hpp"
+#include "DeviceCache.hpp"
+
+#if !defined __win32
+
+namespace {
+int connect_socket(const var::StringView path) {
+  const int result = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (result < 0) {
+    return -1;
+  }
+
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, PathString(path).cstring(), sizeof(address.sun_path) - 1);
+  if (::connect(result, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+    ::close(result);
+    return -1;
+  }
+  return result;
+}
+} // namespace
+
+Daemon::~Daemon() { stop(); }
+
+void Daemon::stop() {
+  if (m_is_running) {
+    m_is_running = false;
+    ::close(m_listen_fd);
+    ::unlink(PathString(path()).cstring());
+  }
+}
+
+Daemon &Daemon::start() {
+  printer().open_command("daemon");
+  SlPrinter::Output printer_output_guard(printer());
+  printer().key("path", path());
+
+  const auto directory = FilePathSettings::global_directory();
+  if (!fs::FileSystem().directory_exists(directory)) {
+    fs::FileSystem().create_directory(directory, fs::Dir::IsRecursive::yes);
+  }
+
+  // a stale socket from a daemon that did not exit cleanly
+  ::unlink(PathString(path()).cstring());
+
+  m_listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  strncpy(
+    address.sun_path,
+    PathString(path()).cstring(),
+    sizeof(address.sun_path) - 1);
+  // update() polls the socket from the main loop
+  if (
+    m_listen_fd < 0
+    || ::bind(m_listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address))
+         < 0
+    || ::listen(m_listen_fd, 8) < 0
+    || ::fcntl(m_listen_fd, F_SETFL, O_NONBLOCK) < 0) {
+    printer().error("failed to open the daemon socket `" | path() | "`");
+    printer().close_fail();
+    return *this;
+  }
+
+  m_is_running = true;
+  printer().close_success();
+  return *this;
+}
+
+bool Daemon::update() {
+  if (m_is_running == false) {
+    return false;
+  }
+
+  // requests are served one at a time so they share the connection safely
+  const int fd = ::accept(m_listen_fd, nullptr, nullptr);
+  if (fd >= 0) {
+    // the request itself is read with blocking calls
+    ::fcntl(fd, F_SETFL, 0);
+    serve(fd);
+    ::close(fd);
+    API_RESET_ERROR();
+  }
+  return true;
+}
+
+void Daemon::serve(int fd) {
+  const auto directory = receive_string(fd);
+  const auto argument_list = receive_argument_list(fd);
+
+  int pipe_fd[2];
+  if (
+    directory.is_empty() || argument_list.count() == 0
+    || ::pipe(pipe_fd) < 0) {
+    const s32 exit_code = 1;
+    write_frame(fd, FrameType::exit, View(exit_code));
+    return;
+  }
+
+  struct Context {
+    int read_fd;
+    int client_fd;
+  } context = {pipe_fd[0], fd};
+
+  // forwards everything the printers write to stdout while the commands run
+  Thread forward_thread(
+    Thread::Attributes().set_detach_state(Thread::DetachState::joinable),
+    Thread::Construct().set_argument(&context).set_function(
+      [](void *args) -> void * {
+        auto *context = reinterpret_cast<Context *>(args);
+        char buffer[4096];
+        ssize_t bytes_read;
+        while ((bytes_read = ::read(context->read_fd, buffer, sizeof(buffer)))
+               > 0) {
+          write_frame(
+            context->client_fd,
+            FrameType::output,
+            View(buffer, size_t(bytes_read)));
+        }
+        return nullptr;
+      }));
+
+  // other processes may have changed the device since the last request
+  DeviceCache::clear();
+
+  fflush(stdout);
+  const int saved_stdout = ::dup(fileno(stdout));
+  ::dup2(pipe_fd[1], fileno(stdout));
+  ::close(pipe_fd[1]);
+
+  const bool is_success = execute(directory, argument_list);
+  DeviceCache::print_statistics();
+
+  fflush(stdout);
+  ::dup2(saved_stdout, fileno(stdout));
+  ::close(saved_stdout);
+
+  forward_thread.join();
+  ::close(pipe_fd[0]);
+
+  // output was already streamed, the listen server is the only other consumer
+  while (printer().queue().count() > 0) {
+    printer().queue().pop();
+  }
+
+  const s32 exit_code = is_success ? 0 : 1;
+  write_frame(fd, FrameType::exit, View(exit_code));
+}
+
+bool Daemon::execute(
+  const var::StringView directory,
+  const var::StringList &list) {
+  char daemon_directory[PATH_MAX];
+  if (::getcwd(daemon_directory, sizeof(daemon_directory)) == nullptr) {
+    printer().error("failed to get the daemon's working directory");
+    return false;
+  }
+
+  if (::chdir(PathString(directory).cstring()) < 0) {
+    printer().error("failed to change to `" | directory | "`");
+    return false;
+  }
+
+  // relative paths and the workspace settings are the client's
+  workspace_settings() = WorkspaceSettings();
+
+  var::Vector<CommandInput> command_list;
+  command_list.reserve(list.count());
+  for (const auto &argument : list) {
+    command_list.push_back(CommandInput(argument));
+  }
+  const bool result = Group::execute_command_list(command_list);
+
+  ::chdir(daemon_directory);
+  workspace_settings() = WorkspaceSettings();
+  return result;
+}
+
+var::String Daemon::receive_string(int fd) {
+  u32 length = 0;
+  if (read_all(fd, &length, sizeof(length)) == false || length > 4096) {
+    return var::String();
+  }
+  var::Data value(length);
+  if (read_all(fd, value.data(), length) == false) {
+    return var::String();
+  }
+  return String(
+    StringView(reinterpret_cast<const char *>(value.data()), length));
+}
+
+var::StringList Daemon::receive_argument_list(int fd) {
+  var::StringList result;
+  u32 count = 0;
+  if (read_all(fd, &count, sizeof(count)) == false) {
+    return result;
+  }
+
+  for (u32 i = 0; i < count; i++) {
+    const auto argument = receive_string(fd);
+    if (argument.is_empty()) {
+      return var::StringList();
+    }
+    result.push_back(argument);
+  }
+  return result;
+}
+
+bool Daemon::write_all(int fd, const void *buffer, size_t size) {
+  const char *cursor = reinterpret_cast<const char *>(buffer);
+  while (size > 0) {
+    const ssize_t result = ::send(fd, cursor, size, MSG_NOSIGNAL);
+    if (result <= 0) {
+      return false;
+    }
+    cursor += result;
+    size -= size_t(result);
+  }
+  return true;
+}
+
+bool Daemon::read_all(int fd, void *buffer, size_t size) {
+  char *cursor = reinterpret_cast<char *>(buffer);
+  while (size > 0) {
+    const ssize_t result = ::recv(fd, cursor, size, 0);
+    if (result <= 0) {
+      return false;
+    }
+    cursor += result;
+    size -= size_t(result);
+  }
+  return true;
+}
+
+bool Daemon::write_frame(int fd, FrameType type, const var::View payload) {
+  const u8 frame_type = u8(type);
+  const u32 length = payload.size();
+  return write_all(fd, &frame_type, sizeof(frame_type))
+         && write_all(fd, &length, sizeof(length))
+         && write_all(fd, payload.to_const_void(), length);
+}
+
+Daemon::Client::Client(const sys::Cli &cli) : m_cli(cli) {
+  if (cli.count() < 2) {
+    return;
+  }
+
+  // switches change the session (printer format, verbosity, ...) so those
+  // invocations always run in-process
+  for (u32 i = 1; i < cli.count(); i++) {
+    if (cli.at(i).find("-") == 0) {
+      return;
+    }
+  }
+
+  if (::access(PathString(path()).cstring(), F_OK) != 0) {
+    return;
+  }
+
+  m_fd = connect_socket(path());
+}
+
+Daemon::Client::~Client() {
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+int Daemon::Client::execute() {
+  char directory[PATH_MAX];
+  if (::getcwd(directory, sizeof(directory)) == nullptr) {
+    fprintf(stderr, "failed to get the working directory\n");
+    return 1;
+  }
+
+  const u32 directory_length = strlen(directory);
+  const u32 count = m_cli.count() - 1;
+  bool is_sent = write_all(m_fd, &directory_length, sizeof(directory_length))
+                 && write_all(m_fd, directory, directory_length)
+                 && write_all(m_fd, &count, sizeof(count));
+  for (u32 i = 1; i < m_cli.count() && is_sent; i++) {
+    const StringView argument = m_cli.at(i);
+    const u32 length = argument.length();
+    is_sent = write_all(m_fd, &length, sizeof(length))
+              && write_all(m_fd, argument.data(), length);
+  }
+
+  var::Data payload;
+  while (is_sent) {
+    u8 frame_type = 0;
+    u32 length = 0;
+    if (
+      read_all(m_fd, &frame_type, sizeof(frame_type)) == false
+      || read_all(m_fd, &length, sizeof(length)) == false) {
+      break;
+    }
+
+    payload.resize(length);
+    if (read_all(m_fd, payload.data(), length) == false) {
+      break;
+    }
+
+    if (FrameType(frame_type) == FrameType::exit) {
+      s32 exit_code = 1;
+      if (length == sizeof(exit_code)) {
+        memcpy(&exit_code, payload.data(), sizeof(exit_code));
+      }
+      return exit_code;
+    }
+
+    fwrite(payload.data(), 1, length, stdout);
+    fflush(stdout);
+  }
+
+  fprintf(stderr, "lost the connection to the `sl` daemon\n");
+  return 1;
+}
+
+#else
+
+Daemon::~Daemon() {}
+void Daemon::stop() {}
+bool Daemon::update() { return false; }
+
+Daemon &Daemon::start() {
+  printer().open_command("daemon");
+  SlPrinter::Output printer_output_guard(printer());
+  printer().error("`--daemon` requires Unix domain sockets (not available on "
+                  "Windows)");
+  printer().close_fail();
+  return *this;
+}
+
+Daemon::Client::Client(const sys::Cli &cli) : m_cli(cli) {}
+Daemon::Client::~Client() {}
+int Daemon::Client::execute() { return 1; }
+
+#endif
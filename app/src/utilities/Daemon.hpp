@@ -0,0 +1,73 @@
+#ifndef UTILITIES_DAEMON_HPP
+#define UTILITIES_DAEMON_HPP
+
+#include <sys/Cli.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+#include "settings/FilePathSettings.hpp"
+
+// `sl --daemon` keeps the connection and the parsed settings alive and serves
+// commands over a local Unix socket (`sl_daemon.sock` in the global `sl`
+// directory).
+//
+// A regular `sl` invocation that has only commands (no switches) forwards its
+// working directory and arguments to the daemon when the socket accepts a
+// connection. The daemon runs the commands from the client's working
+// directory (so relative paths and the workspace settings are the client's)
+// with the printer's stdout redirected into the socket so the output reaches
+// the client unchanged, followed by the exit code.
+//
+// Requests are served by `update()` on the main loop thread so nothing else
+// writes to stdout while it is redirected.
+//
+// Request: (u32 length, bytes) working directory, u32 argument count, then
+// (u32 length, bytes) per argument
+// Reply: frames of u8 type, u32 length, payload (output bytes or exit code)
+class Daemon : public AppAccess {
+public:
+  enum class FrameType { output, exit };
+
+  static var::PathString path() {
+    return FilePathSettings::daemon_socket_path();
+  }
+
+  Daemon() = default;
+  ~Daemon();
+
+  Daemon &start();
+  void stop();
+
+  // serves a pending request (returns true while the daemon is running)
+  bool update();
+
+  class Client {
+  public:
+    explicit Client(const sys::Cli &cli);
+    ~Client();
+
+    bool is_connected() const { return m_fd >= 0; }
+
+    // returns the exit code reported by the daemon
+    int execute();
+
+  private:
+    const sys::Cli &m_cli;
+    int m_fd = -1;
+  };
+
+private:
+  bool m_is_running = false;
+  int m_listen_fd = -1;
+
+  void serve(int fd);
+  bool execute(const var::StringView directory, const var::StringList &list);
+  static var::String receive_string(int fd);
+  static var::StringList receive_argument_list(int fd);
+
+  static bool write_all(int fd, const void *buffer, size_t size);
+  static bool read_all(int fd, void *buffer, size_t size);
+  static bool write_frame(int fd, FrameType type, const var::View payload);
+};
+
+#endif // UTILITIES_DAEMON_HPP
@@ -0,0 +1,207 @@
+#include "DeviceCache.hpp"
+
+thread::Mutex DeviceCache::m_mutex;
+var::KeyString DeviceCache::m_serial_number;
+var::Vector<DeviceCache::InfoEntry> DeviceCache::m_info_list;
+var::Vector<DeviceCache::DirectoryEntry> DeviceCache::m_directory_list;
+var::Vector<DeviceCache::AppfsEntry> DeviceCache::m_appfs_list;
+DeviceCache::Statistics DeviceCache::m_statistics;
+
+fs::FileInfo DeviceCache::get_info(
+  link_transport_mdriver_t *driver,
+  const var::StringView path) {
+  if (driver == nullptr) {
+    return sos::Link::FileSystem(driver).get_info(path);
+  }
+
+  {
+    Mutex::Guard mg(m_mutex);
+    check_serial_number();
+    for (const auto &entry : m_info_list) {
+      if (entry.path() == path) {
+        record(true);
+        return entry.info();
+      }
+    }
+    record(false);
+  }
+
+  const auto result = sos::Link::FileSystem(driver).get_info(path);
+  if (is_success()) {
+    Mutex::Guard mg(m_mutex);
+    m_info_list.push_back(InfoEntry().set_path(path).set_info(result));
+  }
+  return result;
+}
+
+fs::PathList DeviceCache::read_directory(
+  link_transport_mdriver_t *driver,
+  const var::StringView path) {
+  if (driver == nullptr) {
+    return sos::Link::FileSystem(driver).read_directory(
+      path,
+      fs::Dir::IsRecursive::no);
+  }
+
+  {
+    Mutex::Guard mg(m_mutex);
+    check_serial_number();
+    for (const auto &entry : m_directory_list) {
+      if (entry.path() == path) {
+        record(true);
+        return entry.list();
+      }
+    }
+    record(false);
+  }
+
+  const auto result = sos::Link::FileSystem(driver).read_directory(
+    path,
+    fs::Dir::IsRecursive::no);
+  if (is_success()) {
+    Mutex::Guard mg(m_mutex);
+    m_directory_list.push_back(
+      DirectoryEntry().set_path(path).set_list(result));
+  }
+  return result;
+}
+
+sos::Appfs::Info DeviceCache::get_appfs_info(
+  link_transport_mdriver_t *driver,
+  const var::StringView path) {
+  if (driver == nullptr) {
+    return sos::Appfs(driver).get_info(path);
+  }
+
+  {
+    Mutex::Guard mg(m_mutex);
+    check_serial_number();
+    for (const auto &entry : m_appfs_list) {
+      if (entry.path() == path) {
+        record(true);
+        return entry.info();
+      }
+    }
+    record(false);
+  }
+
+  const auto result = sos::Appfs(driver).get_info(path);
+  if (is_success()) {
+    Mutex::Guard mg(m_mutex);
+    m_appfs_list.push_back(AppfsEntry().set_path(path).set_info(result));
+  }
+  return result;
+}
+
+DeviceCache::DirectoryInfoList DeviceCache::read_directory_info(
+  link_transport_mdriver_t *driver,
+  const var::StringView path,
+  bool is_hide) {
+  DirectoryInfoList result;
+  const auto list = read_directory(driver, path);
+  if (is_error()) {
+    return result;
+  }
+
+  result.reserve(list.count());
+  for (const auto &entry : list) {
+    if (is_hide && entry.string_view().find(".") == 0) {
+      continue;
+    }
+
+    const auto entry_path = var::PathString(path) / entry;
+    const auto info = get_info(driver, entry_path);
+    if (is_error()) {
+      // the entry is kept with invalid info rather than losing the listing
+      SL_PRINTER_TRACE("failed to get info for " | entry_path);
+      API_RESET_ERROR();
+      result.push_back(DirectoryInfo().set_name(entry));
+      continue;
+    }
+    result.push_back(DirectoryInfo().set_name(entry).set_info(info));
+  }
+  return result;
+}
+
+void DeviceCache::invalidate(const var::StringView path) {
+  Mutex::Guard mg(m_mutex);
+  const auto parent = fs::Path::parent_directory(path);
+
+  const auto remove_if = [&](auto &list, bool is_listing) {
+    for (size_t i = 0; i < list.count();) {
+      const auto entry_path = list.at(i).path().string_view();
+      if (
+        is_affected(entry_path, path)
+        || (is_listing && entry_path == parent)) {
+        list.remove(i);
+        m_statistics.set_invalidate_count(
+          m_statistics.invalidate_count() + 1);
+      } else {
+        i++;
+      }
+    }
+  };
+
+  remove_if(m_info_list, false);
+  remove_if(m_directory_list, true);
+  remove_if(m_appfs_list, false);
+}
+
+void DeviceCache::clear() {
+  Mutex::Guard mg(m_mutex);
+  m_statistics.set_invalidate_count(
+    m_statistics.invalidate_count() + m_info_list.count()
+    + m_directory_list.count() + m_appfs_list.count());
+  m_info_list.clear();
+  m_directory_list.clear();
+  m_appfs_list.clear();
+}
+
+DeviceCache::Statistics DeviceCache::statistics() {
+  Mutex::Guard mg(m_mutex);
+  return m_statistics;
+}
+
+void DeviceCache::print_statistics() {
+  const auto result = statistics();
+  if (
+    printer().verbose_level() < printer::Printer::Level::debug
+    || (result.hit_count() + result.miss_count()) == 0) {
+    return;
+  }
+
+  printer().open_object("deviceCache", printer::Printer::Level::debug);
+  printer().key("hits", NumberString(result.hit_count()));
+  printer().key("misses", NumberString(result.miss_count()));
+  printer().key("invalidated", NumberString(result.invalidate_count()));
+  printer().close_object();
+}
+
+void DeviceCache::check_serial_number() {
+  const auto serial_number = session_settings().serial_number().string_view();
+  if (m_serial_number.string_view() != serial_number) {
+    m_info_list.clear();
+    m_directory_list.clear();
+    m_appfs_list.clear();
+    m_serial_number = var::KeyString(serial_number);
+  }
+}
+
+bool DeviceCache::is_affected(
+  const var::StringView entry,
+  const var::StringView path) {
+  if (entry.find(path) != 0) {
+    return false;
+  }
+  // `/app/flash/a` is below `/app`, `/app2` is not
+  return entry.length() == path.length() || entry.at(path.length()) == '/'
+         || path.length() == 0 || path.at(path.length() - 1) == '/';
+}
+
+void DeviceCache::record(bool is_hit) {
+  if (is_hit) {
+    m_statistics.set_hit_count(m_statistics.hit_count() + 1);
+  } else {
+    m_statistics.set_miss_count(m_statistics.miss_count() + 1);
+  }
+}
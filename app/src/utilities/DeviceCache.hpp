@@ -0,0 +1,90 @@
+#ifndef UTILITIES_DEVICECACHE_HPP
+#define UTILITIES_DEVICECACHE_HPP
+
+#include <fs.hpp>
+#include <sos.hpp>
+#include <thread.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+
+// Session cache of device metadata (file info, directory listings and appfs
+// info) keyed by the connected device's serial number.
+//
+// Host paths (null driver) are passed through. Failed lookups are not cached
+// so callers see the same error state as the uncached call. Commands that
+// modify the device through sl must call `invalidate()` for the paths they
+// change (or `clear()` when the whole filesystem changes).
+class DeviceCache : public AppAccess {
+public:
+  class DirectoryInfo {
+    API_AC(DirectoryInfo, var::PathString, name);
+    API_AC(DirectoryInfo, fs::FileInfo, info);
+  };
+
+  using DirectoryInfoList = var::Vector<DirectoryInfo>;
+
+  class Statistics {
+    API_AF(Statistics, u32, hit_count, 0);
+    API_AF(Statistics, u32, miss_count, 0);
+    API_AF(Statistics, u32, invalidate_count, 0);
+  };
+
+  static fs::FileInfo
+  get_info(link_transport_mdriver_t *driver, const var::StringView path);
+
+  static fs::PathList
+  read_directory(link_transport_mdriver_t *driver, const var::StringView path);
+
+  static sos::Appfs::Info
+  get_appfs_info(link_transport_mdriver_t *driver, const var::StringView path);
+
+  // reads a directory and the info of each entry (hidden entries are
+  // dropped if `is_hide` is set). The link has no combined readdir/stat so
+  // this is one listing plus one stat per entry not already cached, and
+  // every result is kept for later lookups in the session. An entry that
+  // can't be read is returned with invalid info.
+  static DirectoryInfoList read_directory_info(
+    link_transport_mdriver_t *driver,
+    const var::StringView path,
+    bool is_hide = false);
+
+  // drops `path`, everything below it and the listing of its parent
+  static void invalidate(const var::StringView path);
+  static void clear();
+
+  static Statistics statistics();
+
+  // prints the hit/miss counts at `--verbose=debug`
+  static void print_statistics();
+
+private:
+  class InfoEntry {
+    API_AC(InfoEntry, var::PathString, path);
+    API_AC(InfoEntry, fs::FileInfo, info);
+  };
+
+  class DirectoryEntry {
+    API_AC(DirectoryEntry, var::PathString, path);
+    API_AC(DirectoryEntry, fs::PathList, list);
+  };
+
+  class AppfsEntry {
+    API_AC(AppfsEntry, var::PathString, path);
+    API_AC(AppfsEntry, sos::Appfs::Info, info);
+  };
+
+  static thread::Mutex m_mutex;
+  static var::KeyString m_serial_number;
+  static var::Vector<InfoEntry> m_info_list;
+  static var::Vector<DirectoryEntry> m_directory_list;
+  static var::Vector<AppfsEntry> m_appfs_list;
+  static Statistics m_statistics;
+
+  // clears the entries if a different device is connected
+  static void check_serial_number();
+  static bool is_affected(const var::StringView entry, const var::StringView path);
+  static void record(bool is_hit);
+};
+
+#endif // UTILITIES_DEVICECACHE_HPP
@@ -1,55 +1,462 @@
+#include <cstring>
+
 #include <fs.hpp>
 
 #include "GcovParser.hpp"
+#include "ThreadPool.hpp"
 
 GcovParser::GcovParser() {}
 
 GcovCoverage GcovParser::parse(const var::StringList &path_list) {
   APP_CALL_GRAPH_TRACE_CLASS_FUNCTION("GcovParser");
 
-  JsonKeyValueList<GcovFileCoverage> coverage_list;
+  // files are scanned in parallel; the JSON is built on this thread
+  var::Vector<Count> count_list(path_list.count());
+  ThreadPool::execute(
+    ThreadPool::Execute()
+      .set_count(path_list.count())
+      .set_thread_count(thread_count()),
+    [&](size_t index) {
+      count_list.at(index) = parse_file(path_list.at(index));
+    });
 
+  JsonKeyValueList<GcovFileCoverage> coverage_list;
   coverage_list.reserve(path_list.count());
-  for (const String &path : path_list) {
-    coverage_list.push_back(parse_file(path));
+
+  u32 line_count = 0;
+  u32 line_execution_count = 0;
+  for (const auto index : api::Index(path_list.count())) {
+    const auto &count = count_list.at(index);
+    line_count += count.line_count();
+    line_execution_count += count.line_execution_count();
+    coverage_list.push_back(
+      GcovFileCoverage(path_list.at(index))
+        .set_line_count(count.line_count())
+        .set_line_execution_count(count.line_execution_count()));
   }
 
   return GcovCoverage()
     .set_source_list(coverage_list)
-    .calculate_line_count()
-    .calculate_line_execution_count();
+    .set_line_count(line_count)
+    .set_line_execution_count(line_execution_count);
 }
 
-GcovFileCoverage GcovParser::parse_file(const var::StringView path) {
-  APP_CALL_GRAPH_TRACE_CLASS_FUNCTION("GcovParser");
+GcovParser::Count GcovParser::parse_file(const var::StringView path) {
+  u32 line_count = 0;
+  u32 line_execution_count = 0;
+  stream_file(path, [&](const Record &record) {
+    if (record.type() == Record::Type::line) {
+      line_count++;
+      if (record.execution_count()) {
+        line_execution_count++;
+      }
+    }
+  });
+
+  if (is_error()) {
+    API_RESET_ERROR();
+    return Count();
+  }
+  return Count().set_line_count(line_count).set_line_execution_count(
+    line_execution_count);
+}
+
+void GcovParser::stream_file(
+  const var::StringView path,
+  const RecordCallback &callback) {
+  File input_file(path);
+  if (is_error()) {
+    return;
+  }
+
+  // a line that doesn't fit in the buffer is scanned up to the buffer size
+  // (only the source text is cut off)
+  char buffer[8192];
+  size_t length = 0;
+  bool is_skip = false;
+  const u32 input_size = input_file.size();
+  u32 offset = 0;
+
+  while (offset < input_size && is_success()) {
+    const u32 page_size = input_size - offset > sizeof(buffer) - length
+                            ? sizeof(buffer) - length
+                            : input_size - offset;
+    input_file.read(View(buffer + length, page_size));
+    offset += page_size;
+    length += page_size;
+
+    const char *cursor = buffer;
+    const char *const end = buffer + length;
+    const char *line_end;
+    while ((line_end = reinterpret_cast<const char *>(
+              memchr(cursor, '\n', size_t(end - cursor))))
+           != nullptr) {
+      if (!is_skip) {
+        scan_line(cursor, line_end, callback);
+      }
+      is_skip = false;
+      cursor = line_end + 1;
+    }
+
+    if (cursor == buffer && length == sizeof(buffer)) {
+      scan_line(buffer, end, callback);
+      is_skip = true;
+      length = 0;
+    } else {
+      length = size_t(end - cursor);
+      memmove(buffer, cursor, length);
+    }
+  }
+
+  if (length && !is_skip) {
+    scan_line(buffer, buffer + length, callback);
+  }
+}
 
-  DataFile data_file = std::move(DataFile().write(File(path)));
+void GcovParser::scan(const var::View buffer, const RecordCallback &callback) {
+  const char *cursor = buffer.to_const_char();
+  const char *const end = cursor + buffer.size();
 
-  String line;
+  while (cursor < end) {
+    const auto *line_end = reinterpret_cast<const char *>(
+      memchr(cursor, '\n', size_t(end - cursor)));
+    if (line_end == nullptr) {
+      line_end = end;
+    }
+    scan_line(cursor, line_end, callback);
+    cursor = line_end + 1;
+  }
+}
+
+GcovParser::Count GcovParser::count_lines(const var::View buffer) {
   u32 line_count = 0;
   u32 line_execution_count = 0;
+  scan(buffer, [&](const Record &record) {
+    if (record.type() == Record::Type::line) {
+      line_count++;
+      if (record.execution_count()) {
+        line_execution_count++;
+      }
+    }
+  });
+
+  return Count().set_line_count(line_count).set_line_execution_count(
+    line_execution_count);
+}
+
+void GcovParser::scan_line(
+  const char *begin,
+  const char *end,
+  const RecordCallback &callback) {
+  // each line is `<count>:<line number>:<source>`, `-` marks lines that are
+  // not considered and `#####` (or `=====`, `$$$$$`, `%%%%%`) marks lines
+  // that were never executed
+  if (end > begin && end[-1] == '\r') {
+    end--;
+  }
+
+  const auto skip_space = [&](const char *cursor) {
+    while (cursor < end && *cursor == ' ') {
+      cursor++;
+    }
+    return cursor;
+  };
+
+  const auto parse_number = [&](const char *&cursor) {
+    u64 result = 0;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+      result = result * 10 + u64(*cursor - '0');
+      cursor++;
+    }
+    return result;
+  };
+
+  constexpr size_t function_length = sizeof("function ") - 1;
+  if (
+    size_t(end - begin) > function_length
+    && memcmp(begin, "function ", function_length) == 0) {
+    const char *name = begin + function_length;
+    const char *name_end = name;
+    while (name_end < end && *name_end != ' ') {
+      name_end++;
+    }
+
+    const char *cursor = skip_space(name_end);
+    constexpr size_t called_length = sizeof("called ") - 1;
+    u64 called = 0;
+    if (
+      size_t(end - cursor) > called_length
+      && memcmp(cursor, "called ", called_length) == 0) {
+      cursor += called_length;
+      called = parse_number(cursor);
+    }
+
+    callback(Record()
+               .set_type(Record::Type::function)
+               .set_execution_count(called)
+               .set_value(var::StringView(name, size_t(name_end - name))));
+    return;
+  }
+
+  const auto *colon = reinterpret_cast<const char *>(
+    memchr(begin, ':', size_t(end - begin)));
+  if (colon == nullptr) {
+    return;
+  }
+
+  // `branch`, `call` and function instance headers have no line number
+  const char *cursor = skip_space(colon + 1);
+  const char *const number_begin = cursor;
+  const u32 line_number = parse_number(cursor);
+  if (cursor == number_begin || cursor == end || *cursor != ':') {
+    return;
+  }
+  const char *const text = cursor + 1;
+
+  const char *const intro = skip_space(begin);
+  if (intro == colon) {
+    return;
+  }
+
+  if (*intro == '-') {
+    constexpr size_t source_length = sizeof("Source:") - 1;
+    if (
+      line_number == 0 && size_t(end - text) > source_length
+      && memcmp(text, "Source:", source_length) == 0) {
+      callback(Record().set_type(Record::Type::source).set_value(
+        var::StringView(text + source_length, size_t(end - text) - source_length)));
+    }
+    return;
+  }
+
+  u64 execution_count = 0;
+  if (*intro >= '0' && *intro <= '9') {
+    const char *count_cursor = intro;
+    execution_count = parse_number(count_cursor);
+  } else if (
+    *intro != '#' && *intro != '=' && *intro != '$' && *intro != '%') {
+    return;
+  }
+
+  callback(Record()
+             .set_type(Record::Type::line)
+             .set_line_number(line_number)
+             .set_execution_count(execution_count));
+}
+
+GcovAggregate &GcovAggregate::add(const var::StringList &path_list) {
+  APP_CALL_GRAPH_TRACE_CLASS_FUNCTION("GcovAggregate");
+  for (const auto &path : path_list) {
+    add_file(path);
+    if (is_error()) {
+      SL_PRINTER_TRACE("failed to read " + path);
+      API_RESET_ERROR();
+    }
+  }
+  return *this;
+}
+
+void GcovAggregate::add_file(const var::StringView path) {
+  // files without a `Source:` header are merged by their own path
+  size_t source_index = get_source(path);
+  size_t function_index = static_cast<size_t>(-1);
 
-  while ((line = data_file.get_line()).is_empty() == false) {
-    size_t first_colon_position = line.string_view().find(":");
+  GcovParser::stream_file(path, [&](const GcovParser::Record &record) {
+    using Type = GcovParser::Record::Type;
+    auto &source = m_source_list.at(source_index);
 
-    if (first_colon_position != String::npos) {
-      StringView line_intro
-        = line.string_view().get_substring_with_length(first_colon_position);
+    switch (record.type()) {
+    case Type::source:
+      source_index = get_source(record.value());
+      function_index = static_cast<size_t>(-1);
+      return;
+
+    case Type::function: {
+      function_index = source.function_list.count();
+      for (const auto index : api::Index(source.function_list.count())) {
+        if (source.function_list.at(index).name == record.value()) {
+          function_index = index;
+          break;
+        }
+      }
+      if (function_index == source.function_list.count()) {
+        Function function;
+        function.name = var::String(record.value());
+        source.function_list.push_back(function);
+      }
+      source.function_list.at(function_index).called
+        += record.execution_count();
+      return;
+    }
 
-      if (line_intro.find("-") != String::npos) {
-        // this line is not considered
-      } else {
+    case Type::line: {
+      const u32 line_number = record.line_number();
+      while (source.hit_list.count() <= line_number) {
+        source.hit_list.push_back(not_executable());
+      }
+      auto &hits = source.hit_list.at(line_number);
+      hits = (hits == not_executable() ? 0 : hits) + record.execution_count();
 
-        line_count++;
-        if (line_intro.find("#####") == String::npos) {
-          // this line was executed
-          line_execution_count++;
+      // lines after a function header belong to it until the next header
+      if (function_index < source.function_list.count()) {
+        auto &function = source.function_list.at(function_index);
+        if (function.first_line == 0 || line_number < function.first_line) {
+          function.first_line = line_number;
+        }
+        if (line_number > function.last_line) {
+          function.last_line = line_number;
         }
       }
+      return;
+    }
+    }
+  });
+}
+
+size_t GcovAggregate::get_source(const var::StringView path) {
+  for (const auto index : api::Index(m_source_list.count())) {
+    if (m_source_list.at(index).path == path) {
+      return index;
     }
   }
+  Source source;
+  source.path = var::String(path);
+  m_source_list.push_back(source);
+  return m_source_list.count() - 1;
+}
 
-  return GcovFileCoverage(path)
-    .set_line_count(line_count)
-    .set_line_execution_count(line_execution_count);
+json::JsonObject GcovAggregate::to_object() const {
+  json::JsonObject source_object;
+  u32 line_count = 0;
+  u32 line_execution_count = 0;
+  u32 function_count = 0;
+  u32 function_execution_count = 0;
+
+  for (const auto &source : m_source_list) {
+    const auto count = count_range(source, 0, source.hit_list.count());
+    if (count.line_count() == 0 && source.function_list.count() == 0) {
+      continue;
+    }
+
+    json::JsonObject function_object;
+    for (const auto &function : source.function_list) {
+      const auto function_count_range
+        = count_range(source, function.first_line, function.last_line + 1);
+      function_object.insert(
+        function.name,
+        json::JsonObject()
+          .insert("called", json::JsonInteger(function.called))
+          .insert("lineCount", json::JsonInteger(function_count_range.line_count()))
+          .insert(
+            "lineExecutionCount",
+            json::JsonInteger(function_count_range.line_execution_count()))
+          .insert("percent", json::JsonReal(get_percent(function_count_range))));
+      function_count++;
+      if (function.called) {
+        function_execution_count++;
+      }
+    }
+
+    line_count += count.line_count();
+    line_execution_count += count.line_execution_count();
+    source_object.insert(
+      source.path,
+      json::JsonObject()
+        .insert("lineCount", json::JsonInteger(count.line_count()))
+        .insert(
+          "lineExecutionCount",
+          json::JsonInteger(count.line_execution_count()))
+        .insert("percent", json::JsonReal(get_percent(count)))
+        .insert("functions", function_object));
+  }
+
+  return json::JsonObject()
+    .insert("lineCount", json::JsonInteger(line_count))
+    .insert("lineExecutionCount", json::JsonInteger(line_execution_count))
+    .insert(
+      "percent",
+      json::JsonReal(get_percent(
+        GcovParser::Count().set_line_count(line_count).set_line_execution_count(
+          line_execution_count))))
+    .insert("functionCount", json::JsonInteger(function_count))
+    .insert(
+      "functionExecutionCount",
+      json::JsonInteger(function_execution_count))
+    .insert("sources", source_object);
+}
+
+json::JsonObject GcovAggregate::get_delta(
+  const json::JsonObject &summary,
+  const json::JsonObject &baseline) {
+
+  const auto get_entry_delta = [](
+                                 const json::JsonObject &current,
+                                 const json::JsonObject &reference) {
+    if (reference.is_empty()) {
+      return json::JsonObject().insert("new", json::JsonTrue());
+    }
+    return json::JsonObject().insert(
+      "percentDelta",
+      json::JsonReal(
+        current.at("percent").to_real() - reference.at("percent").to_real()));
+  };
+
+  json::JsonObject source_delta_object;
+  const auto source_object = summary.at("sources").to_object();
+  const auto baseline_source_object = baseline.at("sources").to_object();
+  for (const auto &path : source_object.get_key_list()) {
+    const auto source = source_object.at(path).to_object();
+    const auto baseline_source = baseline_source_object.at(path).to_object();
+
+    json::JsonObject function_delta_object;
+    const auto function_object = source.at("functions").to_object();
+    const auto baseline_function_object
+      = baseline_source.at("functions").to_object();
+    for (const auto &name : function_object.get_key_list()) {
+      const auto delta = get_entry_delta(
+        function_object.at(name).to_object(),
+        baseline_function_object.at(name).to_object());
+      if (delta.at("new").is_valid() || delta.at("percentDelta").to_real() != 0.0f) {
+        function_delta_object.insert(name, delta);
+      }
+    }
+
+    auto delta = get_entry_delta(source, baseline_source);
+    if (
+      delta.at("new").is_valid() || delta.at("percentDelta").to_real() != 0.0f
+      || !function_delta_object.get_key_list().is_empty()) {
+      source_delta_object.insert(
+        path,
+        delta.insert("functions", function_delta_object));
+    }
+  }
+
+  return get_entry_delta(summary, baseline)
+    .insert("sources", source_delta_object);
+}
+
+GcovParser::Count GcovAggregate::count_range(
+  const Source &source,
+  u32 first_line,
+  u32 last_line) {
+  u32 line_count = 0;
+  u32 line_execution_count = 0;
+  for (u32 line = first_line; line < last_line && line < source.hit_list.count();
+       line++) {
+    const auto hits = source.hit_list.at(line);
+    if (hits != not_executable()) {
+      line_count++;
+      if (hits) {
+        line_execution_count++;
+      }
+    }
+  }
+  return GcovParser::Count().set_line_count(line_count).set_line_execution_count(
+    line_execution_count);
+}
+
+float GcovAggregate::get_percent(const GcovParser::Count &count) {
+  return count.line_count()
+           ? count.line_execution_count() * 100.0f / count.line_count()
+           : 0.0f;
 }
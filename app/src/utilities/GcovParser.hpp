@@ -32,28 +32,10 @@ public:
     lineExecutionCount,
     line_execution_count);
 
-private:
-  friend class GcovParser;
-  GcovCoverage &calculate_line_count() {
-    u32 line_count = 0;
-    var::Vector<GcovFileCoverage> list = source_list();
-    for (const GcovFileCoverage &file_coverage : list) {
-      line_count += file_coverage.get_line_count();
-    }
-    set_line_count(line_count);
-    return *this;
-  }
-  GcovCoverage &calculate_line_execution_count() {
-    u32 line_execution_count = 0;
-    var::Vector<GcovFileCoverage> list = source_list();
-    for (const GcovFileCoverage &file_coverage : list) {
-      line_execution_count += file_coverage.get_line_execution_count();
-    }
-    set_line_execution_count(line_execution_count);
-    return *this;
-  }
 };
 
+#include <functional>
+
 #include "../App.hpp"
 
 class GcovParser : public AppAccess {
@@ -62,8 +44,100 @@ public:
 
   GcovCoverage parse(const var::StringList &path_list);
 
+  // line counts for a single `.gcov` file
+  class Count {
+    API_AF(Count, u32, line_count, 0);
+    API_AF(Count, u32, line_execution_count, 0);
+  };
+
+  // one line of `.gcov` output that carries coverage information
+  class Record {
+  public:
+    enum class Type {
+      // `-: 0:Source:<path>` header
+      source,
+      // executable source line
+      line,
+      // `function <name> called <count> ...` (written by `gcov -b`)
+      function
+    };
+
+  private:
+    API_AF(Record, Type, type, Type::line);
+    API_AF(Record, u32, line_number, 0);
+    // hits for a line, calls for a function
+    API_AF(Record, u64, execution_count, 0);
+    // source path or function name (valid during the callback only)
+    API_AC(Record, var::StringView, value);
+  };
+
+  using RecordCallback = std::function<void(const Record &record)>;
+
+  // reads `path` a page at a time so memory use doesn't grow with the file
+  static void
+  stream_file(const var::StringView path, const RecordCallback &callback);
+
+  // scans `.gcov` output in place (no per-line allocation)
+  static void scan(const var::View buffer, const RecordCallback &callback);
+  static Count count_lines(const var::View buffer);
+
+  // zero uses ThreadPool::default_thread_count()
+  API_AF(GcovParser, size_t, thread_count, 0);
+
+private:
+  static Count parse_file(const StringView path);
+  static void scan_line(
+    const char *begin,
+    const char *end,
+    const RecordCallback &callback);
+};
+
+// Merges the line and function hit counts of many `.gcov` sets (test runs,
+// devices) by source file. Lines are matched by number and hit counts are
+// summed, so a line counts as executed if any run executed it. The summary
+// can be saved as a baseline and later summaries compared against it.
+class GcovAggregate : public AppAccess {
+public:
+  GcovAggregate &add(const var::StringList &path_list);
+
+  u32 source_count() const { return m_source_list.count(); }
+
+  // `{lineCount, lineExecutionCount, percent, functionCount,
+  // functionExecutionCount, sources: {<path>: {..., functions: {<name>:
+  // {called, lineCount, lineExecutionCount, percent}}}}}`
+  json::JsonObject to_object() const;
+
+  // `percentDelta` for the totals and for every source and function whose
+  // percent covered differs from `baseline` (entries missing from the
+  // baseline are marked `new`)
+  static json::JsonObject
+  get_delta(const json::JsonObject &summary, const json::JsonObject &baseline);
+
 private:
-  GcovFileCoverage parse_file(const StringView path);
+  static constexpr u64 not_executable() { return static_cast<u64>(-1); }
+
+  struct Function {
+    var::String name;
+    u64 called = 0;
+    u32 first_line = 0;
+    u32 last_line = 0;
+  };
+
+  struct Source {
+    var::String path;
+    // indexed by line number
+    var::Vector<u64> hit_list;
+    var::Vector<Function> function_list;
+  };
+
+  var::Vector<Source> m_source_list;
+
+  void add_file(const var::StringView path);
+  size_t get_source(const var::StringView path);
+
+  static GcovParser::Count
+  count_range(const Source &source, u32 first_line, u32 last_line);
+  static float get_percent(const GcovParser::Count &count);
 };
 
 #endif // GCOVPARSER_HPP
@@ -0,0 +1,281 @@
+#include <chrono.hpp>
+#include <sos.hpp>
+#include <thread.hpp>
+
+#include "ImagePipeline.hpp"
+
+ImagePipeline::Result
+ImagePipeline::install(hal::Flash &flash_device, const Options &options) {
+  APP_CALL_GRAPH_TRACE_CLASS_FUNCTION("ImagePipeline");
+
+  chrono::ClockTimer total_timer;
+  total_timer.start();
+
+  fs::File image_file(options.image_path());
+  if (is_error()) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      Result(),
+      "failed to open the OS image " | options.image_path());
+  }
+
+  const u32 image_size = image_file.size();
+  const u32 total_size = image_size + get_trailer_size(options);
+  const auto &layout = options.layout();
+  if (
+    layout.count() == 0
+    || layout.back().offset() + layout.back().size() < total_size) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      Result(),
+      "the image does not fit on the flash device");
+  }
+
+  struct Context {
+    const Options *options = nullptr;
+    const fs::File *image_file = nullptr;
+    u32 image_size = 0;
+    Mutex mutex;
+    var::Queue<Chunk> queue;
+    bool is_done = false;
+    bool is_abort = false;
+    var::String error_message;
+    Timing timing;
+    var::GeneralString hash;
+    var::GeneralString signature;
+
+    bool is_aborted() {
+      Mutex::Guard mg(mutex);
+      return is_abort;
+    }
+
+    void finish(const var::StringView message = var::StringView()) {
+      Mutex::Guard mg(mutex);
+      error_message = var::String(message);
+      is_done = true;
+    }
+
+    void push(Chunk &&chunk) {
+      // wait for the writer to make room
+      while (true) {
+        {
+          Mutex::Guard mg(mutex);
+          if (is_abort || queue.count() < options->queue_depth()) {
+            queue.push(std::move(chunk));
+            return;
+          }
+        }
+        chrono::wait(1_milliseconds);
+      }
+    }
+  };
+
+  Context context;
+  context.options = &options;
+  context.image_file = &image_file;
+  context.image_size = image_size;
+
+  Thread worker_thread(
+    Thread::Attributes().set_detach_state(Thread::DetachState::joinable),
+    Thread::Construct().set_argument(&context).set_function(
+      [](void *args) -> void * {
+        auto *context = reinterpret_cast<Context *>(args);
+        const auto &options = *context->options;
+        auto &timing = context->timing;
+
+        // the signature covers everything written before it
+        const bool is_sign = options.digital_signature_algorithm() != nullptr;
+        const bool is_content_hash = is_sign && options.is_append_hash();
+        crypto::Sha256 image_hash;
+        crypto::Sha256 content_hash;
+
+        chrono::ClockTimer stage_timer;
+        for (const auto &sector : options.layout()) {
+          if (sector.offset() >= context->image_size || context->is_aborted()) {
+            break;
+          }
+
+          const u32 size = sector.offset() + sector.size() > context->image_size
+                             ? context->image_size - sector.offset()
+                             : sector.size();
+
+          stage_timer.restart();
+          var::Data data(size);
+          context->image_file->seek(sector.offset()).read(data);
+          timing.set_read(timing.read() + stage_timer.microseconds());
+
+          stage_timer.restart();
+          image_hash.update(data);
+          if (is_content_hash) {
+            content_hash.update(data);
+          }
+          timing.set_hash(timing.hash() + stage_timer.microseconds());
+
+          if (is_error()) {
+            context->finish("failed to read the OS image");
+            API_RESET_ERROR();
+            return nullptr;
+          }
+
+          context->push(
+            Chunk().set_offset(sector.offset()).set_data(std::move(data)));
+        }
+
+        fs::DataFile trailer;
+        const auto hash_string = image_hash.to_string();
+        context->hash = var::GeneralString(hash_string.string_view());
+        if (options.is_append_hash()) {
+          const crypto::Sha256::Hash hash_value
+            = crypto::Sha256::from_string(hash_string);
+          trailer.write(var::View(hash_value));
+          if (is_content_hash) {
+            content_hash.update(var::View(hash_value));
+          }
+        }
+
+        if (is_sign) {
+          stage_timer.restart();
+          const crypto::Sha256::Hash sign_value = crypto::Sha256::from_string(
+            is_content_hash ? content_hash.to_string() : hash_string);
+          const auto signature
+            = options.digital_signature_algorithm()->sign(sign_value);
+          sos::Auth::append(trailer, signature);
+          context->signature
+            = var::GeneralString(signature.to_string().string_view());
+          timing.set_sign(timing.sign() + stage_timer.microseconds());
+        }
+
+        if (is_error()) {
+          context->finish("failed to sign the OS image");
+          API_RESET_ERROR();
+          return nullptr;
+        }
+
+        context->push(Chunk()
+                        .set_offset(context->image_size)
+                        .set_data(trailer.data())
+                        .set_last());
+        context->finish();
+        return nullptr;
+      }));
+
+  Timing timing;
+  chrono::ClockTimer stage_timer;
+  size_t erase_index = 0;
+  u32 page_count = 0;
+  u32 write_offset = 0;
+  const auto *progress_callback = options.progress_callback();
+  if (progress_callback) {
+    progress_callback->update(0, int(total_size));
+  }
+
+  while (is_success()) {
+    Chunk chunk;
+    bool is_available = false;
+    bool is_done = false;
+    {
+      Mutex::Guard mg(context.mutex);
+      if (context.queue.count()) {
+        chunk = std::move(context.queue.front());
+        context.queue.pop();
+        is_available = true;
+      } else {
+        is_done = context.is_done;
+      }
+    }
+
+    if (!is_available) {
+      if (is_done) {
+        break;
+      }
+      stage_timer.restart();
+      chrono::wait(1_milliseconds);
+      timing.set_wait(timing.wait() + stage_timer.microseconds());
+      continue;
+    }
+
+    const u32 chunk_end = chunk.offset() + chunk.data().size();
+    write_offset = chunk.offset();
+
+    // pages are erased just before the first byte is written to them
+    stage_timer.restart();
+    while (erase_index < layout.count()
+           && layout.at(erase_index).offset() < chunk_end) {
+      flash_device.erase_page(layout.at(erase_index).page());
+      erase_index++;
+      page_count++;
+    }
+    timing.set_erase(timing.erase() + stage_timer.microseconds());
+
+    // the trailer can cross a page boundary so writes are split by page
+    stage_timer.restart();
+    u32 offset = chunk.offset();
+    for (const auto &sector : layout) {
+      const u32 sector_end = sector.offset() + sector.size();
+      if (offset >= chunk_end || is_error()) {
+        break;
+      }
+      if (sector_end <= offset) {
+        continue;
+      }
+      const u32 size = (chunk_end < sector_end ? chunk_end : sector_end) - offset;
+      flash_device.seek(options.start_address() + offset)
+        .write(var::View(
+          chunk.data().data_u8() + (offset - chunk.offset()),
+          size));
+      offset += size;
+    }
+    timing.set_write(timing.write() + stage_timer.microseconds());
+
+    if (is_error()) {
+      // the worker is released and joined below
+      break;
+    }
+
+    if (progress_callback) {
+      progress_callback->update(int(chunk_end), int(total_size));
+    }
+
+    if (chunk.is_last()) {
+      break;
+    }
+  }
+
+  {
+    // releases the worker if the writer stopped early
+    Mutex::Guard mg(context.mutex);
+    context.is_abort = true;
+  }
+  worker_thread.join();
+
+  if (progress_callback) {
+    progress_callback->update(0, 0);
+  }
+
+  if (!context.error_message.is_empty()) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(Result(), context.error_message);
+  }
+
+  if (is_error()) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      Result(),
+      "failed to write the image at offset " | NumberString(write_offset));
+  }
+
+  total_timer.stop();
+  return Result()
+    .set_timing(timing.set_read(context.timing.read())
+                  .set_hash(context.timing.hash())
+                  .set_sign(context.timing.sign())
+                  .set_total(total_timer.microseconds()))
+    .set_image_size(image_size)
+    .set_trailer_size(total_size - image_size)
+    .set_page_count(page_count)
+    .set_hash(context.hash)
+    .set_signature(context.signature);
+}
+
+u32 ImagePipeline::get_trailer_size(const Options &options) {
+  return (options.is_append_hash() ? u32(sizeof(crypto::Sha256::Hash)) : 0)
+         + (options.digital_signature_algorithm()
+              ? u32(sizeof(auth_signature_marker_t))
+              : 0);
+}
@@ -0,0 +1,78 @@
+#ifndef UTILITIES_IMAGEPIPELINE_HPP
+#define UTILITIES_IMAGEPIPELINE_HPP
+
+#include <crypto.hpp>
+#include <fs.hpp>
+#include <hal/Flash.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+#include "SectorImage.hpp"
+
+// Writes an OS image to a flash device while it is still being prepared.
+//
+// A worker thread reads the image a page at a time and feeds the hashes,
+// handing each page to the calling thread which erases and writes it. The
+// trailer (SHA256 hash and/or signature marker) depends on every byte of the
+// image so it is built and written last. Every stage is timed so the output
+// shows where the install time goes.
+class ImagePipeline : public AppAccess {
+public:
+  class Options {
+    API_AC(Options, var::PathString, image_path);
+    // address of the first page in `layout`
+    API_AF(Options, u32, start_address, 0);
+    // device pages (offsets from `start_address`)
+    API_AC(Options, SectorImage::SectorList, layout);
+    API_AB(Options, append_hash, false);
+    // signs the image (and hash) if not null
+    API_AF(
+      Options,
+      crypto::DigitalSignatureAlgorithm *,
+      digital_signature_algorithm,
+      nullptr);
+    // pages handed over but not yet written
+    API_AF(Options, u32, queue_depth, 4);
+    API_AF(
+      Options,
+      const api::ProgressCallback *,
+      progress_callback,
+      nullptr);
+  };
+
+  // microseconds spent in each stage (read, hash and sign run on the worker
+  // thread while erase and write run on the calling thread)
+  class Timing {
+    API_AF(Timing, u64, read, 0);
+    API_AF(Timing, u64, hash, 0);
+    API_AF(Timing, u64, sign, 0);
+    API_AF(Timing, u64, erase, 0);
+    API_AF(Timing, u64, write, 0);
+    // the writer had no page to write
+    API_AF(Timing, u64, wait, 0);
+    API_AF(Timing, u64, total, 0);
+  };
+
+  class Result {
+    API_AC(Result, Timing, timing);
+    API_AF(Result, u32, image_size, 0);
+    API_AF(Result, u32, trailer_size, 0);
+    API_AF(Result, u32, page_count, 0);
+    API_AC(Result, var::GeneralString, hash);
+    API_AC(Result, var::GeneralString, signature);
+  };
+
+  static Result install(hal::Flash &flash_device, const Options &options);
+
+private:
+  class Chunk {
+    API_AF(Chunk, u32, offset, 0);
+    API_AC(Chunk, var::Data, data);
+    // the trailer is the last chunk
+    API_AB(Chunk, last, false);
+  };
+
+  static u32 get_trailer_size(const Options &options);
+};
+
+#endif // UTILITIES_IMAGEPIPELINE_HPP
@@ -0,0 +1,253 @@
+#include <chrono.hpp>
+#include <crypto.hpp>
+
+#include "settings/FilePathSettings.hpp"
+
+#include "Inventory.hpp"
+
+Inventory::Inventory(const var::StringView name) {
+  m_path = FilePathSettings::inventory_directory() / name & ".json";
+  if (!fs::FileSystem().exists(m_path)) {
+    return;
+  }
+
+  api::ErrorScope error_scope;
+  const auto object = json::JsonDocument().load(fs::File(m_path)).to_object();
+  if (is_success()) {
+    m_documents = object.at("documents").to_object();
+    m_last_sync = object.at("lastSync").to_integer();
+  }
+}
+
+bool Inventory::execute(const Options &options, const Fetch &fetch) {
+  for (const auto &id : options.remove().split("?")) {
+    if (!id.is_empty()) {
+      remove(id);
+    }
+  }
+
+  ResultList result_list;
+  if (!options.is_local()) {
+    var::StringList identifier_list;
+    for (const auto &id : options.identifier().split("?")) {
+      identifier_list.push_back(var::String(id));
+    }
+
+    result_list = sync(
+      Sync()
+        .set_identifier_list(identifier_list)
+        .set_maximum_age(options.maximum_age())
+        .set_refresh(options.is_refresh()),
+      fetch);
+  }
+
+  save();
+  if (is_error()) {
+    APP_RETURN_ASSIGN_ERROR("failed to save `" + path() + "`");
+  }
+
+  if (!print(result_list, options.query())) {
+    APP_RETURN_ASSIGN_ERROR("some documents failed to sync");
+  }
+
+  // a local query doesn't pull anything
+  if (!options.is_local() && result_list.count() < get_id_list().count()) {
+    APP_RETURN_ASSIGN_ERROR("sync was interrupted");
+  }
+
+  return true;
+}
+
+Inventory::ResultList
+Inventory::sync(const Sync &options, const Fetch &fetch) {
+  var::StringList id_list = get_id_list();
+  for (const auto &id : options.identifier_list()) {
+    if (!id.is_empty() && m_documents.at(id).to_object().is_empty()) {
+      id_list.push_back(id);
+    }
+  }
+
+  ResultList result;
+  result.reserve(id_list.count());
+  for (const auto &id : id_list) {
+    if (session_settings().is_interrupted()) {
+      break;
+    }
+
+    const auto previous = m_documents.at(id).to_object();
+    const u32 synced = previous.at("synced").to_integer();
+    const u32 now = get_time();
+    if (
+      !options.is_refresh() && synced
+      && now - synced < options.maximum_age()) {
+      result.push_back(Result().set_id(id).set_status("fresh"));
+      continue;
+    }
+
+    SL_PRINTER_TRACE("pull " + id);
+    const auto document = fetch(id);
+    if (is_error()) {
+      result.push_back(
+        Result().set_id(id).set_status("failed").set_error_message(
+          api::ExecutionContext::error().message()));
+      API_RESET_ERROR();
+      continue;
+    }
+
+    const auto hash = get_hash(document);
+    const auto status = previous.is_empty() ? "added"
+                        : previous.at("hash").to_string_view()
+                              == hash.string_view()
+                          ? "unchanged"
+                          : "changed";
+
+    m_documents.insert(
+      id,
+      json::JsonObject()
+        .insert("synced", json::JsonInteger(now))
+        .insert("hash", json::JsonString(hash.string_view()))
+        .insert("document", document));
+
+    result.push_back(Result().set_id(id).set_status(status));
+  }
+
+  m_last_sync = get_time();
+  return result;
+}
+
+Inventory &Inventory::remove(const var::StringView id) {
+  json::JsonObject result;
+  for (const auto &key : m_documents.get_key_list()) {
+    if (key != id) {
+      result.insert(key, m_documents.at(key));
+    }
+  }
+  m_documents = result;
+  return *this;
+}
+
+const Inventory &Inventory::save() const {
+  const auto directory = FilePathSettings::inventory_directory();
+  if (!fs::FileSystem().directory_exists(directory)) {
+    fs::FileSystem().create_directory(directory, fs::Dir::IsRecursive::yes);
+  }
+
+  json::JsonDocument().save(
+    json::JsonObject()
+      .insert("lastSync", json::JsonInteger(m_last_sync))
+      .insert("documents", m_documents),
+    fs::File(fs::File::IsOverwrite::yes, m_path));
+  return *this;
+}
+
+var::StringList Inventory::get_id_list() const {
+  var::StringList result;
+  for (const auto &key : m_documents.get_key_list()) {
+    result.push_back(var::String(key));
+  }
+  return result;
+}
+
+json::JsonObject Inventory::get_document(const var::StringView id) const {
+  return m_documents.at(id).to_object().at("document").to_object();
+}
+
+u32 Inventory::get_synced(const var::StringView id) const {
+  return m_documents.at(id).to_object().at("synced").to_integer();
+}
+
+var::String
+Inventory::get_value(const var::StringView id, const var::StringView key) const {
+  json::JsonValue value = get_document(id);
+  for (const auto &name : key.split(".")) {
+    if (!value.is_object()) {
+      return var::String();
+    }
+    value = value.to_object().at(name);
+  }
+
+  if (!value.is_valid() || value.is_object() || value.is_array()) {
+    return var::String();
+  }
+  return value.to_string();
+}
+
+var::StringList
+Inventory::query(const var::StringView key, const var::StringView value) const {
+  var::StringList result;
+  for (const auto &id : m_documents.get_key_list()) {
+    if (get_value(id, key) == value) {
+      result.push_back(var::String(id));
+    }
+  }
+  return result;
+}
+
+bool Inventory::print(
+  const ResultList &result_list,
+  const var::StringView query) const {
+  u32 pulled_count = 0;
+  u32 changed_count = 0;
+  u32 fail_count = 0;
+
+  if (!result_list.is_empty()) {
+    // fresh entries are left out so a large snapshot doesn't flood the output
+    printer().start_table(StringViewList({"id", "status", "error"}));
+    for (const auto &result : result_list) {
+      if (result.status() == "fresh") {
+        continue;
+      }
+      if (result.status() == "failed") {
+        fail_count++;
+      } else {
+        pulled_count++;
+        if (result.status() != "unchanged") {
+          changed_count++;
+        }
+      }
+      printer().append_table_row(StringViewList(
+        {result.id(), result.status(), result.error_message()}));
+    }
+    printer().finish_table(printer::Printer::Level::info);
+  }
+
+  {
+    Printer::Object po(printer().active_printer(), "inventory");
+    printer()
+      .key("path", path())
+      .key("documents", NumberString(m_documents.get_key_list().count()))
+      .key("lastSync", NumberString(last_sync()))
+      .key("pulled", NumberString(pulled_count))
+      .key("changed", NumberString(changed_count))
+      .key("failed", NumberString(fail_count));
+  }
+
+  if (!query.is_empty()) {
+    const auto offset = query.find("=");
+    const auto key = query.get_substring_with_length(offset);
+    const auto value = offset == var::StringView::npos
+                         ? var::StringView()
+                         : query.get_substring_at_position(offset + 1);
+
+    const auto id_list = this->query(key, value);
+    printer().start_table(StringViewList({"id", key, "synced"}));
+    for (const auto &id : id_list) {
+      printer().append_table_row(StringViewList(
+        {id, get_value(id, key), NumberString(get_synced(id))}));
+    }
+    printer().finish_table(printer::Printer::Level::info);
+    printer().key("matches", NumberString(id_list.count()));
+  }
+
+  return fail_count == 0;
+}
+
+var::GeneralString Inventory::get_hash(const json::JsonObject &document) {
+  const auto content = json::JsonDocument().stringify(document);
+  return var::View(crypto::Sha256::get_hash(fs::ViewFile(var::View(content))))
+    .to_string<var::GeneralString>();
+}
+
+u32 Inventory::get_time() {
+  return chrono::DateTime::get_system_time().ctime();
+}
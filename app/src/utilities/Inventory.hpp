@@ -0,0 +1,92 @@
+#ifndef UTILITIES_INVENTORY_HPP
+#define UTILITIES_INVENTORY_HPP
+
+#include <functional>
+
+#include <fs.hpp>
+#include <json.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+
+// Host-side snapshot of cloud documents used by `thing.sync` and
+// `hardware.sync`.
+//
+// Each document is stored with the time it was last pulled and a hash of its
+// contents. A sync pulls the requested ids plus every id already in the
+// snapshot but skips documents pulled less than `maximum_age` seconds ago, so
+// repeated syncs of a large fleet only touch stale entries. Queries run
+// against the snapshot without the cloud.
+//
+// The cloud has no "changed since" query and no collection listing, so only
+// ids that were given (or are already in the snapshot) are pulled, one at a
+// time.
+class Inventory : public AppAccess {
+public:
+  // returns the document for `id` (assigns an error if it can't be pulled)
+  using Fetch = std::function<json::JsonObject(const var::StringView id)>;
+
+  class Sync {
+    API_AC(Sync, var::StringList, identifier_list);
+    API_AF(Sync, u32, maximum_age, 0);
+    API_AB(Sync, refresh, false);
+  };
+
+  // everything `thing.sync` and `hardware.sync` accept
+  class Options {
+    API_AC(Options, var::StringView, identifier);
+    API_AC(Options, var::StringView, remove);
+    API_AC(Options, var::StringView, query);
+    API_AF(Options, u32, maximum_age, 0);
+    API_AB(Options, refresh, false);
+    API_AB(Options, local, false);
+  };
+
+  class Result {
+    API_AC(Result, var::KeyString, id);
+    // added, changed, unchanged, fresh (not pulled) or failed
+    API_AC(Result, var::KeyString, status);
+    API_AC(Result, var::String, error_message);
+  };
+
+  using ResultList = var::Vector<Result>;
+
+  explicit Inventory(const var::StringView name);
+
+  // removes, pulls (unless local), saves and prints -- assigns an error if a
+  // pull failed or the sync was interrupted
+  bool execute(const Options &options, const Fetch &fetch);
+
+  ResultList sync(const Sync &options, const Fetch &fetch);
+
+  Inventory &remove(const var::StringView id);
+  const Inventory &save() const;
+
+  var::StringList get_id_list() const;
+  json::JsonObject get_document(const var::StringView id) const;
+  u32 get_synced(const var::StringView id) const;
+
+  // value at a dot-separated `key` (for example `os.version`)
+  var::String get_value(const var::StringView id, const var::StringView key) const;
+
+  // ids whose value at `key` equals `value`
+  var::StringList
+  query(const var::StringView key, const var::StringView value) const;
+
+  // prints the pulled entries, a summary and the ids matching `query`
+  // (`<key>=<value>`) -- returns false if any pull failed
+  bool print(const ResultList &result_list, const var::StringView query) const;
+
+  u32 last_sync() const { return m_last_sync; }
+  const var::PathString &path() const { return m_path; }
+
+private:
+  var::PathString m_path;
+  json::JsonObject m_documents;
+  u32 m_last_sync = 0;
+
+  static var::GeneralString get_hash(const json::JsonObject &document);
+  static u32 get_time();
+};
+
+#endif // UTILITIES_INVENTORY_HPP
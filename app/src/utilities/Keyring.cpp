@@ -0,0 +1,222 @@
+#include <chrono.hpp>
+
+#include "settings/FilePathSettings.hpp"
+
+#include "Keyring.hpp"
+
+bool Keyring::is_cached(const var::StringView id) {
+  return is_valid_id(id) && fs::FileSystem().exists(get_key_path(id))
+         && !load_index().at(id).to_object().is_empty();
+}
+
+Keyring::Entry Keyring::get_entry(const var::StringView id) {
+  return to_entry(id, load_index().at(id).to_object());
+}
+
+Keyring::EntryList Keyring::get_entry_list() {
+  const auto index = load_index();
+  EntryList result;
+  for (const auto &key : index.get_key_list()) {
+    result.push_back(to_entry(key, index.at(key).to_object()));
+  }
+  return result;
+}
+
+service::Keys Keyring::load(const var::StringView id) {
+  if (!is_cached(id)) {
+    API_RETURN_VALUE_ASSIGN_ERROR(
+      service::Keys(),
+      "key is not in the keyring",
+      ENOENT);
+  }
+  return service::Keys().import_file(fs::File(get_key_path(id)));
+}
+
+service::Keys
+Keyring::get_keys(const var::StringView id, u32 maximum_age) {
+  if (!id.is_empty() && !is_valid_id(id)) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      service::Keys(),
+      "`" | id | "` is not a valid key id");
+  }
+
+  if (is_cached(id)) {
+    const auto entry = get_entry(id);
+    const u32 now = get_time();
+    const u32 age = now > entry.cached() ? now - entry.cached() : 0;
+    if (entry.is_revoked()) {
+      printer().key("keySource", "keyring");
+      APP_RETURN_VALUE_ASSIGN_ERROR(
+        service::Keys(),
+        "the keys for id `" | id | "` were revoked");
+    }
+
+    const bool is_stale = age > maximum_age;
+    const bool is_online = [&]() {
+      if (!is_stale) {
+        return false;
+      }
+      // a stale entry is still used offline
+      api::ErrorScope error_scope;
+      return is_cloud_ready(
+        IsForceDownloadSettings::no,
+        IsSuppressError::yes);
+    }();
+
+    if (!is_online) {
+      service::Keys result = load(id);
+      if (is_success() && result.is_valid()) {
+        printer().key("keySource", "keyring").key("keyAge", NumberString(age));
+        if (is_stale) {
+          printer().warning(
+            "the cloud is not available to check keys that are "
+            | NumberString(age) | " seconds old");
+        }
+        return result;
+      }
+
+      // a damaged entry is downloaded again
+      SL_PRINTER_TRACE("failed to load keyring entry for " | id);
+      API_RESET_ERROR();
+      if (is_cloud_ready() == false) {
+        APP_RETURN_VALUE_ASSIGN_ERROR(
+          service::Keys(),
+          "failed to load the keys for `" | id | "` from the keyring");
+      }
+    } else {
+      SL_PRINTER_TRACE("revalidating keyring entry for " | id);
+    }
+  }
+
+  printer().key("keySource", "cloud").key("keyAge", "0");
+  service::Keys result(id);
+  if (result.is_valid() == false) {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      service::Keys(),
+      "the keys for id `" | id | "` do not exist");
+  }
+
+  if (is_error()) {
+    SL_PRINTER_TRACE("document traffic " + cloud_service().store().traffic());
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      service::Keys(),
+      "failed to download keys `" | id | "`");
+  }
+
+  if (id.is_empty() == false) {
+    // the keyring is an optimization: failing to write it is not an error
+    api::ErrorScope error_scope;
+    save(id, result);
+  }
+
+  if (result.get_status() == "revoked") {
+    APP_RETURN_VALUE_ASSIGN_ERROR(
+      service::Keys(),
+      "the keys for id `" | id | "` were revoked");
+  }
+
+  return result;
+}
+
+Keyring::Entry
+Keyring::save(const var::StringView id, const service::Keys &keys) {
+  const auto key_path = get_key_path(id);
+  if (is_error()) {
+    return Entry();
+  }
+
+  const auto directory = FilePathSettings::keyring_directory();
+  if (!fs::FileSystem().directory_exists(directory)) {
+    fs::FileSystem().create_directory(directory, fs::Dir::IsRecursive::yes);
+  }
+
+  keys.export_file(fs::File(fs::File::IsOverwrite::yes, key_path));
+  if (is_error()) {
+    return Entry();
+  }
+
+  auto index = load_index();
+  const auto previous = to_entry(id, index.at(id).to_object());
+  const auto now = get_time();
+  const auto status = keys.get_status();
+  const u32 revoked = status == "revoked"
+                        ? (previous.is_revoked() ? previous.revoked() : now)
+                        : 0;
+
+  index.insert(
+    id,
+    json::JsonObject()
+      .insert("status", json::JsonString(status))
+      .insert("cached", json::JsonInteger(now))
+      .insert("revoked", json::JsonInteger(revoked)));
+  save_index(index);
+
+  return Entry().set_id(id).set_status(status).set_cached(now).set_revoked(
+    revoked);
+}
+
+void Keyring::remove(const var::StringView id) {
+  const auto key_path = get_key_path(id);
+  if (is_error()) {
+    return;
+  }
+
+  if (fs::FileSystem().exists(key_path)) {
+    fs::FileSystem().remove(key_path);
+  }
+
+  const auto index = load_index();
+  json::JsonObject result;
+  for (const auto &key : index.get_key_list()) {
+    if (key != id) {
+      result.insert(key, index.at(key));
+    }
+  }
+  save_index(result);
+}
+
+bool Keyring::is_valid_id(const var::StringView id) {
+  return !id.is_empty() && id.find("/") == var::StringView::npos
+         && id.find("\\") == var::StringView::npos
+         && id.find("..") == var::StringView::npos && id != "keyring";
+}
+
+var::PathString Keyring::get_key_path(const var::StringView id) {
+  if (!is_valid_id(id)) {
+    API_RETURN_VALUE_ASSIGN_ERROR(
+      var::PathString(),
+      "invalid key id",
+      EINVAL);
+  }
+  return FilePathSettings::keyring_directory() / id & ".json";
+}
+
+json::JsonObject Keyring::load_index() {
+  const auto path = FilePathSettings::keyring_directory() / "keyring.json";
+  if (!fs::FileSystem().exists(path)) {
+    return json::JsonObject();
+  }
+
+  api::ErrorScope error_scope;
+  const auto result = json::JsonDocument().load(fs::File(path)).to_object();
+  return is_success() ? result : json::JsonObject();
+}
+
+void Keyring::save_index(const json::JsonObject &index) {
+  json::JsonDocument().save(
+    index,
+    fs::File(
+      fs::File::IsOverwrite::yes,
+      FilePathSettings::keyring_directory() / "keyring.json"));
+}
+
+Keyring::Entry
+Keyring::to_entry(const var::StringView id, const json::JsonObject &object) {
+  return Entry()
+    .set_id(id)
+    .set_status(object.at("status").to_string_view())
+    .set_cached(object.at("cached").to_integer())
+    .set_revoked(object.at("revoked").to_integer());
+}
+
+u32 Keyring::get_time() { return chrono::DateTime::get_system_time().ctime(); }
@@ -0,0 +1,72 @@
+#ifndef UTILITIES_KEYRING_HPP
+#define UTILITIES_KEYRING_HPP
+
+#include <fs.hpp>
+#include <json.hpp>
+#include <service.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+
+// Host-side copy of key documents so `keys.sign` and `keys.verify` don't
+// need the cloud on every run.
+//
+// Each key is stored as the exported document (public key plus the
+// encrypted private key material) in `<id>.json`. The index records when
+// each key was cached and when it was seen revoked. Entries older than the
+// maximum age are downloaded again when the cloud is reachable (and used as
+// they are when it isn't). `keys.cache:refresh` and sl changing the key
+// (revoke, remove) also refresh the entry.
+class Keyring : public AppAccess {
+public:
+  // seconds a cached key is used before it is checked against the cloud
+  static constexpr u32 default_maximum_age() { return 24 * 60 * 60; }
+
+  class Entry {
+  public:
+    bool is_revoked() const { return revoked() != 0; }
+
+  private:
+    API_AC(Entry, var::KeyString, id);
+    API_AC(Entry, var::KeyString, status);
+    API_AF(Entry, u32, cached, 0);
+    API_AF(Entry, u32, revoked, 0);
+  };
+
+  using EntryList = var::Vector<Entry>;
+
+  static bool is_cached(const var::StringView id);
+  static Entry get_entry(const var::StringView id);
+  static EntryList get_entry_list();
+
+  // loads the cached document (assigns an error if it is not cached)
+  static service::Keys load(const var::StringView id);
+
+  // keys from the keyring or, on a miss or an entry older than
+  // `maximum_age` while the cloud is reachable, downloaded from the cloud
+  // (and added to the keyring). Prints where the keys came from and their
+  // age. Assigns an error if the keys don't exist or have been revoked.
+  static service::Keys get_keys(
+    const var::StringView id,
+    u32 maximum_age = default_maximum_age());
+
+  // adds or replaces the document for `id`, keeping the first revocation
+  // time if the key was already revoked
+  static Entry save(const var::StringView id, const service::Keys &keys);
+  static void remove(const var::StringView id);
+
+  // ids are file names in the keyring directory: no path separators, no
+  // `..` and not `keyring` (the index)
+  static bool is_valid_id(const var::StringView id);
+
+  // assigns an error if `id` isn't valid
+  static var::PathString get_key_path(const var::StringView id);
+
+private:
+  static json::JsonObject load_index();
+  static void save_index(const json::JsonObject &index);
+  static Entry to_entry(const var::StringView id, const json::JsonObject &object);
+  static u32 get_time();
+};
+
+#endif // UTILITIES_KEYRING_HPP
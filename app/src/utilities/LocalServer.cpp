@@ -323,7 +323,7 @@ void LocalServer::respond_post_command(inet::HttpServer *self) {
     }
   }
 
-  if (printer().is_json()) {
+  if (printer().is_json() && !printer().is_ndjson()) {
 
     if (reply.length() && reply.front() == ',') {
       reply.pop_front();
@@ -337,7 +337,9 @@ void LocalServer::respond_post_command(inet::HttpServer *self) {
     .add_header_field("Connection", "close")
     .add_header_field(
       "Content-Type",
-      printer().is_json() ? "application/json" : "application/text")
+      printer().is_ndjson() ? "application/x-ndjson"
+      : printer().is_json() ? "application/json"
+                            : "application/text")
     .send(inet::Http::Response(self->http_version(), inet::Http::Status::ok))
     .send(ViewFile(reply));
 }
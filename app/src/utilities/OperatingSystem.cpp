@@ -19,6 +19,7 @@
 
 #include "../SlPrinter.hpp"
 #include "App.hpp"
+#include "CloudStandIn.hpp"
 #include "OperatingSystem.hpp"
 
 namespace {
@@ -275,10 +276,11 @@ PathString OperatingSystem::search_path(const var::StringView application) {
 }
 
 var::String OperatingSystem::download_file(
-  const inet::Url url,
+  const inet::Url requested_url,
   const sos::Link::File &destination_file,
   const api::ProgressCallback *progress_callback) {
   inet::Http::Status status;
+  const auto url = CloudStandIn::redirect(requested_url);
 
   // need to determine secure or not secure
   if (url.protocol() == inet::Url::Protocol::https) {
@@ -293,7 +295,7 @@ var::String OperatingSystem::download_file(
                .status();
   } else {
     status = inet::HttpClient()
-               .connect(url.domain_name())
+               .connect(url.domain_name(), url.port())
                .get(
                  url.path(),
                  inet::HttpClient::Get()
@@ -69,6 +69,7 @@ public:
   }
 
 private:
+  friend class SelfBench;
   static constexpr u32 packager_version = 0x00000100;
 
   API_AB(Packager, keep_temporary, false);
@@ -0,0 +1,131 @@
+#include <crypto.hpp>
+
+#include "SectorImage.hpp"
+
+SectorImage::SectorList
+SectorImage::create_layout(u32 image_size, u32 sector_size) {
+  SectorList result;
+  if (sector_size == 0) {
+    return result;
+  }
+
+  result.reserve((image_size + sector_size - 1) / sector_size);
+  for (u32 offset = 0; offset < image_size; offset += sector_size) {
+    result.push_back(Sector()
+                       .set_page(offset / sector_size)
+                       .set_offset(offset)
+                       .set_size(sector_size));
+  }
+  return result;
+}
+
+SectorImage::SectorList
+SectorImage::hash(const var::View image, const SectorList &layout) {
+  SectorList result;
+  result.reserve(layout.count());
+  for (const auto &sector : layout) {
+    if (sector.offset() >= image.size()) {
+      break;
+    }
+
+    const u32 size = sector.offset() + sector.size() > image.size()
+                       ? image.size() - sector.offset()
+                       : sector.size();
+    result.push_back(Sector(sector).set_size(size).set_hash(get_hash(
+      var::View(image.to_const_char() + sector.offset(), size))));
+  }
+  return result;
+}
+
+SectorImage::SectorList SectorImage::hash_device(
+  const fs::FileObject &device,
+  u32 start_address,
+  const SectorList &layout) {
+  SectorList result;
+  result.reserve(layout.count());
+  var::Data buffer;
+  for (const auto &sector : layout) {
+    buffer.resize(sector.size());
+    device.seek(start_address + sector.offset()).read(buffer);
+    if (is_error()) {
+      return SectorList();
+    }
+    result.push_back(Sector(sector).set_hash(get_hash(buffer)));
+  }
+  return result;
+}
+
+SectorImage::SectorList SectorImage::get_changed(
+  const SectorList &current,
+  const SectorList &reference) {
+  SectorList result;
+  for (const auto &sector : current) {
+    const auto is_same = [&]() {
+      for (const auto &entry : reference) {
+        if (entry.offset() == sector.offset()) {
+          return entry.size() == sector.size() && entry.hash() == sector.hash();
+        }
+      }
+      return false;
+    }();
+
+    if (!is_same) {
+      result.push_back(sector);
+    }
+  }
+  return result;
+}
+
+SectorImage::SectorList SectorImage::load(const var::StringView path) {
+  SectorList result;
+  if (!fs::FileSystem().exists(path)) {
+    return result;
+  }
+
+  const json::JsonArray array = json::JsonDocument()
+                                  .load(fs::File(path))
+                                  .to_object()
+                                  .at("sectors")
+                                  .to_array();
+  if (is_error()) {
+    API_RESET_ERROR();
+    return result;
+  }
+
+  result.reserve(array.count());
+  for (u32 i = 0; i < array.count(); i++) {
+    const json::JsonObject object = array.at(i).to_object();
+    result.push_back(Sector()
+                       .set_page(object.at("page").to_integer())
+                       .set_offset(object.at("offset").to_integer())
+                       .set_size(object.at("size").to_integer())
+                       .set_hash(var::GeneralString(
+                         object.at("hash").to_string_view())));
+  }
+  return result;
+}
+
+void SectorImage::save(const var::StringView path, const SectorList &list) {
+  const auto parent = fs::Path::parent_directory(path);
+  if (!parent.is_empty() && !fs::FileSystem().directory_exists(parent)) {
+    fs::FileSystem().create_directory(parent, fs::Dir::IsRecursive::yes);
+  }
+
+  json::JsonArray array;
+  for (const auto &sector : list) {
+    array.append(json::JsonObject()
+                   .insert("page", json::JsonInteger(sector.page()))
+                   .insert("offset", json::JsonInteger(sector.offset()))
+                   .insert("size", json::JsonInteger(sector.size()))
+                   .insert("hash", json::JsonString(sector.hash().cstring())));
+  }
+
+  json::JsonDocument().save(
+    json::JsonObject().insert("sectors", array),
+    fs::File(fs::File::IsOverwrite::yes, path));
+}
+
+var::GeneralString SectorImage::get_hash(const var::View data) {
+  return var::View(crypto::Sha256::get_hash(fs::ViewFile(data)))
+    .to_string<var::GeneralString>();
+}
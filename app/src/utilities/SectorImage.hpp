@@ -0,0 +1,49 @@
+#ifndef UTILITIES_SECTORIMAGE_HPP
+#define UTILITIES_SECTORIMAGE_HPP
+
+#include <fs.hpp>
+#include <json.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+
+// Per-sector SHA256 hashes of an OS image used by `os.install:differential`
+// to find the sectors that differ from the image on the device.
+class SectorImage : public AppAccess {
+public:
+  class Sector {
+    API_AF(Sector, u32, page, 0);
+    // offset from the start of the image
+    API_AF(Sector, u32, offset, 0);
+    API_AF(Sector, u32, size, 0);
+    API_AC(Sector, var::GeneralString, hash);
+  };
+
+  using SectorList = var::Vector<Sector>;
+
+  // used when the device page layout is not available
+  static SectorList create_layout(u32 image_size, u32 sector_size);
+
+  // hashes the image using `layout` (the last sector is truncated to the
+  // image size)
+  static SectorList hash(const var::View image, const SectorList &layout);
+
+  // hashes the sectors in `layout` read from `device` at `start_address`
+  static SectorList hash_device(
+    const fs::FileObject &device,
+    u32 start_address,
+    const SectorList &layout);
+
+  // sectors of `current` with a different (or no) hash in `reference`
+  static SectorList
+  get_changed(const SectorList &current, const SectorList &reference);
+
+  // the host-side record of the last image installed on a device
+  static SectorList load(const var::StringView path);
+  static void save(const var::StringView path, const SectorList &list);
+
+private:
+  static var::GeneralString get_hash(const var::View data);
+};
+
+#endif // UTILITIES_SECTORIMAGE_HPP
@@ -0,0 +1,372 @@
+#include <cstdio>
+#include <cstring>
+
+#if defined __win32
+#include <io.h>
+#define SELF_BENCH_NULL_DEVICE "NUL"
+#else
+#include <unistd.h>
+#define SELF_BENCH_NULL_DEVICE "/dev/null"
+#endif
+
+#include <chrono.hpp>
+#include <fs.hpp>
+#include <swd/Elf.hpp>
+#include <var.hpp>
+
+#include "Command.hpp"
+#include "GcovParser.hpp"
+#include "Group.hpp"
+#include "Packager.hpp"
+#include "SelfBench.hpp"
+#include "TaskSeries.hpp"
+#include "groups/DebugTrace.hpp"
+#include "groups/Terminal.hpp"
+
+namespace {
+// the SlPrinter subclasses write straight to stdout
+class SuppressStandardOutput {
+public:
+  SuppressStandardOutput() {
+    fflush(stdout);
+    m_saved = dup(fileno(stdout));
+    if (freopen(SELF_BENCH_NULL_DEVICE, "w", stdout) == nullptr) {
+      restore();
+    }
+  }
+
+  ~SuppressStandardOutput() { restore(); }
+
+private:
+  int m_saved = -1;
+
+  void restore() {
+    if (m_saved >= 0) {
+      fflush(stdout);
+      dup2(m_saved, fileno(stdout));
+      close(m_saved);
+      m_saved = -1;
+    }
+  }
+};
+} // namespace
+
+SelfBench::SelfBench(const sys::Cli &cli) : m_cli(cli) {
+  const auto iterations = cli.get_option("iterations");
+  if (iterations.is_empty() == false && iterations.to_unsigned_long() > 0) {
+    m_iterations = iterations.to_unsigned_long();
+  }
+}
+
+int SelfBench::execute() {
+  bench_command();
+  bench_printer();
+  bench_debug_trace();
+  bench_task_series();
+  bench_packager();
+  bench_gcov_parser();
+
+  const auto threshold_option = m_cli.get_option("threshold");
+  const float threshold
+    = threshold_option.is_empty() ? 10.0f : threshold_option.to_float();
+
+  const auto baseline = m_cli.get_option("baseline");
+  int result = 0;
+  if (baseline.is_empty()) {
+    printf(
+      "%s\n",
+      JsonDocument().stringify(JsonObject().insert("cases", m_results)).cstring());
+  } else {
+    result = compare_baseline(baseline, threshold);
+  }
+
+  const auto output = m_cli.get_option("output");
+  if (output.is_empty() == false) {
+    JsonDocument().save(
+      JsonObject().insert("cases", m_results),
+      File(File::IsOverwrite::yes, output));
+  }
+
+  return is_success() ? result : 1;
+}
+
+void SelfBench::run_case(
+  const var::StringView name,
+  u32 iterations,
+  const Function &function) {
+  if (iterations == 0) {
+    iterations = 1;
+  }
+
+  // one untimed pass to warm caches and lazy initialization
+  function();
+
+  chrono::ClockTimer timer;
+  timer.start();
+  for (u32 i = 0; i < iterations; i++) {
+    function();
+  }
+  timer.stop();
+
+  const float nanoseconds = timer.microseconds() * 1000.0f / iterations;
+  m_results.insert(
+    name,
+    JsonObject()
+      .insert("iterations", JsonInteger(iterations))
+      .insert("nanoseconds", JsonReal(nanoseconds)));
+}
+
+void SelfBench::bench_command() {
+  const Command reference(
+    Command::Group("fs"),
+    GROUP_ARG_DESC(read, "reads from a file (or device).")
+      + GROUP_ARG_OPT(append_a, bool, false, "append.")
+      + GROUP_ARG_OPT(destination_dest, string, <binary blob>, "destination.")
+      + GROUP_ARG_OPT(location_loc, int, 0, "location.")
+      + GROUP_ARG_OPT(pagesize_chunk, int, 512, "chunk size.")
+      + GROUP_ARG_OPT(size_s, int, <all>, "size.")
+      + GROUP_ARG_REQ(source_path, string, <source>, "source."));
+
+  const StringView command_string
+    = "read:path=device@/dev/drive0,dest=host@tmp.bin,loc=0,chunk=1024,s=4096";
+
+  run_case("command.parse", m_iterations, [&]() {
+    Command(Command::Group("fs"), command_string);
+  });
+
+  run_case("command.isValid", m_iterations, [&]() {
+    Command(Command::Group("fs"), command_string).is_valid(reference, printer());
+  });
+}
+
+void SelfBench::bench_printer() {
+  String report;
+  PrinterCallback callback(report);
+  callback.set_handle_input([](void *, const var::StringView) {});
+
+  const auto emit = [](printer::Printer &printer) {
+    printer::Printer::Object po(printer, "entry");
+    for (u32 i = 0; i < 16; i++) {
+      printer.key(NumberString(i, "key%d"), NumberString(i * 1000));
+    }
+  };
+
+  SuppressStandardOutput suppress_standard_output;
+  {
+    SlJsonPrinter json_printer(callback);
+    PrinterOutput::reset_statistics();
+    run_case("printer.json", m_iterations, [&]() { emit(json_printer); });
+    insert_output_statistics("printer.json");
+  }
+
+  {
+    SlYamlPrinter yaml_printer(callback);
+    PrinterOutput::reset_statistics();
+    run_case("printer.yaml", m_iterations, [&]() { emit(yaml_printer); });
+    insert_output_statistics("printer.yaml");
+  }
+
+  {
+    // the flush-per-fragment behavior for comparison
+    SlYamlPrinter yaml_printer(callback);
+    PrinterOutput::set_unbuffered();
+    PrinterOutput::reset_statistics();
+    run_case(
+      "printer.yaml.unbuffered",
+      m_iterations,
+      [&]() { emit(yaml_printer); });
+    insert_output_statistics("printer.yaml.unbuffered");
+    PrinterOutput::set_unbuffered(false);
+  }
+  PrinterOutput::flush();
+}
+
+void SelfBench::insert_output_statistics(const var::StringView name) {
+  // flushes are the write syscalls the printer caused
+  const auto statistics = PrinterOutput::statistics();
+  m_results.at(name).to_object()
+    .insert("writes", JsonInteger(statistics.write_count()))
+    .insert("flushes", JsonInteger(statistics.flush_count()));
+}
+
+void SelfBench::bench_debug_trace() {
+  const auto elf_path = m_cli.get_option("elf");
+  if (elf_path.is_empty() || FileSystem().exists(elf_path) == false) {
+    return;
+  }
+
+  const File elf_file(elf_path);
+  const auto symbol_list = swd::Elf(elf_file).get_symbol_list();
+  const swd::Elf::SymbolList empty_list;
+  if (is_error() || symbol_list.count() == 0) {
+    API_RESET_ERROR();
+    return;
+  }
+
+  Terminal terminal;
+  const DebugTrace debug_trace(terminal);
+  const u32 address = symbol_list.at(symbol_list.count() / 2).value() + 8;
+
+  run_case("debugTrace.getAddressFunction", m_iterations, [&]() {
+    debug_trace.get_address_function(symbol_list, empty_list, address);
+  });
+}
+
+void SelfBench::bench_task_series() {
+  constexpr u32 snapshot_count = 500;
+  constexpr u32 task_count = 24;
+
+  var::Vector<var::Vector<sos::TaskManager::Info>> history;
+  history.reserve(snapshot_count);
+  for (u32 i = 0; i < snapshot_count; i++) {
+    var::Vector<sos::TaskManager::Info> task_info_list;
+    task_info_list.reserve(task_count);
+    for (u32 task = 0; task < task_count; task++) {
+      sys_taskattr_t attributes = {};
+      attributes.pid = task / 4;
+      attributes.tid = task;
+      attributes.timer = u64(i) * 1000 + task * 10;
+      attributes.is_enabled = 1;
+      attributes.is_active = 1;
+      snprintf(attributes.name, sizeof(attributes.name), "task%ld", long(task / 4));
+      task_info_list.push_back(sos::TaskManager::Info(attributes));
+    }
+    history.push_back(task_info_list);
+  }
+
+  TaskSeries series;
+  run_case("taskSeries.append", m_iterations / 100, [&]() {
+    series.clear();
+    for (u32 i = 0; i < history.count(); i++) {
+      series.append(u64(i) * 100000, history.at(i));
+    }
+  });
+
+  run_case("taskSeries.saveCsv", m_iterations / 100, [&]() {
+    series.save_csv(NullFile());
+  });
+}
+
+void SelfBench::bench_packager() {
+  const auto directory_option = m_cli.get_option("directory");
+  const StringView directory
+    = directory_option.is_empty() ? StringView(".") : directory_option;
+
+  Packager packager;
+  run_case("packager.getDirectoryEntries", m_iterations / 100, [&]() {
+    StringList list;
+    packager.get_directory_entries(list, directory);
+  });
+}
+
+void SelfBench::bench_gcov_parser() {
+  const auto gcov_path = m_cli.get_option("gcov");
+
+  Data data;
+  if (gcov_path.is_empty() == false && FileSystem().exists(gcov_path)) {
+    data = DataFile().write(File(gcov_path)).data();
+  } else {
+    String content;
+    for (u32 i = 0; i < 10000; i++) {
+      static const StringView intro_list[]
+        = {"        -:", "    #####:", "       12:"};
+      content += intro_list[i % 3];
+      content += NumberString(i, "%5d").string_view();
+      content += ":  value++;\n";
+    }
+    data = Data(content);
+  }
+
+  run_case("gcovParser.countLines", m_iterations / 10, [&]() {
+    GcovParser::count_lines(View(data));
+  });
+}
+
+int SelfBench::compare_baseline(const var::StringView path, float threshold) {
+  if (
+    m_cli.get_option("update") == "true" || FileSystem().exists(path) == false) {
+    JsonDocument().save(
+      JsonObject().insert("cases", m_results),
+      File(File::IsOverwrite::yes, path));
+    printf(
+      "%s\n",
+      JsonDocument()
+        .stringify(JsonObject()
+                     .insert("cases", m_results)
+                     .insert("baseline", JsonString("created")))
+        .cstring());
+    return 0;
+  }
+
+  const JsonObject baseline
+    = JsonDocument().load(File(path)).to_object().at("cases").to_object();
+
+  // wall-clock time varies between runs and machines so it only fails the
+  // run when asked for
+  const bool is_timing = m_cli.get_option("timing") == "true";
+
+  int result = 0;
+  JsonObject comparison;
+  for (const auto &key : m_results.get_key_list()) {
+    const JsonObject current = m_results.at(key).to_object();
+    const JsonObject reference = baseline.at(key).to_object();
+    if (reference.is_valid() == false) {
+      continue;
+    }
+
+    const float current_value = current.at("nanoseconds").to_real();
+    const float baseline_value = reference.at("nanoseconds").to_real();
+    const float change = baseline_value > 0.0f
+                           ? (current_value - baseline_value) * 100.0f
+                               / baseline_value
+                           : 0.0f;
+    const bool is_slower = change > threshold;
+
+    // write and flush counts don't depend on the machine -- they only fail
+    // the run when the iteration count matches the baseline
+    const bool is_same_iterations = current.at("iterations").to_integer()
+                                    == reference.at("iterations").to_integer();
+    const bool is_more_output
+      = is_same_iterations
+        && (current.at("writes").to_integer()
+              > reference.at("writes").to_integer()
+            || current.at("flushes").to_integer()
+                 > reference.at("flushes").to_integer());
+
+    const bool is_regression = is_more_output || (is_timing && is_slower);
+    if (is_regression) {
+      result = 1;
+    }
+
+    comparison.insert(
+      key,
+      JsonObject()
+        .insert("nanoseconds", JsonReal(current_value))
+        .insert("baselineNanoseconds", JsonReal(baseline_value))
+        .insert("changePercent", JsonReal(change))
+        .insert("slower", is_slower ? JsonTrue() : JsonFalse())
+        .insert("writes", JsonInteger(current.at("writes").to_integer()))
+        .insert(
+          "baselineWrites",
+          JsonInteger(reference.at("writes").to_integer()))
+        .insert("flushes", JsonInteger(current.at("flushes").to_integer()))
+        .insert(
+          "baselineFlushes",
+          JsonInteger(reference.at("flushes").to_integer()))
+        .insert("regression", is_regression ? JsonTrue() : JsonFalse()));
+  }
+
+  printf(
+    "%s\n",
+    JsonDocument()
+      .stringify(JsonObject()
+                   .insert("cases", comparison)
+                   .insert("thresholdPercent", JsonReal(threshold))
+                   .insert("timing", is_timing ? JsonTrue() : JsonFalse())
+                   .insert(
+                     "result",
+                     JsonString(result ? "regression" : "pass")))
+      .cstring());
+
+  return result;
+}
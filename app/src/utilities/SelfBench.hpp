@@ -0,0 +1,48 @@
+#ifndef UTILITIES_SELFBENCH_HPP
+#define UTILITIES_SELFBENCH_HPP
+
+#include <functional>
+
+#include <json.hpp>
+#include <sys/Cli.hpp>
+
+#include "App.hpp"
+
+// microbenchmarks for sl's host-side hot paths (built as the `sl_bench`
+// target). Results are printed as JSON and compared against a stored
+// baseline. A case regresses when it makes more printer writes or flushes
+// than the baseline; time beyond `threshold` is reported as `slower` and
+// only fails the run with `--timing=true`.
+//
+// sl_bench --baseline=<path> [--output=<path>] [--iterations=<n>]
+//   [--threshold=<percent>] [--timing=true] [--directory=<path>]
+//   [--elf=<path>] [--gcov=<path>] [--update=true]
+class SelfBench : public AppAccess {
+public:
+  explicit SelfBench(const sys::Cli &cli);
+
+  // returns the process exit code (non-zero if a regression is detected)
+  int execute();
+
+private:
+  using Function = std::function<void()>;
+
+  const sys::Cli &m_cli;
+  json::JsonObject m_results;
+  u32 m_iterations = 1000;
+
+  void run_case(const var::StringView name, u32 iterations, const Function &function);
+
+  void insert_output_statistics(const var::StringView name);
+
+  void bench_command();
+  void bench_printer();
+  void bench_debug_trace();
+  void bench_task_series();
+  void bench_packager();
+  void bench_gcov_parser();
+
+  int compare_baseline(const var::StringView path, float threshold);
+};
+
+#endif // UTILITIES_SELFBENCH_HPP
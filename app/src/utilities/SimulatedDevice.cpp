@@ -0,0 +1,799 @@
+#include <cstring>
+
+#include <sos/dev/appfs.h>
+#include <sos/dev/sys.h>
+#include <sys.hpp>
+
+#include "SimulatedDevice.hpp"
+#include "settings/FilePathSettings.hpp"
+
+namespace {
+// the phy handle is only compared against the open error value
+link_transport_phy_t host_handle() {
+  return reinterpret_cast<link_transport_phy_t>(0x51a0);
+}
+
+link_transport_phy_t device_handle() {
+  return reinterpret_cast<link_transport_phy_t>(0x51a1);
+}
+} // namespace
+
+SimulatedDevice &SimulatedDevice::instance() {
+  static SimulatedDevice simulated_device;
+  return simulated_device;
+}
+
+var::PathString SimulatedDevice::root_directory_path() {
+  return FilePathSettings::global_directory() / "sim";
+}
+
+void SimulatedDevice::set_options(const Options &options) {
+  Mutex::Guard mg(instance().m_options_mutex);
+  instance().m_options = options;
+}
+
+void SimulatedDevice::load_driver(link_transport_mdriver_t *driver) {
+  // framing and the link protocol are the regular master implementation
+  link_load_default_driver(driver);
+  driver->phy_driver.handle = nullptr;
+  driver->phy_driver.open = phy_open;
+  driver->phy_driver.write = phy_write;
+  driver->phy_driver.read = phy_read;
+  driver->phy_driver.close = phy_close;
+  driver->phy_driver.wait = phy_wait;
+  driver->phy_driver.flush = phy_flush;
+  driver->phy_driver.request = phy_request;
+}
+
+void SimulatedDevice::start() {
+  if (m_is_running) {
+    return;
+  }
+
+  for (const auto &directory :
+       {"app/flash", "app/ram", "home", "dev"}) {
+    const auto host_directory = root_directory_path() / directory;
+    if (!FileSystem().directory_exists(host_directory)) {
+      FileSystem().create_directory(
+        host_directory,
+        Dir::IsRecursive::yes,
+        Permissions(0777));
+    }
+  }
+
+  m_host_to_device.flush();
+  m_device_to_host.flush();
+
+  m_device_driver = {};
+  m_device_driver.handle = device_handle();
+  m_device_driver.write = device_write;
+  m_device_driver.read = device_read;
+  m_device_driver.wait = phy_wait;
+  m_device_driver.flush = phy_flush;
+  m_device_driver.timeout = 100;
+
+  m_uptime.restart();
+  m_is_running = true;
+  m_thread = Thread(
+    Thread::Attributes().set_detach_state(Thread::DetachState::joinable),
+    Thread::Construct().set_argument(this).set_function(
+      [](void *args) -> void * {
+        reinterpret_cast<SimulatedDevice *>(args)->execute_device();
+        return nullptr;
+      }));
+}
+
+void SimulatedDevice::stop() {
+  if (!m_is_running) {
+    return;
+  }
+  m_is_running = false;
+  m_thread.join();
+  m_descriptor_list.clear();
+}
+
+void SimulatedDevice::delay(int nbyte) const {
+  const Options options = [&]() {
+    Mutex::Guard mg(m_options_mutex);
+    return m_options;
+  }();
+
+  u64 microseconds = options.latency().microseconds();
+  if (options.bandwidth()) {
+    microseconds += u64(nbyte) * 1000000ULL / options.bandwidth();
+  }
+
+  if (microseconds) {
+    chrono::wait(chrono::MicroTime(microseconds));
+  }
+}
+
+int SimulatedDevice::Pipe::write(const void *buffer, int nbyte) {
+  Mutex::Guard mg(m_mutex);
+  m_data.append(var::View(buffer, nbyte));
+  return nbyte;
+}
+
+int SimulatedDevice::Pipe::read(
+  void *buffer,
+  int nbyte,
+  const chrono::MicroTime &timeout) {
+  ClockTimer timer;
+  timer.start();
+  do {
+    {
+      Mutex::Guard mg(m_mutex);
+      const size_t available = m_data.size() - m_offset;
+      if (available) {
+        const size_t count = available < size_t(nbyte) ? available : nbyte;
+        memcpy(buffer, m_data.data_u8() + m_offset, count);
+        m_offset += count;
+        if (m_offset == m_data.size()) {
+          m_data.resize(0);
+          m_offset = 0;
+        }
+        return int(count);
+      }
+    }
+    chrono::wait(100_microseconds);
+  } while (timer.microseconds() < timeout.microseconds());
+  return 0;
+}
+
+void SimulatedDevice::Pipe::flush() {
+  Mutex::Guard mg(m_mutex);
+  m_data.resize(0);
+  m_offset = 0;
+}
+
+link_transport_phy_t
+SimulatedDevice::phy_open(const char *path, const void *options) {
+  MCU_UNUSED_ARGUMENT(options);
+  if (!is_simulated_path(path)) {
+    return LINK_PHY_OPEN_ERROR;
+  }
+  instance().start();
+  return host_handle();
+}
+
+int SimulatedDevice::phy_write(
+  link_transport_phy_t handle,
+  const void *buf,
+  int nbyte) {
+  MCU_UNUSED_ARGUMENT(handle);
+  instance().delay(nbyte);
+  return instance().m_host_to_device.write(buf, nbyte);
+}
+
+int SimulatedDevice::phy_read(link_transport_phy_t handle, void *buf, int nbyte) {
+  MCU_UNUSED_ARGUMENT(handle);
+  return instance().m_device_to_host.read(buf, nbyte, 1_milliseconds);
+}
+
+int SimulatedDevice::phy_close(link_transport_phy_t *handle) {
+  instance().stop();
+  *handle = LINK_PHY_OPEN_ERROR;
+  return 0;
+}
+
+void SimulatedDevice::phy_wait(int milliseconds) {
+  chrono::wait(milliseconds * 1_milliseconds);
+}
+
+void SimulatedDevice::phy_flush(link_transport_phy_t handle) {
+  if (handle == device_handle()) {
+    instance().m_host_to_device.flush();
+  } else {
+    instance().m_device_to_host.flush();
+  }
+}
+
+void SimulatedDevice::phy_request(link_transport_phy_t handle) {
+  MCU_UNUSED_ARGUMENT(handle);
+}
+
+int SimulatedDevice::device_write(
+  link_transport_phy_t handle,
+  const void *buf,
+  int nbyte) {
+  MCU_UNUSED_ARGUMENT(handle);
+  instance().delay(nbyte);
+  return instance().m_device_to_host.write(buf, nbyte);
+}
+
+int SimulatedDevice::device_read(
+  link_transport_phy_t handle,
+  void *buf,
+  int nbyte) {
+  MCU_UNUSED_ARGUMENT(handle);
+  return instance().m_host_to_device.read(buf, nbyte, 1_milliseconds);
+}
+
+void SimulatedDevice::execute_device() {
+  while (m_is_running) {
+    link_op_t op = {};
+    const int result = link_transport_slaveread(
+      &m_device_driver,
+      &op,
+      sizeof(link_op_t),
+      nullptr,
+      nullptr);
+
+    if (result > 0) {
+      handle(op, &m_device_driver);
+    }
+  }
+}
+
+void SimulatedDevice::handle(
+  const link_op_t &op,
+  link_transport_driver_t *driver) {
+  link_reply_t reply = {};
+  var::Data payload;
+
+  const auto send_reply = [&]() {
+    link_transport_slavewrite(
+      driver,
+      &reply,
+      sizeof(reply),
+      nullptr,
+      nullptr);
+  };
+
+  const auto fail = [&](int error_number) {
+    reply.err = -1;
+    reply.err_number = error_number;
+  };
+
+  Mutex::Guard mg(m_mutex);
+  update_tasks();
+
+  switch (op.cmd.cmd) {
+  case LINK_CMD_READSERIALNO: {
+    const auto serial_number = var::StringView("0000000051A0DE71CE00000000000000");
+    reply.err = int(serial_number.length());
+    send_reply();
+    link_transport_slavewrite(
+      driver,
+      serial_number.data(),
+      int(serial_number.length()),
+      nullptr,
+      nullptr);
+    return;
+  }
+
+  case LINK_CMD_OPEN: {
+    const auto path = read_path(driver, op.open.path_size);
+    reply.err = open(path, op.open.flags, reply);
+    break;
+  }
+
+  case LINK_CMD_CLOSE: {
+    auto *descriptor = get_descriptor(op.close.fildes);
+    if (descriptor == nullptr) {
+      fail(LINK_EBADF);
+    } else {
+      *descriptor = Descriptor();
+    }
+    break;
+  }
+
+  case LINK_CMD_READ: {
+    auto *descriptor = get_descriptor(op.read.fildes);
+    if (descriptor == nullptr) {
+      fail(LINK_EBADF);
+      break;
+    }
+    reply.err = read(*descriptor, payload, op.read.nbyte);
+    send_reply();
+    if (reply.err > 0) {
+      link_transport_slavewrite(
+        driver,
+        payload.data(),
+        reply.err,
+        nullptr,
+        nullptr);
+    }
+    return;
+  }
+
+  case LINK_CMD_WRITE: {
+    payload.resize(op.write.nbyte);
+    link_transport_slaveread(
+      driver,
+      payload.data(),
+      int(payload.size()),
+      nullptr,
+      nullptr);
+    auto *descriptor = get_descriptor(op.write.fildes);
+    if (descriptor == nullptr) {
+      fail(LINK_EBADF);
+    } else {
+      reply.err = write(*descriptor, payload);
+    }
+    break;
+  }
+
+  case LINK_CMD_LSEEK: {
+    auto *descriptor = get_descriptor(op.lseek.fildes);
+    if (descriptor == nullptr || descriptor->type() != Descriptor::Type::file) {
+      fail(LINK_EBADF);
+      break;
+    }
+    const u32 size = u32(FileSystem().get_info(descriptor->host_path()).size());
+    s32 location = op.lseek.offset;
+    if (op.lseek.whence == LINK_SEEK_CUR) {
+      location += s32(descriptor->location());
+    } else if (op.lseek.whence == LINK_SEEK_END) {
+      location += s32(size);
+    }
+    if (location < 0) {
+      fail(LINK_EINVAL);
+    } else {
+      descriptor->set_location(u32(location));
+      reply.err = location;
+    }
+    break;
+  }
+
+  case LINK_CMD_IOCTL: {
+    const u32 request = op.ioctl.request;
+    const u32 size = _IOCTL_SIZE(request);
+    payload.resize(size);
+    if (size && _IOCTL_IOCTLW(request)) {
+      link_transport_slaveread(
+        driver,
+        payload.data(),
+        int(size),
+        nullptr,
+        nullptr);
+    }
+
+    auto *descriptor = get_descriptor(op.ioctl.fildes);
+    if (descriptor == nullptr) {
+      fail(LINK_EBADF);
+    } else {
+      reply.err = ioctl(*descriptor, request, payload, reply);
+    }
+
+    send_reply();
+    if (size && _IOCTL_IOCTLR(request)) {
+      link_transport_slavewrite(
+        driver,
+        payload.data(),
+        int(size),
+        nullptr,
+        nullptr);
+    }
+    return;
+  }
+
+  case LINK_CMD_STAT: {
+    const auto path = read_path(driver, op.stat.path_size);
+    struct link_stat stat_value = {};
+    reply.err = stat(get_host_path(path), stat_value);
+    if (reply.err < 0) {
+      reply.err_number = LINK_ENOENT;
+    }
+    send_reply();
+    if (reply.err == 0) {
+      link_transport_slavewrite(
+        driver,
+        &stat_value,
+        sizeof(stat_value),
+        nullptr,
+        nullptr);
+    }
+    return;
+  }
+
+  case LINK_CMD_FSTAT: {
+    struct link_stat stat_value = {};
+    auto *descriptor = get_descriptor(op.fstat.fildes);
+    if (descriptor == nullptr) {
+      fail(LINK_EBADF);
+    } else if (descriptor->type() == Descriptor::Type::file) {
+      reply.err = stat(descriptor->host_path(), stat_value);
+    } else {
+      stat_value.st_mode = LINK_S_IFCHR | 0666;
+    }
+    send_reply();
+    if (reply.err == 0) {
+      link_transport_slavewrite(
+        driver,
+        &stat_value,
+        sizeof(stat_value),
+        nullptr,
+        nullptr);
+    }
+    return;
+  }
+
+  case LINK_CMD_UNLINK: {
+    const auto host_path = get_host_path(read_path(driver, op.unlink.path_size));
+    if (!FileSystem().exists(host_path)) {
+      fail(LINK_ENOENT);
+    } else {
+      FileSystem().remove(host_path);
+    }
+    break;
+  }
+
+  case LINK_CMD_MKDIR: {
+    const auto host_path = get_host_path(read_path(driver, op.mkdir.path_size));
+    if (host_path.is_empty()) {
+      fail(LINK_EINVAL);
+    } else {
+      FileSystem().create_directory(
+        host_path,
+        Dir::IsRecursive::no,
+        Permissions(op.mkdir.mode));
+    }
+    break;
+  }
+
+  case LINK_CMD_RMDIR: {
+    const auto host_path = get_host_path(read_path(driver, op.rmdir.path_size));
+    if (host_path.is_empty()) {
+      fail(LINK_EINVAL);
+    } else {
+      FileSystem().remove_directory(host_path);
+    }
+    break;
+  }
+
+  case LINK_CMD_OPENDIR: {
+    const auto host_path
+      = get_host_path(read_path(driver, op.opendir.path_size));
+    if (!FileSystem().directory_exists(host_path)) {
+      // opendir returns a pointer value; zero is failure
+      reply.err = 0;
+      reply.err_number = LINK_ENOENT;
+    } else {
+      Descriptor descriptor(Descriptor::Type::directory);
+      descriptor.set_host_path(host_path).set_entry_list(
+        FileSystem().read_directory(host_path));
+      reply.err = add_descriptor(descriptor);
+    }
+    break;
+  }
+
+  case LINK_CMD_READDIR: {
+    struct link_dirent entry = {};
+    auto *descriptor = get_descriptor(int(op.readdir.dirp));
+    if (
+      descriptor == nullptr
+      || descriptor->type() != Descriptor::Type::directory) {
+      fail(LINK_EBADF);
+    } else if (descriptor->entry() >= descriptor->entry_list().count()) {
+      // end of the directory
+      fail(0);
+    } else {
+      const auto &name = descriptor->entry_list().at(descriptor->entry());
+      entry.d_ino = descriptor->entry();
+      strncpy(entry.d_name, name.cstring(), sizeof(entry.d_name) - 1);
+      descriptor->set_entry(descriptor->entry() + 1);
+    }
+    send_reply();
+    if (reply.err == 0) {
+      link_transport_slavewrite(
+        driver,
+        &entry,
+        sizeof(entry),
+        nullptr,
+        nullptr);
+    }
+    return;
+  }
+
+  case LINK_CMD_CLOSEDIR: {
+    auto *descriptor = get_descriptor(int(op.closedir.dirp));
+    if (descriptor == nullptr) {
+      fail(LINK_EBADF);
+    } else {
+      *descriptor = Descriptor();
+    }
+    break;
+  }
+
+  case LINK_CMD_EXEC: {
+    reply.err = exec(read_path(driver, op.exec.path_size));
+    break;
+  }
+
+  default:
+    fail(LINK_ENOTSUP);
+    break;
+  }
+
+  send_reply();
+}
+
+var::PathString
+SimulatedDevice::get_host_path(const var::StringView device_path) const {
+  // `.` and `..` could reach files outside of the simulated file system
+  for (const auto &segment : device_path.split("/")) {
+    if (segment == ".." || segment == ".") {
+      return var::PathString();
+    }
+  }
+  if (device_path.find("\\") != var::StringView::npos) {
+    return var::PathString();
+  }
+
+  const size_t skip = device_path.find("/") == 0 ? 1 : 0;
+  return root_directory_path()
+         / var::StringView(device_path.data() + skip, device_path.length() - skip);
+}
+
+var::PathString
+SimulatedDevice::read_path(link_transport_driver_t *driver, u32 size) {
+  var::PathString result;
+  if (size >= result.capacity()) {
+    size = result.capacity() - 1;
+  }
+  link_transport_slaveread(driver, result.data(), int(size), nullptr, nullptr);
+  result.data()[size] = 0;
+  return result;
+}
+
+int SimulatedDevice::add_descriptor(const Descriptor &descriptor) {
+  for (const auto index : api::Index(m_descriptor_list.count())) {
+    if (!m_descriptor_list.at(index).is_valid()) {
+      m_descriptor_list.at(index) = descriptor;
+      return int(index) + 1;
+    }
+  }
+  m_descriptor_list.push_back(descriptor);
+  return int(m_descriptor_list.count());
+}
+
+SimulatedDevice::Descriptor *SimulatedDevice::get_descriptor(int fildes) {
+  // descriptors start at 1 so that opendir() never returns zero
+  const size_t offset = size_t(fildes) - 1;
+  if (fildes <= 0 || offset >= m_descriptor_list.count()) {
+    return nullptr;
+  }
+  auto &descriptor = m_descriptor_list.at(offset);
+  return descriptor.is_valid() ? &descriptor : nullptr;
+}
+
+int SimulatedDevice::open(
+  const var::StringView path,
+  int flags,
+  link_reply_t &reply) {
+
+  const auto device_type = [&]() {
+    if (path == "/dev/sys") {
+      return Descriptor::Type::sys;
+    }
+    if (path == "/app/.install") {
+      return Descriptor::Type::install;
+    }
+    if (path == "/dev/stdio-in") {
+      return Descriptor::Type::stdio_in;
+    }
+    if (path == "/dev/stdio-out") {
+      return Descriptor::Type::stdio_out;
+    }
+    if (path == "/dev/trace") {
+      return Descriptor::Type::trace;
+    }
+    return Descriptor::Type::file;
+  }();
+
+  if (device_type != Descriptor::Type::file) {
+    return add_descriptor(Descriptor(device_type));
+  }
+
+  const auto host_path = get_host_path(path);
+  if (host_path.is_empty()) {
+    reply.err_number = LINK_EINVAL;
+    return -1;
+  }
+
+  const bool is_exists = FileSystem().exists(host_path);
+  if (!is_exists && (flags & LINK_O_CREAT) == 0) {
+    reply.err_number = LINK_ENOENT;
+    return -1;
+  }
+
+  if (is_exists && FileSystem().directory_exists(host_path)) {
+    reply.err_number = LINK_EISDIR;
+    return -1;
+  }
+
+  if (!is_exists || (flags & LINK_O_TRUNC)) {
+    File(File::IsOverwrite::yes, host_path);
+  }
+
+  Descriptor descriptor(Descriptor::Type::file);
+  descriptor.set_host_path(host_path);
+  if (flags & LINK_O_APPEND) {
+    descriptor.set_location(u32(FileSystem().get_info(host_path).size()));
+  }
+  return add_descriptor(descriptor);
+}
+
+int SimulatedDevice::read(Descriptor &descriptor, var::Data &data, u32 nbyte) {
+  switch (descriptor.type()) {
+  case Descriptor::Type::file: {
+    data.resize(nbyte);
+    const File file(descriptor.host_path());
+    file.seek(int(descriptor.location())).read(data);
+    const int result = file.return_value();
+    if (result > 0) {
+      descriptor.set_location(descriptor.location() + u32(result));
+    }
+    API_RESET_ERROR();
+    return result < 0 ? 0 : result;
+  }
+
+  case Descriptor::Type::stdio_out: {
+    const size_t count = m_stdio.size() < nbyte ? m_stdio.size() : nbyte;
+    data = var::Data(var::View(m_stdio.data(), count));
+    m_stdio = var::Data(var::View(m_stdio.data_u8() + count, m_stdio.size() - count));
+    return int(count);
+  }
+
+  default:
+    // `/dev/trace` has no pending frames
+    return 0;
+  }
+}
+
+int SimulatedDevice::write(Descriptor &descriptor, const var::View data) {
+  switch (descriptor.type()) {
+  case Descriptor::Type::file: {
+    File file(descriptor.host_path(), OpenMode::read_write());
+    file.seek(int(descriptor.location())).write(data);
+    const int result = file.return_value();
+    if (result > 0) {
+      descriptor.set_location(descriptor.location() + u32(result));
+    }
+    API_RESET_ERROR();
+    return result;
+  }
+
+  case Descriptor::Type::stdio_in:
+    // loopback: what is written to stdin is echoed on stdout
+    m_stdio.append(data);
+    return int(data.size());
+
+  default:
+    return int(data.size());
+  }
+}
+
+int SimulatedDevice::ioctl(
+  Descriptor &descriptor,
+  u32 request,
+  var::Data &argument,
+  link_reply_t &reply) {
+
+  if (descriptor.type() == Descriptor::Type::sys) {
+    switch (request) {
+    case I_SYS_GETINFO: {
+      auto *info = reinterpret_cast<sys_info_t *>(argument.data());
+      *info = {};
+      strncpy(info->name, "Simulated", sizeof(info->name) - 1);
+      strncpy(info->version, "0.1", sizeof(info->version) - 1);
+      strncpy(info->arch, "sim", sizeof(info->arch) - 1);
+      strncpy(info->id, "simulated", sizeof(info->id) - 1);
+      strncpy(info->kernel_version, "4.0.0", sizeof(info->kernel_version) - 1);
+      info->cpu_freq = 120000000;
+      info->serial.sn[0] = 0x51a0de71;
+      info->serial.sn[1] = 0xce000000;
+      return 0;
+    }
+
+    case I_SYS_GETTASK: {
+      auto *task = reinterpret_cast<sys_taskattr_t *>(argument.data());
+      const u32 tid = task->tid;
+      if (tid > m_task_list.count()) {
+        reply.err_number = LINK_ESRCH;
+        return -1;
+      }
+      *task = {};
+      task->tid = tid;
+      task->is_enabled = 1;
+      task->is_active = 1;
+      task->mem_size = 4096;
+      if (tid == 0) {
+        strncpy(task->name, "sys", sizeof(task->name) - 1);
+      } else {
+        const auto &entry = m_task_list.at(tid - 1);
+        strncpy(task->name, entry.name().cstring(), sizeof(task->name) - 1);
+        task->pid = entry.pid();
+        task->timer = u64(m_uptime.milliseconds() - entry.start()) * 1000;
+      }
+      return 1;
+    }
+
+    case I_SYS_KILL: {
+      const auto *kill = reinterpret_cast<const sys_killattr_t *>(argument.data());
+      for (const auto index : api::Index(m_task_list.count())) {
+        if (m_task_list.at(index).pid() == kill->id) {
+          m_task_list.remove(index);
+          return 0;
+        }
+      }
+      reply.err_number = LINK_ESRCH;
+      return -1;
+    }
+
+    default:
+      return 0;
+    }
+  }
+
+  if (descriptor.type() == Descriptor::Type::install) {
+    if (request == I_APPFS_INSTALL || request == I_APPFS_CREATE) {
+      const auto *attributes
+        = reinterpret_cast<const appfs_installattr_t *>(argument.data());
+      if (attributes->loc == 0) {
+        const auto *file = reinterpret_cast<const appfs_file_t *>(
+          attributes->buffer);
+        descriptor.set_install_path(
+          get_host_path("/app/flash") / file->hdr.name);
+        File(File::IsOverwrite::yes, descriptor.install_path());
+      }
+
+      if (descriptor.install_path().is_empty()) {
+        reply.err_number = LINK_EINVAL;
+        return -1;
+      }
+
+      File(descriptor.install_path(), OpenMode::read_write())
+        .seek(int(attributes->loc))
+        .write(var::View(attributes->buffer, attributes->nbyte));
+      API_RESET_ERROR();
+    }
+    return 0;
+  }
+
+  return 0;
+}
+
+int SimulatedDevice::stat(
+  const var::StringView host_path,
+  struct link_stat &stat) {
+  if (!FileSystem().exists(host_path)) {
+    return -1;
+  }
+  const auto info = FileSystem().get_info(host_path);
+  stat.st_size = u32(info.size());
+  stat.st_mode = (info.is_directory() ? LINK_S_IFDIR : LINK_S_IFREG)
+                 | (info.permissions().permissions() & 0777);
+  return 0;
+}
+
+int SimulatedDevice::exec(const var::StringView command) {
+  const auto path = command.split(" ").front();
+  const auto host_path = get_host_path(path);
+  if (!FileSystem().exists(host_path)) {
+    return -1;
+  }
+
+  // the application "runs" for a second, then exits
+  m_task_list.push_back(Task()
+                          .set_name(fs::Path::name(path))
+                          .set_pid(m_next_pid++)
+                          .set_start(m_uptime.milliseconds())
+                          .set_lifetime(1000));
+
+  m_stdio.append(var::View(fs::Path::name(path)));
+  m_stdio.append(var::View(var::StringView(" started\n")));
+  return int(m_task_list.back().pid());
+}
+
+void SimulatedDevice::update_tasks() {
+  for (size_t index = 0; index < m_task_list.count();) {
+    const auto &task = m_task_list.at(index);
+    if (m_uptime.milliseconds() - task.start() > task.lifetime()) {
+      m_task_list.remove(index);
+    } else {
+      index++;
+    }
+  }
+}
@@ -0,0 +1,152 @@
+#ifndef UTILITIES_SIMULATEDDEVICE_HPP
+#define UTILITIES_SIMULATEDDEVICE_HPP
+
+#include <chrono.hpp>
+#include <fs.hpp>
+#include <sos/link.h>
+#include <sos/link/transport.h>
+#include <thread.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+
+// In-process Stratify OS link endpoint selected with the `/sim` driver path
+// (`sl conn.connect:path=/sim`).
+//
+// The host side uses the normal link master transport. The phy layer is a
+// pair of in-memory pipes serviced by a device thread that runs the link
+// slave transport. The device filesystem is backed by a host directory so
+// files and installed applications persist across invocations. `/dev/sys`
+// (info, tasks, kill), `/app/.install`, `/dev/stdio-in`, `/dev/stdio-out`
+// (loopback) and `/dev/trace` are emulated. Every phy packet can be delayed
+// by a fixed latency plus a bandwidth-limited transfer time, so transfer
+// measurements are repeatable.
+class SimulatedDevice : public AppAccess {
+public:
+  class Options {
+  public:
+    Options() { set_latency(chrono::MicroTime(0)); }
+
+  private:
+    API_AC(Options, chrono::MicroTime, latency);
+    // bytes per second (zero is unlimited)
+    API_AF(Options, u32, bandwidth, 0);
+  };
+
+  static var::StringView driver_name() { return "sim"; }
+  static var::StringView path() { return "/sim"; }
+  // `/sim` or `@sim` on its own or followed by `/` (so `/simulator` and
+  // `@simple` are not matched)
+  static bool is_simulated_path(const var::StringView path) {
+    const auto is_match = [path](const var::StringView prefix) {
+      return path.find(prefix) == 0
+             && (path.length() == prefix.length()
+                 || path.at(prefix.length()) == '/');
+    };
+    return is_match(SimulatedDevice::path()) || is_match("@sim");
+  }
+
+  static fs::PathList get_path_list() {
+    fs::PathList result;
+    result.push_back(path());
+    return result;
+  }
+
+  static var::PathString root_directory_path();
+
+  static void set_options(const Options &options);
+  static void load_driver(link_transport_mdriver_t *driver);
+
+private:
+  class Pipe {
+  public:
+    int write(const void *buffer, int nbyte);
+    int read(void *buffer, int nbyte, const chrono::MicroTime &timeout);
+    void flush();
+
+  private:
+    thread::Mutex m_mutex;
+    var::Data m_data;
+    size_t m_offset = 0;
+  };
+
+  class Descriptor {
+  public:
+    enum class Type { none, file, directory, sys, install, stdio_in, stdio_out, trace };
+
+    Descriptor() = default;
+    explicit Descriptor(Type type) : m_type(type) {}
+
+    bool is_valid() const { return m_type != Type::none; }
+
+    API_AF(Descriptor, Type, type, Type::none);
+    API_AC(Descriptor, var::PathString, host_path);
+    API_AF(Descriptor, u32, location, 0);
+    API_AF(Descriptor, u32, entry, 0);
+    API_AC(Descriptor, fs::PathList, entry_list);
+    API_AC(Descriptor, var::PathString, install_path);
+  };
+
+  class Task {
+  public:
+    API_AC(Task, var::NameString, name);
+    API_AF(Task, u32, pid, 0);
+    // milliseconds of device uptime
+    API_AF(Task, u32, start, 0);
+    API_AF(Task, u32, lifetime, 0);
+  };
+
+  static SimulatedDevice &instance();
+
+  thread::Mutex m_options_mutex;
+  Options m_options;
+  chrono::ClockTimer m_uptime;
+  Pipe m_host_to_device;
+  Pipe m_device_to_host;
+  thread::Mutex m_mutex;
+  var::Vector<Descriptor> m_descriptor_list;
+  var::Vector<Task> m_task_list;
+  var::Data m_stdio;
+  u32 m_next_pid = 1;
+  volatile bool m_is_running = false;
+  thread::Thread m_thread;
+  link_transport_driver_t m_device_driver;
+
+  void start();
+  void stop();
+  void delay(int nbyte) const;
+  void execute_device();
+  void handle(const link_op_t &op, link_transport_driver_t *driver);
+
+  // empty if `device_path` has `.` or `..` segments
+  var::PathString get_host_path(const var::StringView device_path) const;
+  var::PathString read_path(link_transport_driver_t *driver, u32 size);
+  int add_descriptor(const Descriptor &descriptor);
+  Descriptor *get_descriptor(int fildes);
+
+  int open(const var::StringView path, int flags, link_reply_t &reply);
+  int read(Descriptor &descriptor, var::Data &data, u32 nbyte);
+  int write(Descriptor &descriptor, const var::View data);
+  int ioctl(
+    Descriptor &descriptor,
+    u32 request,
+    var::Data &argument,
+    link_reply_t &reply);
+  int stat(const var::StringView host_path, struct link_stat &stat);
+  int exec(const var::StringView command);
+  void update_tasks();
+
+  // phy functions installed in the link drivers
+  static link_transport_phy_t phy_open(const char *path, const void *options);
+  static int phy_write(link_transport_phy_t handle, const void *buf, int nbyte);
+  static int phy_read(link_transport_phy_t handle, void *buf, int nbyte);
+  static int phy_close(link_transport_phy_t *handle);
+  static void phy_wait(int milliseconds);
+  static void phy_flush(link_transport_phy_t handle);
+  static void phy_request(link_transport_phy_t handle);
+
+  static int device_write(link_transport_phy_t handle, const void *buf, int nbyte);
+  static int device_read(link_transport_phy_t handle, void *buf, int nbyte);
+};
+
+#endif // UTILITIES_SIMULATEDDEVICE_HPP
@@ -15,8 +15,18 @@ var::Vector<Switch> Switch::get_list() {
     .push_back(Switch(
       "offline",
       "operate in offline mode (not all features are available)"))
+    .push_back(Switch(
+      "cloud",
+      "sends cloud storage downloads to a `cloud.standin` server instead of "
+      "the hosted service (overrides `SL_CLOUD_URL`). Sign-in and documents "
+      "still use the hosted service. Example: `sl os.install "
+      "--cloud=http://localhost:8090`"))
     .push_back(Switch("listen", "run as an HTTP server using JSON requests"))
     .push_back(Switch("webpath", "path to an HTTP site to serve"))
+    .push_back(Switch(
+      "daemon",
+      "keep the connection open and serve commands from other `sl` "
+      "invocations on this computer. Example: `sl conn.connect --daemon`"))
     .push_back(Switch(
       "update",
       "checks for updates to `sl` and downloads the latest version without "
@@ -58,6 +68,24 @@ var::Vector<Switch> Switch::get_list() {
     .push_back(Switch(
       "json",
       "prints output in JSON format. Example: `sl --version --json`"))
+    .push_back(Switch(
+      "ndjson",
+      "prints output as newline-delimited JSON with one object per line as "
+      "each command completes. Example: `sl fs.list:path=/app --ndjson`"))
+    .push_back(Switch(
+      "unbuffered",
+      "flushes the output after every fragment instead of at command "
+      "boundaries, progress updates and every 100ms. Example: `sl task.list "
+      "--unbuffered`"))
+    .push_back(Switch(
+      "progressrate",
+      "sets the maximum progress redraws per second (default is 10, 0 redraws "
+      "on every update). Example: `sl fs.copy:source=host@a,dest=device@/app/"
+      "flash/a --progressrate=4`"))
+    .push_back(Switch(
+      "jsonvalidate",
+      "parses the complete `--json` output at exit to verify it is valid "
+      "JSON. Example: `sl --version --json --jsonvalidate`"))
     .push_back(Switch(
       "archivehistory",
       "archives the workspace history. The history is automatically archived "
@@ -161,14 +189,48 @@ bool Switch::handle_switches(const sys::Cli &cli) {
     }
   }
 
+  value = cli.get_option("ndjson");
+  if (value == "true") {
+    printer().set_ndjson();
+  } else if (!value.is_empty()) {
+    printer().set_ndjson();
+    printer().syntax_error("`--ndjson` does not take arguments");
+  }
+
   value = cli.get_option("json");
   if (value == "true") {
-    printer().set_json();
+    if (!printer().is_ndjson()) {
+      printer().set_json();
+    }
   } else if (!value.is_empty()) {
     printer().set_json();
     printer().syntax_error("`--json` does not take arguments");
   }
 
+  value = cli.get_option("unbuffered");
+  if (value == "true") {
+    PrinterOutput::set_unbuffered();
+  } else if (!value.is_empty()) {
+    printer().syntax_error("`--unbuffered` does not take arguments");
+  }
+
+  value = cli.get_option("progressrate");
+  if (
+    value == "true"
+    || value.find_first_not_of("0123456789") != var::StringView::npos) {
+    printer().syntax_error("`--progressrate` takes the redraws per second");
+  } else if (!value.is_empty()) {
+    printer().progress_throttle().set_redraws_per_second(
+      value.to_unsigned_long());
+  }
+
+  value = cli.get_option("jsonvalidate");
+  if (value == "true") {
+    printer().set_json_validate();
+  } else if (!value.is_empty()) {
+    printer().syntax_error("`--jsonvalidate` does not take arguments");
+  }
+
   value = cli.get_option("codefences");
   if (value == "true") {
     printer().set_insert_codefences();
@@ -192,6 +254,15 @@ bool Switch::handle_switches(const sys::Cli &cli) {
   value = cli.get_option("offline");
   session_settings().set_offline_mode(value == "true");
 
+  value = cli.get_option("cloud");
+  if (value == "true") {
+    printer().syntax_error("use `--cloud=<url>`");
+  } else if (value && value != "false") {
+    session_settings().set_cloud_url(value);
+  } else if (const char *cloud_url = getenv("SL_CLOUD_URL")) {
+    session_settings().set_cloud_url(cloud_url);
+  }
+
   value = cli.get_option("initialize");
   if (value == "true") {
     if (!workspace_settings().is_valid()) {
@@ -398,6 +469,13 @@ bool Switch::handle_switches(const sys::Cli &cli) {
     session_settings().set_listen_mode();
   }
 
+  value = cli.get_option(("daemon"));
+  if (value == "true") {
+    session_settings().set_daemon_mode();
+  } else if (!value.is_empty()) {
+    printer().syntax_error("`--daemon` does not take arguments");
+  }
+
   value = cli.get_option(("webpath"));
   if (value) {
     if (value != "true") {
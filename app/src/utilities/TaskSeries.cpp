@@ -0,0 +1,565 @@
+#include <cstdio>
+#include <cstring>
+
+#include "TaskSeries.hpp"
+
+// Binary format (little-endian, all fields u32 unless noted):
+//
+// magic "slts", version, sample count (n), series count, start timestamp
+// (u64, microseconds), n time deltas, then for each series: name length,
+// name bytes, id, pid, memory size, is thread, n CPU deltas, n stack sizes
+// and n heap sizes.
+namespace {
+constexpr char binary_magic[4] = {'s', 'l', 't', 's'};
+constexpr u32 binary_version = 1;
+
+// points per line in the HTML charts
+constexpr u32 chart_point_count = 800;
+constexpr u32 chart_width = 1000;
+constexpr u32 chart_height = 300;
+
+var::String html_escape(const var::StringView value) {
+  var::String result;
+  for (size_t i = 0; i < value.length(); i++) {
+    const char c = value.at(i);
+    switch (c) {
+    case '<':
+      result += "&lt;";
+      break;
+    case '>':
+      result += "&gt;";
+      break;
+    case '&':
+      result += "&amp;";
+      break;
+    case '"':
+      result += "&quot;";
+      break;
+    default:
+      result += var::StringView(&c, 1);
+    }
+  }
+  return result;
+}
+
+const char *get_color(u32 offset) {
+  static const char *color_list[] = {
+    "#1f77b4",
+    "#ff7f0e",
+    "#2ca02c",
+    "#d62728",
+    "#9467bd",
+    "#8c564b",
+    "#e377c2",
+    "#7f7f7f",
+    "#bcbd22",
+    "#17becf"};
+  return color_list[offset % (sizeof(color_list) / sizeof(color_list[0]))];
+}
+} // namespace
+
+u64 TaskSeries::Series::get_cpu_time() const {
+  u64 result = 0;
+  for (const auto value : cpu_delta()) {
+    result += value;
+  }
+  return result;
+}
+
+u32 TaskSeries::Series::get_maximum_stack_size() const {
+  u32 result = 0;
+  for (const auto value : stack_size()) {
+    if (value != absent() && value > result) {
+      result = value;
+    }
+  }
+  return result;
+}
+
+u32 TaskSeries::Series::get_maximum_heap_size() const {
+  u32 result = 0;
+  for (const auto value : heap_size()) {
+    if (value > result) {
+      result = value;
+    }
+  }
+  return result;
+}
+
+float TaskSeries::Series::get_memory_utilization() const {
+  if (memory_size() == 0) {
+    return 0.0f;
+  }
+  const u32 used = is_thread()
+                     ? get_maximum_stack_size()
+                     : get_maximum_stack_size() + get_maximum_heap_size();
+  return used * 100.0f / memory_size();
+}
+
+TaskSeries &TaskSeries::append(
+  u64 timestamp,
+  const var::Vector<sos::TaskManager::Info> &list) {
+
+  if (m_maximum_count && count() >= m_maximum_count) {
+    drop_front(count() / 2);
+  }
+
+  if (is_empty()) {
+    m_start_timestamp = timestamp;
+    m_time_delta.push_back(0);
+  } else {
+    const u64 delta
+      = timestamp > m_last_timestamp ? timestamp - m_last_timestamp : 0;
+    m_time_delta.push_back(delta < absent() ? delta : absent() - 1);
+  }
+  m_last_timestamp = timestamp;
+
+  for (auto &series : m_series_list) {
+    series.cpu_delta().push_back(0);
+    series.stack_size().push_back(absent());
+    series.heap_size().push_back(0);
+  }
+
+  for (const auto &info : list) {
+    u32 offset = find_series(info);
+    if (offset == m_series_list.count()) {
+      // earlier samples are marked absent
+      Series series = Series()
+                        .set_name(var::NameString(info.name()))
+                        .set_id(info.id())
+                        .set_pid(info.pid())
+                        .set_memory_size(info.memory_size())
+                        .set_thread(info.is_thread())
+                        .set_last_timer(info.timer());
+      series.cpu_delta().resize(count());
+      series.stack_size().resize(count());
+      series.heap_size().resize(count());
+      for (u32 i = 0; i < count(); i++) {
+        series.cpu_delta().at(i) = 0;
+        series.stack_size().at(i) = absent();
+        series.heap_size().at(i) = 0;
+      }
+      m_series_list.push_back(series);
+    }
+
+    auto &series = m_series_list.at(offset);
+    const u64 delta = info.timer() > series.last_timer()
+                        ? info.timer() - series.last_timer()
+                        : 0;
+    series.set_last_timer(info.timer());
+    series.cpu_delta().back() = delta < absent() ? delta : absent() - 1;
+    // the stack column also marks the task as present
+    series.stack_size().back()
+      = info.stack_size() < absent() ? info.stack_size() : absent() - 1;
+    series.heap_size().back() = info.is_thread() ? 0 : info.heap_size();
+  }
+
+  return *this;
+}
+
+void TaskSeries::clear() {
+  m_start_timestamp = 0;
+  m_last_timestamp = 0;
+  m_time_delta = var::Vector<u32>();
+  m_series_list = SeriesList();
+}
+
+u64 TaskSeries::get_timestamp(u32 sample) const {
+  u64 result = m_start_timestamp;
+  for (u32 i = 1; i <= sample && i < count(); i++) {
+    result += m_time_delta.at(i);
+  }
+  return result;
+}
+
+u64 TaskSeries::get_total_cpu_time() const {
+  u64 result = 0;
+  for (const auto &series : m_series_list) {
+    result += series.get_cpu_time();
+  }
+  return result;
+}
+
+u64 TaskSeries::get_sample_cpu_time(u32 sample) const {
+  u64 result = 0;
+  for (const auto &series : m_series_list) {
+    result += series.cpu_delta().at(sample);
+  }
+  return result;
+}
+
+void TaskSeries::save_csv(const fs::FileObject &file) const {
+  file.write(var::StringView(
+    "timestamp,name,id,pid,cpuCycles,cpuUsage,stackSize,heapSize,"
+    "memoryUsage\n"));
+
+  u64 timestamp = m_start_timestamp;
+  var::String line;
+  for (u32 sample = 0; sample < count() && is_success(); sample++) {
+    if (sample) {
+      timestamp += m_time_delta.at(sample);
+    }
+
+    const u64 sample_cpu_time = get_sample_cpu_time(sample);
+    line.clear();
+    for (const auto &series : m_series_list) {
+      if (!series.is_present(sample)) {
+        continue;
+      }
+
+      const u32 cpu_delta = series.cpu_delta().at(sample);
+      const u32 stack_size = series.stack_size().at(sample);
+      const u32 heap_size = series.heap_size().at(sample);
+      const u32 used = series.is_thread() ? stack_size : stack_size + heap_size;
+      char buffer[128];
+      snprintf(
+        buffer,
+        sizeof(buffer),
+        ",%u,%u,%u,%0.3f,%u,%u,%0.2f\n",
+        series.id(),
+        series.pid(),
+        cpu_delta,
+        sample_cpu_time ? cpu_delta * 100.0 / sample_cpu_time : 0.0,
+        stack_size,
+        heap_size,
+        series.memory_size() ? used * 100.0 / series.memory_size() : 0.0);
+
+      line += var::NumberString(timestamp, "%lld") + ","
+              + series.name().string_view() + buffer;
+    }
+    file.write(line);
+  }
+}
+
+void TaskSeries::save_binary(const fs::FileObject &file) const {
+  const auto write_u32 = [&](u32 value) { file.write(var::View(value)); };
+  const auto write_column = [&](const var::Vector<u32> &column) {
+    if (column.count()) {
+      file.write(var::View(column.data(), column.count() * sizeof(u32)));
+    }
+  };
+
+  file.write(var::View(binary_magic, sizeof(binary_magic)));
+  write_u32(binary_version);
+  write_u32(count());
+  write_u32(m_series_list.count());
+  file.write(var::View(m_start_timestamp));
+  write_column(m_time_delta);
+
+  for (const auto &series : m_series_list) {
+    const auto name = series.name().string_view();
+    write_u32(name.length());
+    file.write(var::View(name.data(), name.length()));
+    write_u32(series.id());
+    write_u32(series.pid());
+    write_u32(series.memory_size());
+    write_u32(series.is_thread());
+    write_column(series.cpu_delta());
+    write_column(series.stack_size());
+    write_column(series.heap_size());
+  }
+}
+
+TaskSeries TaskSeries::load_binary(const fs::FileObject &file) {
+  TaskSeries result;
+
+  char magic[sizeof(binary_magic)] = {};
+  u32 version = 0;
+  u32 sample_count = 0;
+  u32 series_count = 0;
+  file.read(var::View(magic, sizeof(magic)))
+    .read(var::View(version))
+    .read(var::View(sample_count))
+    .read(var::View(series_count))
+    .read(var::View(result.m_start_timestamp));
+
+  if (is_error()) {
+    return TaskSeries();
+  }
+
+  if (
+    memcmp(magic, binary_magic, sizeof(magic)) != 0
+    || version != binary_version) {
+    API_RETURN_VALUE_ASSIGN_ERROR(
+      TaskSeries(),
+      "not a task series file",
+      EINVAL);
+  }
+
+  // check the counts against the file before sizing any columns: each
+  // series is at least a name length, four fields and three columns
+  const u64 remaining_size = file.size() - file.location();
+  const u64 column_size = u64(sample_count) * sizeof(u32);
+  const u64 series_size = 5 * sizeof(u32) + 3 * column_size;
+  if (
+    column_size > remaining_size
+    || series_count > (remaining_size - column_size) / series_size) {
+    API_RETURN_VALUE_ASSIGN_ERROR(
+      TaskSeries(),
+      "task series file is truncated",
+      EINVAL);
+  }
+
+  const auto read_u32 = [&]() {
+    u32 value = 0;
+    file.read(var::View(value));
+    return value;
+  };
+
+  const auto read_column = [&](var::Vector<u32> &column) {
+    column.resize(sample_count);
+    if (sample_count) {
+      file.read(var::View(column.data(), sample_count * sizeof(u32)));
+    }
+  };
+
+  read_column(result.m_time_delta);
+  for (u32 i = 0; i < series_count && is_success(); i++) {
+    const u32 name_length = read_u32();
+    char name[64] = {};
+    if (name_length >= sizeof(name)) {
+      API_RETURN_VALUE_ASSIGN_ERROR(
+        TaskSeries(),
+        "task name is too long",
+        EINVAL);
+    }
+    file.read(var::View(name, name_length));
+
+    Series series
+      = Series().set_name(var::NameString(var::StringView(name, name_length)));
+    series.set_id(read_u32())
+      .set_pid(read_u32())
+      .set_memory_size(read_u32())
+      .set_thread(read_u32() != 0);
+    read_column(series.cpu_delta());
+    read_column(series.stack_size());
+    read_column(series.heap_size());
+    result.m_series_list.push_back(series);
+  }
+
+  if (is_error()) {
+    return TaskSeries();
+  }
+
+  if (sample_count) {
+    result.m_last_timestamp = result.get_timestamp(sample_count - 1);
+  }
+  return result;
+}
+
+void TaskSeries::save_html(
+  const fs::FileObject &file,
+  const var::StringView title) const {
+
+  const u64 duration
+    = count() > 1 ? get_timestamp(count() - 1) - m_start_timestamp : 1;
+  const u32 bucket_size = (count() + chart_point_count - 1) / chart_point_count;
+
+  // sample offset and time of the start of each bucket
+  var::Vector<u32> bucket_start_list;
+  var::Vector<u64> bucket_time_list;
+  {
+    u64 timestamp = m_start_timestamp;
+    for (u32 sample = 0; sample < count(); sample++) {
+      if (sample) {
+        timestamp += m_time_delta.at(sample);
+      }
+      if (sample % bucket_size == 0) {
+        bucket_start_list.push_back(sample);
+        bucket_time_list.push_back(timestamp - m_start_timestamp);
+      }
+    }
+  }
+
+  var::Vector<u64> sample_cpu_time_list;
+  sample_cpu_time_list.reserve(count());
+  for (u32 sample = 0; sample < count(); sample++) {
+    sample_cpu_time_list.push_back(get_sample_cpu_time(sample));
+  }
+
+  const auto to_x = [&](u64 time) {
+    return static_cast<double>(time) * chart_width / duration;
+  };
+  const auto to_y = [&](double percent) {
+    return chart_height - percent * chart_height / 100.0;
+  };
+
+  // CPU utilization is averaged over a bucket and memory utilization is the
+  // maximum so short peaks stay visible
+  enum class Metric { cpu, memory };
+  const auto get_points = [&](const Series &series, Metric metric) {
+    var::String result;
+    for (u32 bucket = 0; bucket < bucket_start_list.count(); bucket++) {
+      const u32 start = bucket_start_list.at(bucket);
+      const u32 end = start + bucket_size < count() ? start + bucket_size
+                                                     : count();
+      double value = 0.0;
+      u32 present_count = 0;
+      for (u32 sample = start; sample < end; sample++) {
+        if (!series.is_present(sample)) {
+          continue;
+        }
+        present_count++;
+        if (metric == Metric::cpu) {
+          const u64 total = sample_cpu_time_list.at(sample);
+          value += total ? series.cpu_delta().at(sample) * 100.0 / total : 0.0;
+        } else if (series.memory_size()) {
+          const u32 used = series.is_thread()
+                             ? series.stack_size().at(sample)
+                             : series.stack_size().at(sample)
+                                 + series.heap_size().at(sample);
+          const double percent = used * 100.0 / series.memory_size();
+          value = percent > value ? percent : value;
+        }
+      }
+
+      if (present_count == 0) {
+        continue;
+      }
+      if (metric == Metric::cpu) {
+        value /= present_count;
+      }
+
+      char buffer[48];
+      snprintf(
+        buffer,
+        sizeof(buffer),
+        "%0.1f,%0.1f ",
+        to_x(bucket_time_list.at(bucket)),
+        to_y(value));
+      result += buffer;
+    }
+    return result;
+  };
+
+  const auto write_chart = [&](const var::StringView heading, Metric metric) {
+    char buffer[256];
+    snprintf(
+      buffer,
+      sizeof(buffer),
+      "<h2>%s</h2>\n<svg viewBox=\"-40 -10 %u %u\" width=\"100%%\">\n",
+      var::String(heading).cstring(),
+      chart_width + 60,
+      chart_height + 40);
+    file.write(var::StringView(buffer));
+
+    for (u32 percent = 0; percent <= 100; percent += 25) {
+      snprintf(
+        buffer,
+        sizeof(buffer),
+        "<line x1=\"0\" x2=\"%u\" y1=\"%0.1f\" y2=\"%0.1f\" "
+        "class=\"grid\"/><text x=\"-8\" y=\"%0.1f\" "
+        "class=\"label\">%u</text>\n",
+        chart_width,
+        to_y(percent),
+        to_y(percent),
+        to_y(percent) + 4,
+        percent);
+      file.write(var::StringView(buffer));
+    }
+
+    snprintf(
+      buffer,
+      sizeof(buffer),
+      "<text x=\"%u\" y=\"%u\" class=\"label\">%0.1f s</text>\n",
+      chart_width,
+      chart_height + 20,
+      duration / 1000000.0);
+    file.write(var::StringView(buffer));
+
+    u32 color = 0;
+    for (const auto &series : m_series_list) {
+      file.write(
+        var::String("<polyline fill=\"none\" stroke=\"") + get_color(color++)
+        + "\" points=\"" + get_points(series, metric) + "\"><title>"
+        + html_escape(series.name().string_view()) + "</title></polyline>\n");
+    }
+    file.write(var::StringView("</svg>\n"));
+  };
+
+  file.write(
+    var::String(
+      "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>")
+    + html_escape(title)
+    + "</title>\n<style>\n"
+      "body { font-family: sans-serif; margin: 2em; }\n"
+      "svg { max-width: 1100px; }\n"
+      ".grid { stroke: #ddd; }\n"
+      ".label { font-size: 12px; text-anchor: end; fill: #555; }\n"
+      "table { border-collapse: collapse; }\n"
+      "td, th { border: 1px solid #ccc; padding: 4px 8px; text-align: right; "
+      "}\n"
+      "</style>\n</head>\n<body>\n<h1>"
+    + html_escape(title) + "</h1>\n");
+
+  write_chart("CPU Utilization (%)", Metric::cpu);
+  write_chart("Memory Utilization (%)", Metric::memory);
+
+  file.write(var::StringView(
+    "<h2>Summary</h2>\n<table>\n<tr><th></th><th>name</th><th>id</th>"
+    "<th>pid</th><th>cpuTime</th><th>cpuUsage</th><th>maximumStack</th>"
+    "<th>maximumHeap</th><th>maximumMemoryUsage</th></tr>\n"));
+
+  const u64 total_cpu_time = get_total_cpu_time();
+  u32 color = 0;
+  for (const auto &series : m_series_list) {
+    char buffer[256];
+    snprintf(
+      buffer,
+      sizeof(buffer),
+      "</td><td>%u</td><td>%u</td><td>%llu</td><td>%0.3f</td>"
+      "<td>%u</td><td>%s</td><td>%0.2f</td></tr>\n",
+      series.id(),
+      series.pid(),
+      static_cast<unsigned long long>(series.get_cpu_time()),
+      total_cpu_time ? series.get_cpu_time() * 100.0 / total_cpu_time : 0.0,
+      series.get_maximum_stack_size(),
+      series.is_thread()
+        ? "NA"
+        : var::NumberString(series.get_maximum_heap_size()).cstring(),
+      static_cast<double>(series.get_memory_utilization()));
+    file.write(
+      var::String("<tr><td style=\"background:") + get_color(color++)
+      + "\"></td><td>" + html_escape(series.name().string_view()) + buffer);
+  }
+
+  file.write(var::StringView("</table>\n</body>\n</html>\n"));
+}
+
+u32 TaskSeries::find_series(const sos::TaskManager::Info &info) const {
+  for (u32 i = 0; i < m_series_list.count(); i++) {
+    const auto &series = m_series_list.at(i);
+    if (
+      series.id() == info.id() && series.pid() == info.pid()
+      && series.name() == info.name()) {
+      return i;
+    }
+  }
+  return m_series_list.count();
+}
+
+void TaskSeries::drop_front(u32 drop_count) {
+  if (drop_count == 0 || drop_count >= count()) {
+    clear();
+    return;
+  }
+
+  const auto drop_column = [&](var::Vector<u32> &column) {
+    var::Vector<u32> result;
+    result.reserve(m_maximum_count);
+    for (u32 i = drop_count; i < column.count(); i++) {
+      result.push_back(column.at(i));
+    }
+    column = result;
+  };
+
+  m_start_timestamp = get_timestamp(drop_count);
+  drop_column(m_time_delta);
+  m_time_delta.at(0) = 0;
+
+  for (auto &series : m_series_list) {
+    drop_column(series.cpu_delta());
+    drop_column(series.stack_size());
+    drop_column(series.heap_size());
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef UTILITIES_TASKSERIES_HPP
+#define UTILITIES_TASKSERIES_HPP
+
+#include <fs.hpp>
+#include <sos.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+
+// Columnar store of `task.analyze` samples.
+//
+// Each task seen during the capture is interned once (name, ids and memory
+// size) and owns fixed-width columns with one value per sample: the CPU
+// cycles used since the previous sample (delta-encoded timer), the stack
+// size and the heap size. Samples where the task is not running hold
+// `absent()` in the stack column. Sample times are stored as deltas from the
+// previous sample.
+class TaskSeries : public AppAccess {
+public:
+  class Series {
+  public:
+    bool is_present(u32 sample) const {
+      return stack_size().at(sample) != absent();
+    }
+
+    u64 get_cpu_time() const;
+    u32 get_maximum_stack_size() const;
+    u32 get_maximum_heap_size() const;
+    float get_memory_utilization() const;
+
+  private:
+    friend TaskSeries;
+    API_AC(Series, var::NameString, name);
+    API_AF(Series, u32, id, 0);
+    API_AF(Series, u32, pid, 0);
+    API_AF(Series, u32, memory_size, 0);
+    API_AB(Series, thread, false);
+    API_AC(Series, var::Vector<u32>, cpu_delta);
+    API_AC(Series, var::Vector<u32>, stack_size);
+    API_AC(Series, var::Vector<u32>, heap_size);
+    // raw timer of the last sample (not exported)
+    API_AF(Series, u64, last_timer, 0);
+  };
+
+  using SeriesList = var::Vector<Series>;
+
+  static constexpr u32 absent() { return 0xffffffff; }
+
+  // when the store is full the oldest half of the samples is dropped
+  TaskSeries &set_maximum_count(u32 value) {
+    m_maximum_count = value;
+    return *this;
+  }
+
+  // `timestamp` is microseconds since the start of the capture
+  TaskSeries &
+  append(u64 timestamp, const var::Vector<sos::TaskManager::Info> &list);
+
+  void clear();
+
+  u32 count() const { return m_time_delta.count(); }
+  bool is_empty() const { return count() == 0; }
+  const SeriesList &series_list() const { return m_series_list; }
+
+  u64 get_timestamp(u32 sample) const;
+  // CPU cycles used by all tasks over the capture
+  u64 get_total_cpu_time() const;
+
+  // one row per task per sample
+  void save_csv(const fs::FileObject &file) const;
+
+  // little-endian binary image of the columns (see TaskSeries.cpp)
+  void save_binary(const fs::FileObject &file) const;
+  static TaskSeries load_binary(const fs::FileObject &file);
+
+  // self-contained HTML page with SVG charts of CPU and memory utilization
+  void save_html(const fs::FileObject &file, const var::StringView title) const;
+
+private:
+  u32 m_maximum_count = 100000;
+  u64 m_start_timestamp = 0;
+  u64 m_last_timestamp = 0;
+  var::Vector<u32> m_time_delta;
+  SeriesList m_series_list;
+
+  u32 find_series(const sos::TaskManager::Info &info) const;
+  void drop_front(u32 count);
+  // CPU cycles used by all tasks during `sample`
+  u64 get_sample_cpu_time(u32 sample) const;
+};
+
+#endif // UTILITIES_TASKSERIES_HPP
@@ -0,0 +1,88 @@
+#include <thread>
+
+#include "ThreadPool.hpp"
+
+size_t ThreadPool::default_thread_count() {
+  const size_t result = std::thread::hardware_concurrency();
+  if (result == 0) {
+    return 4;
+  }
+  return result > 16 ? 16 : result;
+}
+
+void ThreadPool::execute(const Execute &options, const Function &function) {
+  APP_CALL_GRAPH_TRACE_CLASS_FUNCTION("ThreadPool");
+
+  struct Context {
+    const Function *function = nullptr;
+    const api::ProgressCallback *progress_callback = nullptr;
+    Mutex mutex;
+    size_t count = 0;
+    size_t next = 0;
+    size_t complete = 0;
+
+    void update_progress() {
+      Mutex::Guard mg(mutex);
+      complete++;
+      if (progress_callback) {
+        progress_callback->update(int(complete), int(count));
+      }
+    }
+  };
+
+  Context context;
+  context.function = &function;
+  context.progress_callback = options.progress_callback();
+  context.count = options.count();
+
+  const size_t thread_count = [&]() {
+    const size_t requested = options.thread_count()
+                               ? options.thread_count()
+                               : default_thread_count();
+    return requested < options.count() ? requested : options.count();
+  }();
+
+  if (context.progress_callback) {
+    context.progress_callback->update(0, int(context.count));
+  }
+
+  if (thread_count <= 1) {
+    for (const auto index : api::Index(context.count)) {
+      function(index);
+      context.update_progress();
+    }
+  } else {
+    var::Vector<Thread> thread_list;
+    thread_list.reserve(thread_count);
+    for (const auto index : api::Index(thread_count)) {
+      MCU_UNUSED_ARGUMENT(index);
+      thread_list.push_back(Thread(
+        Thread::Attributes().set_detach_state(Thread::DetachState::joinable),
+        Thread::Construct()
+          .set_argument(&context)
+          .set_function([](void *args) -> void * {
+            auto *context = reinterpret_cast<Context *>(args);
+            while (true) {
+              size_t next = 0;
+              {
+                Mutex::Guard mg(context->mutex);
+                if (context->next == context->count) {
+                  return nullptr;
+                }
+                next = context->next++;
+              }
+              (*context->function)(next);
+              context->update_progress();
+            }
+          })));
+    }
+
+    for (auto &thread : thread_list) {
+      thread.join();
+    }
+  }
+
+  if (context.progress_callback) {
+    context.progress_callback->update(0, 0);
+  }
+}
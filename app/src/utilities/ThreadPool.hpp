@@ -0,0 +1,33 @@
+#ifndef UTILITIES_THREADPOOL_HPP
+#define UTILITIES_THREADPOOL_HPP
+
+#include <functional>
+
+#include <thread.hpp>
+
+#include "App.hpp"
+
+// runs `function(index)` for each index in [0, count) on a set of worker
+// threads -- the function must not use the printer
+class ThreadPool : public AppAccess {
+public:
+  using Function = std::function<void(size_t index)>;
+
+  class Execute {
+    API_AF(Execute, size_t, count, 0);
+    // zero uses default_thread_count()
+    API_AF(Execute, size_t, thread_count, 0);
+    // updated (serialized) as items complete
+    API_AF(
+      Execute,
+      const api::ProgressCallback *,
+      progress_callback,
+      nullptr);
+  };
+
+  static void execute(const Execute &options, const Function &function);
+
+  static size_t default_thread_count();
+};
+
+#endif // UTILITIES_THREADPOOL_HPP
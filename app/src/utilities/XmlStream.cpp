@@ -0,0 +1,596 @@
+#include <cstring>
+
+#include <chrono.hpp>
+#include <sys.hpp>
+
+#include "XmlStream.hpp"
+
+XmlStream::XmlStream(const fs::FileObject &file) : m_file(&file) {}
+
+int XmlStream::peek() {
+  if (m_offset == m_size) {
+    if (m_is_end_of_file || is_error()) {
+      return -1;
+    }
+    m_file->read(View(m_buffer, sizeof(m_buffer)));
+    const int result = return_value();
+    if (is_error() || result <= 0) {
+      m_is_end_of_file = true;
+      return -1;
+    }
+    m_offset = 0;
+    m_size = size_t(result);
+  }
+  return static_cast<unsigned char>(m_buffer[m_offset]);
+}
+
+int XmlStream::get() {
+  const int result = peek();
+  if (result >= 0) {
+    m_offset++;
+  }
+  return result;
+}
+
+bool XmlStream::skip_past(const var::StringView terminator) {
+  // compares a sliding window of the last `terminator.length()` characters
+  char window[8] = {};
+  const size_t length = terminator.length();
+  API_ASSERT(length <= sizeof(window));
+  size_t count = 0;
+  int c;
+  while ((c = get()) >= 0) {
+    memmove(window, window + 1, sizeof(window) - 1);
+    window[sizeof(window) - 1] = char(c);
+    count++;
+    if (
+      count >= length
+      && memcmp(
+           window + sizeof(window) - length,
+           terminator.data(),
+           length)
+           == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void XmlStream::skip_whitespace() {
+  int c;
+  while ((c = peek()) >= 0
+         && (c == ' ' || c == '\t' || c == '\r' || c == '\n')) {
+    get();
+  }
+}
+
+var::String XmlStream::read_name() {
+  var::String result;
+  char chunk[64];
+  size_t count = 0;
+  int c;
+  while ((c = peek()) >= 0 && c != ' ' && c != '\t' && c != '\r' && c != '\n'
+         && c != '/' && c != '>' && c != '=') {
+    chunk[count++] = char(get());
+    if (count == sizeof(chunk)) {
+      result += var::StringView(chunk, count);
+      count = 0;
+    }
+  }
+  result += var::StringView(chunk, count);
+  return result;
+}
+
+var::String XmlStream::read_until(char terminator) {
+  var::String result;
+  char chunk[256];
+  size_t count = 0;
+  int c;
+  while ((c = peek()) >= 0 && c != terminator) {
+    chunk[count++] = char(get());
+    if (count == sizeof(chunk)) {
+      result += var::StringView(chunk, count);
+      count = 0;
+    }
+  }
+  result += var::StringView(chunk, count);
+  return result;
+}
+
+XmlStream::Event XmlStream::next() {
+  Event result;
+  while (is_success()) {
+    int c = peek();
+    if (c < 0) {
+      return result;
+    }
+
+    if (c != '<') {
+      const auto text = read_until('<');
+      return result.set_type(Event::Type::text).set_text(decode_entities(text));
+    }
+
+    get();
+    c = peek();
+    if (c == '?') {
+      // declaration or processing instruction
+      skip_past("?>");
+      continue;
+    }
+
+    if (c == '!') {
+      get();
+      if (peek() == '-') {
+        skip_past("-->");
+        continue;
+      }
+
+      if (peek() == '[') {
+        // <![CDATA[ ... ]]>
+        skip_past("CDATA[");
+        var::String text;
+        while ((c = get()) >= 0) {
+          const char character = char(c);
+          text += var::StringView(&character, 1);
+          const auto view = text.string_view();
+          if (
+            view.length() >= 3
+            && view.get_substring_at_position(view.length() - 3) == "]]>") {
+            text.pop_back().pop_back().pop_back();
+            break;
+          }
+        }
+        return result.set_type(Event::Type::text).set_text(text);
+      }
+
+      // <!DOCTYPE ...> (may have an internal subset in brackets)
+      int depth = 0;
+      while ((c = get()) >= 0) {
+        if (c == '[') {
+          depth++;
+        } else if (c == ']') {
+          depth--;
+        } else if (c == '>' && depth <= 0) {
+          break;
+        }
+      }
+      continue;
+    }
+
+    if (c == '/') {
+      get();
+      result.set_type(Event::Type::end).set_name(read_name());
+      skip_past(">");
+      return result;
+    }
+
+    result.set_type(Event::Type::start).set_name(read_name());
+    if (read_tag(result) == false) {
+      API_RETURN_VALUE_ASSIGN_ERROR(
+        Event(),
+        "unexpected end of XML in a start tag",
+        EINVAL);
+    }
+    return result;
+  }
+  return result;
+}
+
+bool XmlStream::read_tag(Event &event) {
+  AttributeList attribute_list;
+  while (true) {
+    skip_whitespace();
+    const int c = peek();
+    if (c < 0) {
+      return false;
+    }
+
+    if (c == '/') {
+      get();
+      event.set_empty_element();
+      if (skip_past(">") == false) {
+        return false;
+      }
+      break;
+    }
+
+    if (c == '>') {
+      get();
+      break;
+    }
+
+    const auto name = read_name();
+    skip_whitespace();
+    if (get() != '=') {
+      return false;
+    }
+    skip_whitespace();
+    const int quote = get();
+    if (quote != '"' && quote != '\'') {
+      return false;
+    }
+    const auto value = read_until(char(quote));
+    get();
+    attribute_list.push_back(
+      Attribute().set_name(name).set_value(decode_entities(value)));
+  }
+  event.set_attribute_list(attribute_list);
+  return true;
+}
+
+json::JsonValue XmlStream::read_element(const Event &start) {
+  json::JsonObject object;
+  for (const auto &attribute : start.attribute_list()) {
+    object.insert(
+      var::String("@") + attribute.name(),
+      json::JsonString(attribute.value().cstring()));
+  }
+
+  if (start.is_empty_element()) {
+    if (start.attribute_list().count()) {
+      return std::move(object);
+    }
+    return json::JsonString("");
+  }
+
+  var::String text;
+  var::StringList child_name_list;
+  while (is_success()) {
+    const auto event = next();
+    if (event.type() == Event::Type::none) {
+      API_RETURN_VALUE_ASSIGN_ERROR(
+        json::JsonValue(),
+        "unexpected end of XML in an element",
+        EINVAL);
+    }
+
+    if (event.type() == Event::Type::end) {
+      break;
+    }
+
+    if (event.type() == Event::Type::text) {
+      text += event.text();
+      continue;
+    }
+
+    const auto child = read_element(event);
+    if (child_name_list.find_offset(event.name()) == child_name_list.count()) {
+      child_name_list.push_back(event.name());
+      object.insert(event.name(), child);
+    } else {
+      auto existing = object.at(event.name());
+      if (existing.is_array()) {
+        existing.to_array().append(child);
+      } else {
+        object.insert(
+          event.name(),
+          json::JsonArray().append(existing).append(child));
+      }
+    }
+  }
+
+  if (child_name_list.count() == 0 && start.attribute_list().count() == 0) {
+    return json::JsonString(trim(text).cstring());
+  }
+
+  if (!is_whitespace(text)) {
+    object.insert("#text", json::JsonString(trim(text).cstring()));
+  }
+  return std::move(object);
+}
+
+var::String XmlStream::for_each_child(const ElementCallback &callback) {
+  Event root;
+  do {
+    root = next();
+  } while (root.type() != Event::Type::start
+           && root.type() != Event::Type::none);
+
+  if (root.type() == Event::Type::none) {
+    API_RETURN_VALUE_ASSIGN_ERROR(
+      var::String(),
+      "no XML document element",
+      EINVAL);
+  }
+
+  if (root.is_empty_element()) {
+    return root.name();
+  }
+
+  while (is_success()) {
+    const auto event = next();
+    if (event.type() == Event::Type::none) {
+      API_RETURN_VALUE_ASSIGN_ERROR(
+        var::String(),
+        "unexpected end of XML in the document element",
+        EINVAL);
+    }
+
+    if (event.type() == Event::Type::end) {
+      break;
+    }
+
+    if (event.type() == Event::Type::start) {
+      const auto value = read_element(event);
+      if (is_success()) {
+        callback(event.name(), value);
+      }
+    }
+  }
+  return root.name();
+}
+
+void XmlStream::convert(
+  const fs::FileObject &input,
+  const fs::FileObject &output) {
+  XmlStream xml(input);
+
+  Event root;
+  do {
+    root = xml.next();
+  } while (root.type() != Event::Type::start
+           && root.type() != Event::Type::none);
+
+  if (root.type() == Event::Type::none) {
+    API_RETURN_ASSIGN_ERROR("no XML document element", EINVAL);
+  }
+
+  output.write(var::String("{\"") + escape(root.name()) + "\":{");
+
+  bool is_first = true;
+  const auto write_key = [&](const var::StringView key) {
+    output.write(
+      var::String(is_first ? "\"" : ",\"") + escape(key) + "\":");
+    is_first = false;
+  };
+
+  for (const auto &attribute : root.attribute_list()) {
+    write_key(var::String("@") + attribute.name());
+    write_value(output, json::JsonString(attribute.value().cstring()));
+  }
+
+  // Children with the same name are merged into one array (as in
+  // `read_element()`) even if they are not consecutive. Each name's values
+  // are spilled to a temporary file so memory stays bounded by the largest
+  // child, then the files are copied to the output in first-seen order.
+  class Group {
+  public:
+    API_AC(Group, var::String, name);
+    API_AC(Group, var::PathString, path);
+    API_AF(Group, u32, count, 0);
+  };
+
+  const auto temporary_directory_path
+    = var::PathString(sys::System::user_data_path()) / "sl/xml-"
+      & chrono::ClockTime::get_system_time().to_unique_string();
+  fs::FileSystem().create_directory(
+    temporary_directory_path,
+    fs::Dir::IsRecursive::yes,
+    fs::Permissions(0700));
+
+  var::Vector<Group> group_list;
+  var::String text;
+
+  while (!root.is_empty_element() && is_success()) {
+    const auto event = xml.next();
+    if (event.type() == Event::Type::none) {
+      API_ASSIGN_ERROR("unexpected end of XML in the document element", EINVAL);
+      break;
+    }
+
+    if (event.type() == Event::Type::end) {
+      break;
+    }
+
+    if (event.type() == Event::Type::text) {
+      text += event.text();
+      continue;
+    }
+
+    const auto value = xml.read_element(event);
+    if (is_error()) {
+      break;
+    }
+
+    size_t offset = 0;
+    while (offset < group_list.count()
+           && group_list.at(offset).name() != event.name()) {
+      offset++;
+    }
+
+    if (offset == group_list.count()) {
+      group_list.push_back(Group().set_name(event.name()).set_path(
+        temporary_directory_path / var::NumberString(offset) & ".json"));
+      fs::File(fs::File::IsOverwrite::yes, group_list.at(offset).path());
+    }
+
+    auto &group = group_list.at(offset);
+    fs::File group_file(group.path(), fs::OpenMode::append_write_only());
+    if (group.count()) {
+      group_file.write(var::StringView(","));
+    }
+    write_value(group_file, value);
+    group.set_count(group.count() + 1);
+  }
+
+  for (const auto &group : group_list) {
+    if (is_error()) {
+      break;
+    }
+    write_key(group.name());
+    if (group.count() > 1) {
+      output.write(var::StringView("["));
+    }
+    output.write(fs::File(group.path()));
+    if (group.count() > 1) {
+      output.write(var::StringView("]"));
+    }
+  }
+
+  {
+    api::ErrorScope error_scope;
+    fs::FileSystem().remove_directory(
+      temporary_directory_path,
+      fs::Dir::IsRecursive::yes);
+  }
+
+  if (is_error()) {
+    return;
+  }
+
+  if (!is_whitespace(text)) {
+    write_key("#text");
+    write_value(output, json::JsonString(trim(text).cstring()));
+  }
+
+  output.write(var::StringView("}}\n"));
+}
+
+void XmlStream::write_value(
+  const fs::FileObject &output,
+  const json::JsonValue &value) {
+  if (value.is_string()) {
+    output.write(
+      var::String("\"") + escape(value.to_string_view()) + "\"");
+  } else if (value.is_array()) {
+    output.write(json::JsonDocument().stringify(value.to_array()));
+  } else {
+    output.write(json::JsonDocument().stringify(value.to_object()));
+  }
+}
+
+var::String XmlStream::decode_entities(const var::StringView value) {
+  if (value.find("&") == var::StringView::npos) {
+    return var::String(value);
+  }
+
+  var::String result;
+  size_t i = 0;
+  while (i < value.length()) {
+    const size_t end = value.find(";", i);
+    if (value.at(i) != '&' || end == var::StringView::npos || end - i > 10) {
+      result += value.get_substring_at_position(i).get_substring_with_length(1);
+      i++;
+      continue;
+    }
+
+    const auto entity
+      = value.get_substring_at_position(i + 1).get_substring_with_length(
+        end - i - 1);
+    u32 code = 0;
+    if (entity == "lt") {
+      code = '<';
+    } else if (entity == "gt") {
+      code = '>';
+    } else if (entity == "amp") {
+      code = '&';
+    } else if (entity == "quot") {
+      code = '"';
+    } else if (entity == "apos") {
+      code = '\'';
+    } else if (entity.length() > 1 && entity.at(0) == '#') {
+      const bool is_hex = entity.at(1) == 'x' || entity.at(1) == 'X';
+      code = strtoul(
+        var::String(entity.get_substring_at_position(is_hex ? 2 : 1)).cstring(),
+        nullptr,
+        is_hex ? 16 : 10);
+    }
+
+    if (code == 0) {
+      // not a known entity -- keep it as is
+      result += value.get_substring_at_position(i).get_substring_with_length(1);
+      i++;
+      continue;
+    }
+
+    // UTF-8 encode the code point
+    char encoded[4];
+    size_t length = 0;
+    if (code < 0x80) {
+      encoded[length++] = char(code);
+    } else if (code < 0x800) {
+      encoded[length++] = char(0xc0 | (code >> 6));
+      encoded[length++] = char(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+      encoded[length++] = char(0xe0 | (code >> 12));
+      encoded[length++] = char(0x80 | ((code >> 6) & 0x3f));
+      encoded[length++] = char(0x80 | (code & 0x3f));
+    } else {
+      encoded[length++] = char(0xf0 | (code >> 18));
+      encoded[length++] = char(0x80 | ((code >> 12) & 0x3f));
+      encoded[length++] = char(0x80 | ((code >> 6) & 0x3f));
+      encoded[length++] = char(0x80 | (code & 0x3f));
+    }
+    result += var::StringView(encoded, length);
+    i = end + 1;
+  }
+  return result;
+}
+
+bool XmlStream::is_whitespace(const var::StringView value) {
+  for (size_t i = 0; i < value.length(); i++) {
+    const char c = value.at(i);
+    if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+      return false;
+    }
+  }
+  return true;
+}
+
+var::String XmlStream::trim(const var::StringView value) {
+  size_t start = 0;
+  size_t end = value.length();
+  const auto is_space = [](char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  };
+  while (start < end && is_space(value.at(start))) {
+    start++;
+  }
+  while (end > start && is_space(value.at(end - 1))) {
+    end--;
+  }
+  return var::String(value.get_substring_at_position(start)
+                       .get_substring_with_length(end - start));
+}
+
+var::String XmlStream::escape(const var::StringView value) {
+  var::String result;
+  size_t start = 0;
+  for (size_t i = 0; i < value.length(); i++) {
+    const unsigned char c = value.at(i);
+    const char *replacement = nullptr;
+    char control[8];
+    switch (c) {
+    case '"':
+      replacement = "\\\"";
+      break;
+    case '\\':
+      replacement = "\\\\";
+      break;
+    case '\n':
+      replacement = "\\n";
+      break;
+    case '\r':
+      replacement = "\\r";
+      break;
+    case '\t':
+      replacement = "\\t";
+      break;
+    default:
+      if (c < 0x20) {
+        snprintf(control, sizeof(control), "\\u%04x", c);
+        replacement = control;
+      }
+      break;
+    }
+
+    if (replacement != nullptr) {
+      result += value.get_substring_at_position(start)
+                  .get_substring_with_length(i - start);
+      result += var::StringView(replacement);
+      start = i + 1;
+    }
+  }
+  result += value.get_substring_at_position(start);
+  return result;
+}
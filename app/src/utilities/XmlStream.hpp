@@ -0,0 +1,86 @@
+#ifndef UTILITIES_XMLSTREAM_HPP
+#define UTILITIES_XMLSTREAM_HPP
+
+#include <functional>
+
+#include <fs.hpp>
+#include <json.hpp>
+#include <var.hpp>
+
+#include "App.hpp"
+
+// Pull (SAX-style) XML reader that reads the file in small chunks so
+// arbitrarily large documents can be converted to JSON without loading a DOM.
+//
+// Elements map to JSON as follows:
+// - an element with only text becomes a string
+// - attributes become `@<name>` keys and mixed text becomes `#text`
+// - repeated child elements become an array
+//
+// `convert()` streams the document element's children to the output one at a
+// time, so memory is bounded by the largest child (not the document).
+// Repeated children are spilled to temporary files under the user data
+// directory so they can be merged into one array.
+class XmlStream : public AppAccess {
+public:
+  class Attribute {
+    API_AC(Attribute, var::String, name);
+    API_AC(Attribute, var::String, value);
+  };
+
+  using AttributeList = var::Vector<Attribute>;
+
+  class Event {
+  public:
+    enum class Type { none, start, end, text };
+
+    API_AF(Event, Type, type, Type::none);
+    API_AC(Event, var::String, name);
+    API_AC(Event, var::String, text);
+    API_AC(Event, AttributeList, attribute_list);
+    // `<name/>` produces a start event with this set (and no end event)
+    API_AB(Event, empty_element, false);
+  };
+
+  using ElementCallback
+    = std::function<void(const var::StringView name, const json::JsonValue &)>;
+
+  explicit XmlStream(const fs::FileObject &file);
+
+  // returns an event with type none at the end of the document
+  Event next();
+
+  // reads the remainder of the element started by `start`
+  json::JsonValue read_element(const Event &start);
+
+  // calls `callback` for each child element of the document element and
+  // returns the document element's name
+  var::String for_each_child(const ElementCallback &callback);
+
+  static void
+  convert(const fs::FileObject &input, const fs::FileObject &output);
+
+private:
+  const fs::FileObject *m_file;
+  char m_buffer[4096];
+  size_t m_offset = 0;
+  size_t m_size = 0;
+  bool m_is_end_of_file = false;
+
+  int get();
+  int peek();
+  bool skip_past(const var::StringView terminator);
+  void skip_whitespace();
+  var::String read_name();
+  var::String read_until(char terminator);
+  bool read_tag(Event &event);
+
+  static var::String decode_entities(const var::StringView value);
+  static bool is_whitespace(const var::StringView value);
+  static var::String trim(const var::StringView value);
+  static var::String escape(const var::StringView value);
+  static void
+  write_value(const fs::FileObject &output, const json::JsonValue &value);
+};
+
+#endif // UTILITIES_XMLSTREAM_HPP